@@ -0,0 +1,338 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * benchmark_sqlitecxx.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define SQLITECXX_ALLOCATION_HOOKS
+
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+#include <filesystem>
+#include <benchmark/benchmark.h>
+#include "datatypes.h"
+#include "column.h"
+#include "bind.h"
+#include "sqlitecxx.h"
+#include "perf_counters.h"
+#include "allocation.h"
+
+/**
+ * @brief SQLite allocator is counted from first connection on.
+ */
+static const bool sqlite_allocations = Allocation::install_sqlite();
+
+/**
+ * @brief Add allocations and allocated bytes per operation to benchmark.
+ */
+static void report_allocations(
+    benchmark::State& state, const AllocationScope& scope, int64_t operations = 1
+) {
+    double divisor = static_cast<double>(state.iterations()) *
+        static_cast<double>(operations > 0 ? operations : 1);
+    if (divisor <= 0.0) {
+        return;
+    }
+    state.counters["allocations"] = scope.get_allocations() / divisor;
+    state.counters["allocated_bytes"] = (
+        scope.get_heap().bytes + scope.get_sqlite().bytes
+    ) / divisor;
+}
+
+/**
+ * @brief TempDatabase. Database file in temp directory, removed on exit.
+ */
+class TempDatabase final {
+
+  std::string path{};
+
+  public:
+    TempDatabase() {
+      std::string pattern = (
+          std::filesystem::temp_directory_path() / "sqlitecxx-bench-XXXXXX"
+      ).string();
+      int descriptor = mkstemp(pattern.data());
+      if (descriptor >= 0) {
+        close(descriptor);
+      }
+      this->path = pattern;
+    }
+
+    ~TempDatabase() {
+      std::remove(this->path.c_str());
+      std::remove((this->path + "-journal").c_str());
+      std::remove((this->path + "-wal").c_str());
+      std::remove((this->path + "-shm").c_str());
+    }
+
+    std::string& get_path() {
+      return this->path;
+    }
+};
+
+/**
+ * @brief Fill Column<INTEGER> with rows values.
+ */
+static void fill_column(Column<INTEGER>& column, int64_t rows) {
+    for (int64_t row = 0; row < rows; ++row) {
+        column.insert_data(INTEGER{static_cast<int>(row)});
+    }
+}
+
+/**
+ * @brief Insert rows into table t(id INTEGER, value REAL, name TEXT).
+ */
+static void insert_rows(SQLiteCXX& database, Column<INTEGER>& ids) {
+    sqlite3_stmt* statement{nullptr};
+    sqlite3_prepare_v2(
+        database.get_db(), "INSERT INTO t VALUES (?1, ?2, ?3)", -1,
+        &statement, nullptr
+    );
+    database.execute("BEGIN");
+    TEXT name{"sqlitecxx"};
+    for (const auto& id : ids.get_data()) {
+        Bind::row(statement, id, REAL{id.get() * 0.5}, name);
+        sqlite3_step(statement);
+        sqlite3_reset(statement);
+    }
+    database.execute("COMMIT");
+    sqlite3_finalize(statement);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Data type operators
+///////////////////////////////////////////////////////////////////////////////
+
+static void BM_IntegerAdd(benchmark::State& state) {
+    INTEGER first{1};
+    INTEGER second{2};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        INTEGER result = first + second;
+        benchmark::DoNotOptimize(result);
+        first = result;
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IntegerAdd);
+
+static void BM_IntegerCompare(benchmark::State& state) {
+    INTEGER first{1};
+    INTEGER second{2};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        bool result = first < second;
+        benchmark::DoNotOptimize(result);
+        benchmark::ClobberMemory();
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IntegerCompare);
+
+static void BM_IntegerIncrement(benchmark::State& state) {
+    INTEGER value{0};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        ++value;
+        benchmark::DoNotOptimize(value);
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IntegerIncrement);
+
+static void BM_RealMultiply(benchmark::State& state) {
+    REAL first{1.0001};
+    REAL second{0.9999};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        REAL result = first * second;
+        benchmark::DoNotOptimize(result);
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RealMultiply);
+
+static void BM_TextConcat(benchmark::State& state) {
+    TEXT first{std::string(state.range(0), 'a')};
+    TEXT second{std::string(state.range(0), 'b')};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        TEXT result = first + second;
+        benchmark::DoNotOptimize(result);
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_TextConcat)->Arg(8)->Arg(64)->Arg(1024);
+
+static void BM_TextCompare(benchmark::State& state) {
+    TEXT first{std::string(state.range(0), 'a')};
+    TEXT second{std::string(state.range(0), 'a')};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        bool result = first == second;
+        benchmark::DoNotOptimize(result);
+        benchmark::ClobberMemory();
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TextCompare)->Arg(8)->Arg(64)->Arg(1024);
+
+///////////////////////////////////////////////////////////////////////////////
+// Column<T>
+///////////////////////////////////////////////////////////////////////////////
+
+static void BM_ColumnInsertData(benchmark::State& state) {
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        Column<INTEGER> column{"id", true};
+        fill_column(column, state.range(0));
+        benchmark::DoNotOptimize(column.get_data());
+    }
+    perf.report(state, state.range(0));
+    report_allocations(state, allocations, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ColumnInsertData)->Range(1 << 10, 1 << 16);
+
+static void BM_ColumnIterate(benchmark::State& state) {
+    Column<INTEGER> column{"id", true};
+    fill_column(column, state.range(0));
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        int64_t sum{0};
+        for (const auto& value : column.get_data()) {
+            sum += value.get();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    perf.report(state, state.range(0));
+    report_allocations(state, allocations, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ColumnIterate)->Range(1 << 10, 1 << 16);
+
+///////////////////////////////////////////////////////////////////////////////
+// SQLiteCXX
+///////////////////////////////////////////////////////////////////////////////
+
+static void BM_CreateTable(benchmark::State& state) {
+    TempDatabase file;
+    SQLiteCXX database{file.get_path()};
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        database.create_table(
+            "CREATE TABLE t(id INTEGER PRIMARY KEY, value REAL, name TEXT)"
+        );
+        state.PauseTiming();
+        perf.pause();
+        allocations.pause();
+        database.execute("DROP TABLE t");
+        allocations.resume();
+        perf.resume();
+        state.ResumeTiming();
+    }
+    perf.report(state);
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_CreateTable);
+
+static void BM_BulkInsert(benchmark::State& state) {
+    TempDatabase file;
+    SQLiteCXX database{file.get_path()};
+    Column<INTEGER> ids{"id", true};
+    fill_column(ids, state.range(0));
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        state.PauseTiming();
+        perf.pause();
+        allocations.pause();
+        database.execute("DROP TABLE IF EXISTS t");
+        database.create_table("CREATE TABLE t(id INTEGER, value REAL, name TEXT)");
+        allocations.resume();
+        perf.resume();
+        state.ResumeTiming();
+        insert_rows(database, ids);
+    }
+    perf.report(state, state.range(0));
+    report_allocations(state, allocations, state.range(0));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BulkInsert)->Range(1 << 10, 1 << 16)->Unit(benchmark::kMillisecond);
+
+static void BM_Select(benchmark::State& state) {
+    TempDatabase file;
+    SQLiteCXX database{file.get_path()};
+    Column<INTEGER> ids{"id", true};
+    fill_column(ids, state.range(0));
+    database.create_table("CREATE TABLE t(id INTEGER, value REAL, name TEXT)");
+    insert_rows(database, ids);
+    sqlite3_stmt* statement{nullptr};
+    sqlite3_prepare_v2(
+        database.get_db(), "SELECT id, value, name FROM t", -1, &statement, nullptr
+    );
+    PerfCounters perf;
+    perf.start();
+    AllocationScope allocations;
+    for (auto _ : state) {
+        int64_t sum{0};
+        while (sqlite3_step(statement) == SQLITE_ROW) {
+            sum += sqlite3_column_int64(statement, 0);
+            benchmark::DoNotOptimize(sqlite3_column_text(statement, 2));
+        }
+        sqlite3_reset(statement);
+        benchmark::DoNotOptimize(sum);
+    }
+    perf.report(state, state.range(0));
+    report_allocations(state, allocations, state.range(0));
+    sqlite3_finalize(statement);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Select)->Range(1 << 10, 1 << 16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,415 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * compare_benchmarks.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+/**
+ * @brief Json. Minimal JSON value, enough for Google Benchmark output.
+ */
+struct Json {
+  enum class Type {null, boolean, number, string, array, object};
+
+  Type type{Type::null};
+  double number{0.0};
+  std::string text{};
+  std::vector<Json> items{};
+  std::map<std::string, Json> members{};
+
+  const Json* find(const std::string& key) const {
+    auto found = this->members.find(key);
+    return found == this->members.end() ? nullptr : &found->second;
+  }
+};
+
+/**
+ * @brief JsonParser. Recursive descent parser of JSON text.
+ */
+class JsonParser final {
+
+  const std::string& input;
+  size_t position{0};
+
+  void skip() {
+    while (this->position < this->input.size() &&
+        std::isspace(static_cast<unsigned char>(this->input[this->position]))) {
+      ++(this->position);
+    }
+  }
+
+  bool expect(char character) {
+    this->skip();
+    if (this->position < this->input.size() &&
+        this->input[this->position] == character) {
+      ++(this->position);
+      return true;
+    }
+    return false;
+  }
+
+  bool parse_string(std::string& result) {
+    if (!this->expect('"')) {
+      return false;
+    }
+    while (this->position < this->input.size()) {
+      char character = this->input[this->position++];
+      if (character == '"') {
+        return true;
+      }
+      if (character == '\\' && this->position < this->input.size()) {
+        char escaped = this->input[this->position++];
+        switch (escaped) {
+          case 'n': result += '\n'; break;
+          case 't': result += '\t'; break;
+          case 'r': result += '\r'; break;
+          case 'b': result += '\b'; break;
+          case 'f': result += '\f'; break;
+          case 'u': result += '?'; this->position += 4; break;
+          default: result += escaped; break;
+        }
+      } else {
+        result += character;
+      }
+    }
+    return false;
+  }
+
+  public:
+    explicit JsonParser(const std::string& input) : input{input} {}
+
+    bool parse(Json& value) {
+      this->skip();
+      if (this->position >= this->input.size()) {
+        return false;
+      }
+      char character = this->input[this->position];
+      if (character == '{') {
+        ++(this->position);
+        value.type = Json::Type::object;
+        if (this->expect('}')) {
+          return true;
+        }
+        do {
+          std::string key;
+          Json member;
+          if (!this->parse_string(key) || !this->expect(':') ||
+              !this->parse(member)) {
+            return false;
+          }
+          value.members.emplace(key, std::move(member));
+        } while (this->expect(','));
+        return this->expect('}');
+      }
+      if (character == '[') {
+        ++(this->position);
+        value.type = Json::Type::array;
+        if (this->expect(']')) {
+          return true;
+        }
+        do {
+          Json item;
+          if (!this->parse(item)) {
+            return false;
+          }
+          value.items.push_back(std::move(item));
+        } while (this->expect(','));
+        return this->expect(']');
+      }
+      if (character == '"') {
+        value.type = Json::Type::string;
+        return this->parse_string(value.text);
+      }
+      for (const char* word : {"true", "false", "null"}) {
+        if (this->input.compare(this->position, std::strlen(word), word) == 0) {
+          this->position += std::strlen(word);
+          value.type = word[0] == 'n' ? Json::Type::null : Json::Type::boolean;
+          value.number = word[0] == 't' ? 1.0 : 0.0;
+          return true;
+        }
+      }
+      const char* begin = this->input.c_str() + this->position;
+      char* end{nullptr};
+      value.type = Json::Type::number;
+      value.number = std::strtod(begin, &end);
+      if (end == begin) {
+        return false;
+      }
+      this->position += static_cast<size_t>(end - begin);
+      return true;
+    }
+};
+
+/**
+ * @brief Samples of metric per benchmark run name, in file order.
+ */
+using Samples = std::vector<std::pair<std::string, std::vector<double>>>;
+
+/**
+ * @brief Nanoseconds per time unit of Google Benchmark.
+ */
+static double unit_scale(const Json& run) {
+    const Json* unit = run.find("time_unit");
+    if (!unit) {
+        return 1.0;
+    }
+    if (unit->text == "us") {
+        return 1e3;
+    }
+    if (unit->text == "ms") {
+        return 1e6;
+    }
+    if (unit->text == "s") {
+        return 1e9;
+    }
+    return 1.0;
+}
+
+/**
+ * @brief Load per repetition values of metric from benchmark JSON file,
+ *        aggregate rows (mean, median, stddev) are ignored.
+ */
+static bool load(const std::string& path, const std::string& metric, Samples& samples) {
+    std::ifstream file{path};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    Json root;
+    if (!file || !JsonParser{text}.parse(root)) {
+        std::cerr << "Error Compare : can't parse " << path << std::endl;
+        return false;
+    }
+    const Json* benchmarks = root.find("benchmarks");
+    if (!benchmarks) {
+        std::cerr << "Error Compare : no benchmarks in " << path << std::endl;
+        return false;
+    }
+    bool time = metric == "real_time" || metric == "cpu_time";
+    for (const Json& run : benchmarks->items) {
+        const Json* type = run.find("run_type");
+        const Json* value = run.find(metric);
+        if ((type && type->text == "aggregate") || !value) {
+            continue;
+        }
+        const Json* name = run.find("run_name");
+        if (!name) {
+            name = run.find("name");
+        }
+        if (!name) {
+            std::cerr << "Error Compare : run without name in " << path << std::endl;
+            return false;
+        }
+        auto found = std::find_if(samples.begin(), samples.end(),
+            [name](const auto& entry) { return entry.first == name->text; });
+        if (found == samples.end()) {
+            samples.emplace_back(name->text, std::vector<double>{});
+            found = samples.end() - 1;
+        }
+        found->second.push_back(value->number * (time ? unit_scale(run) : 1.0));
+    }
+    return true;
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] :
+        (values[middle - 1] + values[middle]) / 2.0;
+}
+
+/**
+ * @brief Two sided Mann-Whitney U test p-value. Exact distribution for
+ *        small samples without ties, normal approximation with tie and
+ *        continuity correction otherwise.
+ */
+static double mann_whitney(const std::vector<double>& first, const std::vector<double>& second) {
+    size_t n1 = first.size();
+    size_t n2 = second.size();
+    std::vector<std::pair<double, int>> all;
+    for (double value : first) {
+        all.emplace_back(value, 0);
+    }
+    for (double value : second) {
+        all.emplace_back(value, 1);
+    }
+    std::sort(all.begin(), all.end());
+    double rank_sum{0.0};
+    double ties{0.0};
+    for (size_t index = 0; index < all.size();) {
+        size_t end = index;
+        while (end < all.size() && all[end].first == all[index].first) {
+            ++end;
+        }
+        double rank = (index + end + 1) / 2.0;
+        for (size_t tied = index; tied < end; ++tied) {
+            if (all[tied].second == 0) {
+                rank_sum += rank;
+            }
+        }
+        double count = static_cast<double>(end - index);
+        ties += count * count * count - count;
+        index = end;
+    }
+    double u = rank_sum - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    if (ties == 0.0 && n1 + n2 <= 40) {
+        // table[i][j][k] = orderings of i first and j second values with U = k
+        std::vector<std::vector<std::vector<double>>> table(
+            n1 + 1, std::vector<std::vector<double>>(n2 + 1)
+        );
+        for (size_t i = 0; i <= n1; ++i) {
+            for (size_t j = 0; j <= n2; ++j) {
+                table[i][j].assign(i * j + 1, 0.0);
+                if (i == 0 || j == 0) {
+                    table[i][j][0] = 1.0;
+                    continue;
+                }
+                for (size_t k = 0; k <= i * j; ++k) {
+                    double value = k >= j ? table[i - 1][j][k - j] : 0.0;
+                    if (k <= i * (j - 1)) {
+                        value += table[i][j - 1][k];
+                    }
+                    table[i][j][k] = value;
+                }
+            }
+        }
+        const std::vector<double>& distribution = table[n1][n2];
+        double total{0.0};
+        for (double value : distribution) {
+            total += value;
+        }
+        double extreme = std::min(u, n1 * n2 - u);
+        double tail{0.0};
+        for (size_t k = 0; k <= static_cast<size_t>(extreme + 1e-9); ++k) {
+            tail += distribution[k];
+        }
+        return std::min(1.0, 2.0 * tail / total);
+    }
+    double n = static_cast<double>(n1 + n2);
+    double variance = n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+    double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0)));
+}
+
+/**
+ * @brief Print usage of compare tool.
+ */
+static void usage() {
+    std::cerr << "Usage : compare_benchmarks [options] <baseline.json> <contender.json>\n"
+        << "  --metric=NAME     cpu_time, real_time or user counter (cpu_time)\n"
+        << "  --threshold=PCT   regression when slower by more than PCT (5)\n"
+        << "  --alpha=P         significance level of Mann-Whitney U test (0.05)\n"
+        << "Run benchmarks with --benchmark_repetitions=N (N >= 5) for a test,\n"
+        << "with one repetition only the threshold is applied. Baseline benchmarks\n"
+        << "missing from contender (crashed, renamed, filtered) fail the gate.\n";
+}
+
+/**
+ * @brief Compare two Google Benchmark JSON outputs and gate regressions.
+ *
+ * @param argc number of arguments
+ * @param argv options and paths, see usage()
+ * @return int 0 no regression, 1 regression over threshold or missing
+ *         benchmark, 2 bad input
+ */
+int main(int argc, char* argv[]) {
+    std::string metric{"cpu_time"};
+    double threshold{5.0};
+    double alpha{0.05};
+    std::vector<std::string> paths;
+    for (int index = 1; index < argc; ++index) {
+        std::string argument{argv[index]};
+        if (argument.rfind("--metric=", 0) == 0) {
+            metric = argument.substr(9);
+        } else if (argument.rfind("--threshold=", 0) == 0) {
+            threshold = std::atof(argument.c_str() + 12);
+        } else if (argument.rfind("--alpha=", 0) == 0) {
+            alpha = std::atof(argument.c_str() + 8);
+        } else if (argument.rfind("--", 0) == 0) {
+            usage();
+            return (2);
+        } else {
+            paths.push_back(argument);
+        }
+    }
+    if (paths.size() != 2) {
+        usage();
+        return (2);
+    }
+    Samples baseline;
+    Samples contender;
+    if (!load(paths[0], metric, baseline) || !load(paths[1], metric, contender)) {
+        return (2);
+    }
+    if (baseline.empty()) {
+        std::cerr << "Error Compare : no " << metric << " samples in " << paths[0] << std::endl;
+        return (2);
+    }
+    bool higher_is_better = metric.size() > 11 &&
+        metric.compare(metric.size() - 11, 11, "_per_second") == 0;
+    size_t regressions{0};
+    size_t improvements{0};
+    size_t missing{0};
+    std::printf("%-40s %14s %14s %9s %8s  %s\n", "Benchmark", "Baseline",
+        "Contender", "Change", "p-value", "Verdict");
+    for (const auto& [name, values] : baseline) {
+        auto found = std::find_if(contender.begin(), contender.end(),
+            [&name](const auto& entry) { return entry.first == name; });
+        if (found == contender.end() || values.empty() || found->second.empty()) {
+            std::printf("%-40s %14s %14s %9s %8s  %s\n", name.c_str(), "", "", "", "", "missing");
+            ++missing;
+            continue;
+        }
+        double before = median(values);
+        double after = median(found->second);
+        double change = before != 0.0 ? (after - before) / before * 100.0 : 0.0;
+        double worse = higher_is_better ? -change : change;
+        bool tested = values.size() > 1 && found->second.size() > 1;
+        double p_value = tested ? mann_whitney(values, found->second) : 0.0;
+        bool significant = !tested || p_value < alpha;
+        const char* verdict = "~";
+        if (significant && worse > threshold) {
+            verdict = "REGRESSION";
+            ++regressions;
+        } else if (significant && -worse > threshold) {
+            verdict = "improvement";
+            ++improvements;
+        }
+        char p_text[16];
+        std::snprintf(p_text, sizeof(p_text), tested ? "%.4f" : "n/a", p_value);
+        std::printf("%-40s %14.2f %14.2f %+8.2f%% %8s  %s\n", name.c_str(),
+            before, after, change, p_text, verdict);
+    }
+    std::printf("\n%zu regression(s), %zu improvement(s), %zu missing, metric %s, "
+        "threshold %.2f%%, alpha %.3f\n", regressions, improvements, missing,
+        metric.c_str(), threshold, alpha);
+    return (regressions || missing ? 1 : 0);
+}
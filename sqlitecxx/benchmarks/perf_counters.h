@@ -0,0 +1,173 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * perf_counters.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <benchmark/benchmark.h>
+
+/**
+ * @brief Environment variable which disables perf counters when set to 0.
+ */
+#define SQLITECXX_PERF_ENV "SQLITECXX_PERF"
+
+/**
+ * @brief PerfCounters. Linux perf_event_open counters of calling thread
+ *        (cycles, instructions, cache misses, branch misses, page faults)
+ *        reported as benchmark counters per operation. Counters which
+ *        kernel or hardware (VMs, containers) don't provide are skipped.
+ */
+class PerfCounters final {
+
+  struct Event {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+  static constexpr std::array<Event, 5> events{{
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+  }};
+
+  std::array<int, events.size()> descriptors;
+
+  static int open(const Event& event) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = event.type;
+    attributes.config = event.config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(
+        syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0)
+    );
+  }
+
+  void control(unsigned long request) {
+    for (int descriptor : this->descriptors) {
+      if (descriptor >= 0) {
+        ioctl(descriptor, request, 0);
+      }
+    }
+  }
+
+  /**
+   * @brief Counter value scaled for time it was not scheduled (multiplexing).
+   */
+  static double value(int descriptor) {
+    uint64_t values[3]{};
+    if (::read(descriptor, values, sizeof(values)) != sizeof(values) ||
+        values[2] == 0) {
+      return 0.0;
+    }
+    return static_cast<double>(values[0]) * values[1] / values[2];
+  }
+
+  public:
+    /**
+     * @brief Construct a new PerfCounters object, opens disabled counters.
+     */
+    PerfCounters() {
+      const char* enabled = std::getenv(SQLITECXX_PERF_ENV);
+      for (size_t index = 0; index < events.size(); ++index) {
+        this->descriptors[index] = (enabled && std::strcmp(enabled, "0") == 0) ?
+            -1 : open(events[index]);
+      }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief Destructor for PerfCounters object, closes counters.
+     */
+    ~PerfCounters() {
+      for (int descriptor : this->descriptors) {
+        if (descriptor >= 0) {
+          close(descriptor);
+        }
+      }
+    }
+
+    /**
+     * @brief Reset and start counting, call right before benchmark loop.
+     */
+    void start() {
+      this->control(PERF_EVENT_IOC_RESET);
+      this->control(PERF_EVENT_IOC_ENABLE);
+    }
+
+    /**
+     * @brief Stop counting, pair with state.PauseTiming().
+     */
+    void pause() {
+      this->control(PERF_EVENT_IOC_DISABLE);
+    }
+
+    /**
+     * @brief Continue counting, pair with state.ResumeTiming().
+     */
+    void resume() {
+      this->control(PERF_EVENT_IOC_ENABLE);
+    }
+
+    /**
+     * @brief Stop counting and add per operation counters to benchmark.
+     * @param state benchmark state.
+     * @param operations operations per iteration (rows, items), values
+     *        are divided by iterations * operations.
+     */
+    void report(benchmark::State& state, int64_t operations = 1) {
+      this->pause();
+      double divisor = static_cast<double>(state.iterations()) *
+          static_cast<double>(operations > 0 ? operations : 1);
+      if (divisor <= 0.0) {
+        return;
+      }
+      double totals[events.size()]{};
+      for (size_t index = 0; index < events.size(); ++index) {
+        if (this->descriptors[index] < 0) {
+          continue;
+        }
+        totals[index] = value(this->descriptors[index]);
+        state.counters[events[index].name] = totals[index] / divisor;
+      }
+      if (this->descriptors[0] >= 0 && this->descriptors[1] >= 0 && totals[0] > 0.0) {
+        state.counters["IPC"] = totals[1] / totals[0];
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,191 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * aggregate.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <new>
+#include <tuple>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <sqlite3.h>
+#include "function.h"
+
+/**
+ * @brief AggregateFunction. Registration of C++ state types as SQL
+ *        aggregate and window functions (sqlite3_create_window_function()).
+ *        State type S is default constructible and provides:
+ *          void step(A...)      adds row, arity and conversions of
+ *                               arguments are derived from signature
+ *          R value() const      current result (window) or final result
+ *          void inverse(A...)   optional, removes row leaving sliding
+ *                               window frame (O(1) frame steps), without
+ *                               it window frames must start at UNBOUNDED
+ *                               PRECEDING
+ *        State is constructed in place in sqlite3_aggregate_context()
+ *        memory of each group or partition (no heap allocation by the
+ *        registration itself) and destroyed after final result.
+ */
+class AggregateFunction final {
+
+  /**
+   * @brief State in aggregate context, SQLite zeroes memory on first use.
+   */
+  template <class S>
+  struct Slot {
+    bool constructed;
+    alignas(S) unsigned char storage[sizeof(S)];
+
+    S& get() {
+      if (!this->constructed) {
+        new (this->storage) S{};
+        this->constructed = true;
+      }
+      return *std::launder(reinterpret_cast<S*>(this->storage));
+    }
+
+    void destroy() {
+      if (this->constructed) {
+        std::launder(reinterpret_cast<S*>(this->storage))->~S();
+        this->constructed = false;
+      }
+    }
+  };
+
+  template <class S, class = void>
+  struct Invertible : std::false_type {};
+
+  template <class S>
+  struct Invertible<S, std::void_t<decltype(&S::inverse)>> : std::true_type {};
+
+  template <class S>
+  static Slot<S>* slot(sqlite3_context* context) {
+    return static_cast<Slot<S>*>(sqlite3_aggregate_context(context, sizeof(Slot<S>)));
+  }
+
+  template <class M, class S, size_t... I>
+  static void apply(M method, S& state, sqlite3_value** values, std::index_sequence<I...>) {
+    using Arguments = typename Signature<M>::arguments;
+    (state.*method)(Convert::argument<std::tuple_element_t<I, Arguments>>(values[I])...);
+  }
+
+  template <class S, class M>
+  static void row(M method, sqlite3_context* context, sqlite3_value** values) {
+    Slot<S>* state = slot<S>(context);
+    if (!state) {
+      sqlite3_result_error_nomem(context);
+      return;
+    }
+    try {
+      apply(method, state->get(), values, std::make_index_sequence<Signature<M>::arity>{});
+    } catch (...) {
+      Convert::error(context);
+    }
+  }
+
+  template <class S>
+  static void step(sqlite3_context* context, int, sqlite3_value** values) {
+    row<S>(&S::step, context, values);
+  }
+
+  template <class S>
+  static void inverse(sqlite3_context* context, int, sqlite3_value** values) {
+    row<S>(&S::inverse, context, values);
+  }
+
+  /**
+   * @brief Inverse of state without inverse(), frame can only grow.
+   */
+  static void refuse(sqlite3_context* context, int, sqlite3_value**) {
+    sqlite3_result_error(
+        context, "aggregate has no inverse(), window frame must start at UNBOUNDED PRECEDING", -1
+    );
+  }
+
+  template <class S>
+  static void value(sqlite3_context* context) {
+    Slot<S>* state = slot<S>(context);
+    if (!state) {
+      sqlite3_result_error_nomem(context);
+      return;
+    }
+    try {
+      Convert::result(context, std::as_const(state->get()).value());
+    } catch (...) {
+      Convert::error(context);
+    }
+  }
+
+  /**
+   * @brief Final result, empty group (no step) gets value() of new state.
+   */
+  template <class S>
+  static void finish(sqlite3_context* context) {
+    Slot<S>* state = static_cast<Slot<S>*>(sqlite3_aggregate_context(context, 0));
+    try {
+      if (state && state->constructed) {
+        Convert::result(context, std::as_const(state->get()).value());
+      } else {
+        const S empty{};
+        Convert::result(context, empty.value());
+      }
+    } catch (...) {
+      Convert::error(context);
+    }
+    if (state) {
+      state->destroy();
+    }
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    AggregateFunction() = delete;
+
+    /**
+     * @brief Register state type S as SQL aggregate and window function.
+     * @param db connection.
+     * @param name SQL function name.
+     * @param flags SQLITE_DETERMINISTIC, SQLITE_INNOCUOUS, SQLITE_DIRECTONLY.
+     * @return int SQLite status code.
+     */
+    template <class S>
+    static int create(sqlite3* db, const std::string& name, int flags = SQLITECXX_FUNCTION_FLAGS) {
+      using Step = Signature<decltype(&S::step)>;
+      static_assert(std::is_default_constructible_v<S>, "aggregate state must be default constructible");
+      static_assert(alignof(S) <= 8, "aggregate context is 8 byte aligned");
+      if constexpr (Invertible<S>::value) {
+        static_assert(Signature<decltype(&S::inverse)>::arity == Step::arity,
+            "inverse() must take same arguments as step()");
+        return sqlite3_create_window_function(
+            db, name.c_str(), Step::arity, SQLITE_UTF8 | flags, nullptr,
+            &step<S>, &finish<S>, &value<S>, &inverse<S>, nullptr
+        );
+      } else {
+        return sqlite3_create_window_function(
+            db, name.c_str(), Step::arity, SQLITE_UTF8 | flags, nullptr,
+            &step<S>, &finish<S>, &value<S>, &refuse, nullptr
+        );
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,322 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * allocation.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <new>
+#include <cstdint>
+#include <cstdlib>
+#include <sqlite3.h>
+
+/**
+ * @brief AllocationCounters. Allocations of calling thread.
+ */
+struct AllocationCounters {
+  uint64_t allocations{0};
+  uint64_t deallocations{0};
+  uint64_t bytes{0};            /* requested bytes of allocations */
+};
+
+/**
+ * @brief Allocation. Per thread counting of global operator new/delete
+ *        and SQLite allocator. operator new/delete are replaced in the one
+ *        translation unit which defines SQLITECXX_ALLOCATION_HOOKS before
+ *        including this header (test or benchmark main), SQLite allocator
+ *        is wrapped by install_sqlite() before first connection is opened.
+ */
+class Allocation final {
+
+  static AllocationCounters& heap_counters() {
+    static thread_local AllocationCounters counters;
+    return counters;
+  }
+
+  static AllocationCounters& sqlite_counters() {
+    static thread_local AllocationCounters counters;
+    return counters;
+  }
+
+  static sqlite3_mem_methods& original() {
+    static sqlite3_mem_methods methods{};
+    return methods;
+  }
+
+  static void* sqlite_malloc(int size) {
+    AllocationCounters& counters = sqlite_counters();
+    ++counters.allocations;
+    counters.bytes += static_cast<uint64_t>(size);
+    return original().xMalloc(size);
+  }
+
+  static void sqlite_free(void* pointer) {
+    if (pointer) {
+      ++sqlite_counters().deallocations;
+    }
+    original().xFree(pointer);
+  }
+
+  static void* sqlite_realloc(void* pointer, int size) {
+    AllocationCounters& counters = sqlite_counters();
+    ++counters.allocations;
+    counters.bytes += static_cast<uint64_t>(size);
+    if (pointer) {
+      ++counters.deallocations;
+    }
+    return original().xRealloc(pointer, size);
+  }
+
+  static int sqlite_size(void* pointer) {
+    return original().xSize(pointer);
+  }
+
+  static int sqlite_roundup(int size) {
+    return original().xRoundup(size);
+  }
+
+  static int sqlite_init(void* data) {
+    return original().xInit(data);
+  }
+
+  static void sqlite_shutdown(void* data) {
+    original().xShutdown(data);
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Allocation() = delete;
+
+    /**
+     * @brief Count operator new of size bytes (used by hooks).
+     * @param size requested bytes.
+     */
+    static void on_new(size_t size) {
+      AllocationCounters& counters = heap_counters();
+      ++counters.allocations;
+      counters.bytes += size;
+    }
+
+    /**
+     * @brief Count operator delete (used by hooks).
+     */
+    static void on_delete() {
+      ++heap_counters().deallocations;
+    }
+
+    /**
+     * @brief Wrap SQLite allocator with counting one, must be called
+     *        before SQLite is initialized (first connection is opened).
+     * @return bool true when SQLite allocator is counted.
+     */
+    static bool install_sqlite() {
+      static bool installed{false};
+      if (installed) {
+        return true;
+      }
+      if (sqlite3_config(SQLITE_CONFIG_GETMALLOC, &original()) != SQLITE_OK) {
+        return false;
+      }
+      sqlite3_mem_methods methods{
+        &sqlite_malloc, &sqlite_free, &sqlite_realloc, &sqlite_size,
+        &sqlite_roundup, &sqlite_init, &sqlite_shutdown, original().pAppData
+      };
+      installed = sqlite3_config(SQLITE_CONFIG_MALLOC, &methods) == SQLITE_OK;
+      return installed;
+    }
+
+    /**
+     * @brief Getter for operator new/delete counters of calling thread.
+     * @return AllocationCounters represent counters since thread start.
+     */
+    static AllocationCounters heap() {
+      return heap_counters();
+    }
+
+    /**
+     * @brief Getter for SQLite allocator counters of calling thread.
+     * @return AllocationCounters represent counters since thread start.
+     */
+    static AllocationCounters sqlite() {
+      return sqlite_counters();
+    }
+};
+
+/**
+ * @brief AllocationScope. Allocations of calling thread since construction.
+ */
+class AllocationScope final {
+
+  AllocationCounters heap_start;
+  AllocationCounters sqlite_start;
+  AllocationCounters heap_paused{};
+  AllocationCounters sqlite_paused{};
+
+  static AllocationCounters difference(
+      const AllocationCounters& now, const AllocationCounters& start
+  ) {
+    return {
+      now.allocations - start.allocations,
+      now.deallocations - start.deallocations,
+      now.bytes - start.bytes
+    };
+  }
+
+  static void shift(AllocationCounters& start, const AllocationCounters& skipped) {
+    start.allocations += skipped.allocations;
+    start.deallocations += skipped.deallocations;
+    start.bytes += skipped.bytes;
+  }
+
+  public:
+    /**
+     * @brief Construct a new AllocationScope object, starts counting.
+     */
+    AllocationScope() : heap_start{Allocation::heap()}, sqlite_start{Allocation::sqlite()} {}
+
+    /**
+     * @brief Start counting again.
+     */
+    void reset() {
+      this->heap_start = Allocation::heap();
+      this->sqlite_start = Allocation::sqlite();
+    }
+
+    /**
+     * @brief Stop counting, pair with state.PauseTiming() in benchmarks.
+     */
+    void pause() {
+      this->heap_paused = Allocation::heap();
+      this->sqlite_paused = Allocation::sqlite();
+    }
+
+    /**
+     * @brief Continue counting, allocations since pause() are skipped.
+     */
+    void resume() {
+      shift(this->heap_start, difference(Allocation::heap(), this->heap_paused));
+      shift(this->sqlite_start, difference(Allocation::sqlite(), this->sqlite_paused));
+    }
+
+    /**
+     * @brief Getter for operator new/delete counters of scope.
+     * @return AllocationCounters represent heap allocations.
+     */
+    AllocationCounters get_heap() const {
+      return difference(Allocation::heap(), this->heap_start);
+    }
+
+    /**
+     * @brief Getter for SQLite allocator counters of scope.
+     * @return AllocationCounters represent SQLite allocations.
+     */
+    AllocationCounters get_sqlite() const {
+      return difference(Allocation::sqlite(), this->sqlite_start);
+    }
+
+    /**
+     * @brief Getter for number of all allocations of scope.
+     * @return uint64_t operator new and SQLite allocations.
+     */
+    uint64_t get_allocations() const {
+      return this->get_heap().allocations + this->get_sqlite().allocations;
+    }
+};
+
+#ifdef SQLITECXX_ALLOCATION_HOOKS
+
+/* GCC sees std::free() of inlined replacement delete as mismatched */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+  Allocation::on_new(size);
+  if (void* pointer = std::malloc(size ? size : 1)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  Allocation::on_new(size);
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+  return ::operator new(size, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  Allocation::on_new(size);
+  size_t align = static_cast<size_t>(alignment);
+  if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return ::operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer) {
+    Allocation::on_delete();
+  }
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+  ::operator delete(pointer);
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+#endif
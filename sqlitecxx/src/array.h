@@ -0,0 +1,309 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * array.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <span>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <sqlite3.h>
+#include "column.h"
+#include "datatypes.h"
+
+/**
+ * @brief Name of table-valued function over bound arrays.
+ */
+#define SQLITECXX_ARRAY "sqlitecxx_array"
+
+/**
+ * @brief ArrayTable. Table-valued function (carray-style) which returns
+ *        values of Column<T> or std::span bound as one statement parameter,
+ *        so one prepared statement serves key sets of any size:
+ *        SELECT * FROM t WHERE id IN sqlitecxx_array(?1). Values are read
+ *        from caller storage without copy (text and blob included), so
+ *        it must outlive sqlite3_step() and must not change meanwhile.
+ *        Binding of NULL returns no rows.
+ */
+class ArrayTable final {
+
+  /**
+   * @brief Forward iteration over bound values.
+   */
+  struct Walker {
+    virtual ~Walker() = default;
+    virtual bool eof() const = 0;
+    virtual void next() = 0;
+    virtual void result(sqlite3_context* context) const = 0;
+  };
+
+  /**
+   * @brief Type erased bound values, owned by statement parameter.
+   */
+  struct Values {
+    virtual ~Values() = default;
+    virtual size_t size() const = 0;
+    virtual std::unique_ptr<Walker> walk() const = 0;
+  };
+
+  template <class Range>
+  struct Bound final : Values {
+    Range range;
+
+    explicit Bound(Range range) : range{range} {}
+
+    struct Position final : Walker {
+      decltype(std::begin(std::declval<Range&>())) current;
+      decltype(std::end(std::declval<Range&>())) end;
+
+      Position(Range& range) : current{std::begin(range)}, end{std::end(range)} {}
+
+      bool eof() const override {
+        return this->current == this->end;
+      }
+
+      void next() override {
+        ++(this->current);
+      }
+
+      void result(sqlite3_context* context) const override {
+        ArrayTable::result(context, *this->current);
+      }
+    };
+
+    size_t size() const override {
+      return std::size(this->range);
+    }
+
+    std::unique_ptr<Walker> walk() const override {
+      return std::make_unique<Position>(const_cast<Range&>(this->range));
+    }
+  };
+
+  struct Cursor : sqlite3_vtab_cursor {
+    std::unique_ptr<Walker> walker{};
+    sqlite3_int64 row{0};
+  };
+
+  template <class V>
+  static void result(sqlite3_context* context, const V& value) {
+    if constexpr (std::is_integral_v<V>) {
+      sqlite3_result_int64(context, static_cast<sqlite3_int64>(value));
+    } else if constexpr (std::is_floating_point_v<V>) {
+      sqlite3_result_double(context, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const V&, std::string_view>) {
+      std::string_view text{value};
+      sqlite3_result_text64(context, text.data(), text.size(), SQLITE_STATIC, SQLITE_UTF8);
+    } else {
+      static_assert(std::is_arithmetic_v<V>, "unsupported array element type");
+    }
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Integer<T>& value) {
+    sqlite3_result_int64(context, static_cast<sqlite3_int64>(value.get()));
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Real<T>& value) {
+    sqlite3_result_double(context, static_cast<double>(value.get()));
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Text<T>& value) {
+    sqlite3_result_text64(
+        context, std::data(value.get()), std::size(value.get()), SQLITE_STATIC, SQLITE_UTF8
+    );
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Blob<T>& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      sqlite3_result_blob64(context, &value.get(), sizeof(T), SQLITE_STATIC);
+    } else {
+      sqlite3_result_blob64(
+          context, std::data(value.get()),
+          std::size(value.get()) * sizeof(*std::data(value.get())), SQLITE_STATIC
+      );
+    }
+  }
+
+  static void release(void* values) {
+    delete static_cast<Values*>(values);
+  }
+
+  static int connect(
+      sqlite3* db, void*, int, const char* const*, sqlite3_vtab** vtab, char**
+  ) {
+    int status = sqlite3_declare_vtab(db, "CREATE TABLE x(value, pointer HIDDEN)");
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+    *vtab = new sqlite3_vtab{};
+    return SQLITE_OK;
+  }
+
+  static int disconnect(sqlite3_vtab* vtab) {
+    delete vtab;
+    return SQLITE_OK;
+  }
+
+  /**
+   * @brief Plan requires equality on hidden pointer column (function
+   *        argument), without it table can't be scanned.
+   */
+  static int best_index(sqlite3_vtab*, sqlite3_index_info* info) {
+    for (int index = 0; index < info->nConstraint; ++index) {
+      const auto& constraint = info->aConstraint[index];
+      if (constraint.iColumn == 1 && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+        if (!constraint.usable) {
+          return SQLITE_CONSTRAINT;
+        }
+        info->aConstraintUsage[index].argvIndex = 1;
+        info->aConstraintUsage[index].omit = 1;
+        info->estimatedCost = 1.0;
+        info->estimatedRows = 100;
+        info->idxNum = 1;
+        return SQLITE_OK;
+      }
+    }
+    return SQLITE_CONSTRAINT;
+  }
+
+  static int open(sqlite3_vtab*, sqlite3_vtab_cursor** cursor) {
+    *cursor = new Cursor{};
+    return SQLITE_OK;
+  }
+
+  static int close(sqlite3_vtab_cursor* cursor) {
+    delete static_cast<Cursor*>(cursor);
+    return SQLITE_OK;
+  }
+
+  static int filter(
+      sqlite3_vtab_cursor* cursor, int, const char*, int count, sqlite3_value** values
+  ) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    scan->row = 0;
+    scan->walker.reset();
+    const Values* bound = count > 0 ?
+        static_cast<const Values*>(sqlite3_value_pointer(values[0], SQLITECXX_ARRAY)) : nullptr;
+    if (bound && bound->size()) {
+      scan->walker = bound->walk();
+    }
+    return SQLITE_OK;
+  }
+
+  static int next(sqlite3_vtab_cursor* cursor) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    scan->walker->next();
+    ++(scan->row);
+    return SQLITE_OK;
+  }
+
+  static int eof(sqlite3_vtab_cursor* cursor) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    return !scan->walker || scan->walker->eof();
+  }
+
+  static int column(sqlite3_vtab_cursor* cursor, sqlite3_context* context, int index) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    if (index == 0) {
+      scan->walker->result(context);
+    }
+    return SQLITE_OK;
+  }
+
+  static int rowid(sqlite3_vtab_cursor* cursor, sqlite3_int64* rowid) {
+    *rowid = static_cast<Cursor*>(cursor)->row;
+    return SQLITE_OK;
+  }
+
+  static const sqlite3_module* module() {
+    static const sqlite3_module methods = [] {
+      sqlite3_module methods{};
+      methods.xConnect = &connect;
+      methods.xBestIndex = &best_index;
+      methods.xDisconnect = &disconnect;
+      methods.xOpen = &open;
+      methods.xClose = &close;
+      methods.xFilter = &filter;
+      methods.xNext = &next;
+      methods.xEof = &eof;
+      methods.xColumn = &column;
+      methods.xRowid = &rowid;
+      return methods;
+    }();
+    return &methods;
+  }
+
+  template <class Range>
+  static int bind_range(sqlite3_stmt* statement, int index, Range range) {
+    return sqlite3_bind_pointer(
+        statement, index, new Bound<Range>(range), SQLITECXX_ARRAY, &release
+    );
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    ArrayTable() = delete;
+
+    /**
+     * @brief Register sqlitecxx_array() table-valued function of connection.
+     * @param db connection.
+     * @return int SQLite status code.
+     */
+    static int create(sqlite3* db) {
+      return sqlite3_create_module_v2(db, SQLITECXX_ARRAY, module(), nullptr, nullptr);
+    }
+
+    /**
+     * @brief Bind values of column to parameter (no copy).
+     * @param statement prepared statement.
+     * @param index parameter index (1 based).
+     * @param column reference to Column<T> object.
+     * @return int SQLite status code.
+     */
+    template <class T>
+    static int bind(sqlite3_stmt* statement, int index, Column<T>& column) {
+      return bind_range<std::list<T>&>(statement, index, column.get_data());
+    }
+
+    /**
+     * @brief Bind span of values to parameter (no copy), elements are
+     *        integral, floating point, string-like or sqlitecxx data types.
+     * @param statement prepared statement.
+     * @param index parameter index (1 based).
+     * @param values span over caller storage.
+     * @return int SQLite status code.
+     */
+    template <class T, size_t E>
+    static int bind(sqlite3_stmt* statement, int index, std::span<T, E> values) {
+      return bind_range<std::span<const T>>(statement, index, std::span<const T>{values});
+    }
+};
+
+#endif
@@ -20,10 +20,7 @@
 #ifndef BASE_H
 #define BASE_H
 
-#include <iostream>
-#include <verbose.h>
-
-#define SQLITECXX_BASE "sqlitecxx::base::"
+#include <trace.h>
 
 template <class T>
 class Base {
@@ -45,10 +42,7 @@ class Base {
      * @param payload value for integral data.
      */
     explicit Base(T payload) : payload{payload} {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BASE << __func__;
-      std::cout << " user defined cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(base, constructor, this, payload);
     }
 
     /**
@@ -56,10 +50,7 @@ class Base {
      * @param source reference to Base <T> object for copy. 
      */
     Base(Base<T>& source) : payload{source.payload} {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BASE << __func__ << " Base<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(base, copy_constructor, this);
     }
 
     /**
@@ -67,20 +58,14 @@ class Base {
      * @param source const reference to Base<T> object for copy. 
      */
     Base(const Base<T>& source) : payload{source.payload} {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BASE << __func__ << " const Base<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(base, copy_constructor, this);
     }
 
     /**
      * @brief Destructor for Base<T> object.
      */
     ~Base() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BASE << __func__;
-      std::cout << " default dstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(base, destructor, this);
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -94,10 +79,16 @@ class Base {
      * @return T represent integral datatype.
      */
     T& get() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BASE << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(base, get, this);
+      return this->payload;
+    }
+
+    /**
+     * @brief Const getter for payload of Base<T> data.
+     * @return const T& represent integral datatype.
+     */
+    const T& get() const {
+      SQLITECXX_TRACE(base, get, this);
       return this->payload;
     }
 
@@ -106,11 +97,7 @@ class Base {
      * @param payload represent integral data.
      */
     void set(T payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BASE << __func__;
-      std::cout << " arg : " << payload;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(base, set, this, payload);
       this->payload = payload;
     }
 };
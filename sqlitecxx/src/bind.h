@@ -0,0 +1,122 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * bind.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BIND_H
+#define BIND_H
+
+#include <iterator>
+#include <type_traits>
+#include <sqlite3.h>
+#include "datatypes.h"
+
+/**
+ * @brief Bind. Binding of sqlitecxx data types to prepared statement
+ *        parameters, text and blob payloads are bound without copy so
+ *        they must outlive sqlite3_step().
+ */
+class Bind final {
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Bind() = delete;
+
+    /**
+     * @brief Bind Integer<T> to parameter.
+     * @param statement prepared statement.
+     * @param index parameter index (1 based).
+     * @param value const reference to Integer<T> object.
+     * @return int SQLite status code.
+     */
+    template <class T>
+    static int value(sqlite3_stmt* statement, int index, const Integer<T>& value) {
+      return sqlite3_bind_int64(
+          statement, index, static_cast<sqlite3_int64>(value.get())
+      );
+    }
+
+    /**
+     * @brief Bind Real<T> to parameter.
+     * @param statement prepared statement.
+     * @param index parameter index (1 based).
+     * @param value const reference to Real<T> object.
+     * @return int SQLite status code.
+     */
+    template <class T>
+    static int value(sqlite3_stmt* statement, int index, const Real<T>& value) {
+      return sqlite3_bind_double(
+          statement, index, static_cast<double>(value.get())
+      );
+    }
+
+    /**
+     * @brief Bind Text<T> to parameter (no copy).
+     * @param statement prepared statement.
+     * @param index parameter index (1 based).
+     * @param value const reference to Text<T> object.
+     * @return int SQLite status code.
+     */
+    template <class T>
+    static int value(sqlite3_stmt* statement, int index, const Text<T>& value) {
+      return sqlite3_bind_text64(
+          statement, index, std::data(value.get()), std::size(value.get()),
+          SQLITE_STATIC, SQLITE_UTF8
+      );
+    }
+
+    /**
+     * @brief Bind Blob<T> to parameter (no copy).
+     * @param statement prepared statement.
+     * @param index parameter index (1 based).
+     * @param value const reference to Blob<T> object.
+     * @return int SQLite status code.
+     */
+    template <class T>
+    static int value(sqlite3_stmt* statement, int index, const Blob<T>& value) {
+      if constexpr (std::is_arithmetic_v<T>) {
+        return sqlite3_bind_blob64(
+            statement, index, &value.get(), sizeof(T), SQLITE_STATIC
+        );
+      } else {
+        return sqlite3_bind_blob64(
+            statement, index, std::data(value.get()),
+            std::size(value.get()) * sizeof(*std::data(value.get())),
+            SQLITE_STATIC
+        );
+      }
+    }
+
+    /**
+     * @brief Bind row of values to parameters 1..N.
+     * @param statement prepared statement.
+     * @param values const references to sqlitecxx data type objects.
+     * @return int SQLite status code of first failed bind or SQLITE_OK.
+     */
+    template <class... V>
+    static int row(sqlite3_stmt* statement, const V&... values) {
+      int status{SQLITE_OK};
+      int index{0};
+      ((status = (status == SQLITE_OK) ?
+          Bind::value(statement, ++index, values) : status), ...);
+      return status;
+    }
+};
+
+#endif
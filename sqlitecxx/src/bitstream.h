@@ -0,0 +1,169 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * bitstream.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief BitWriter. Appends MSB-first bit fields to 64-bit words.
+ */
+class BitWriter final {
+
+  std::vector<uint64_t> words;
+  size_t bit_count{0};
+
+  public:
+    /**
+     * @brief Append lowest bits of value to stream.
+     * @param value bits to be written (upper bits are ignored).
+     * @param bits number of bits in range 0 - 64.
+     */
+    void write(uint64_t value, unsigned bits) {
+      if (bits == 0) {
+        return;
+      }
+      if (bits < 64) {
+        value &= (uint64_t{1} << bits) - 1;
+      }
+      unsigned used = this->bit_count & 63;
+      if (used == 0) {
+        this->words.push_back(0);
+      }
+      unsigned avail = 64 - used;
+      if (bits <= avail) {
+        this->words.back() |= value << (avail - bits);
+      } else {
+        this->words.back() |= value >> (bits - avail);
+        this->words.push_back(value << (64 - (bits - avail)));
+      }
+      this->bit_count += bits;
+    }
+
+    /**
+     * @brief Append single bit to stream.
+     * @param bit value of bit.
+     */
+    void write_bit(bool bit) {
+      this->write(bit ? 1 : 0, 1);
+    }
+
+    /**
+     * @brief Pad stream with zero bits up to next word boundary.
+     */
+    void align() {
+      this->bit_count = this->words.size() * 64;
+    }
+
+    /**
+     * @brief Getter for number of written bits.
+     * @return size_t number of bits in stream.
+     */
+    size_t size() const {
+      return this->bit_count;
+    }
+
+    /**
+     * @brief Getter for underlying words.
+     * @return std::vector<uint64_t>& represent written words.
+     */
+    std::vector<uint64_t>& get_words() {
+      return this->words;
+    }
+
+    /**
+     * @brief Const getter for underlying words.
+     * @return const std::vector<uint64_t>& represent written words.
+     */
+    const std::vector<uint64_t>& get_words() const {
+      return this->words;
+    }
+};
+
+/**
+ * @brief BitReader. Reads MSB-first bit fields written by BitWriter.
+ */
+class BitReader final {
+
+  const uint64_t* words{nullptr};
+  size_t position{0};
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    BitReader() = delete;
+
+    /**
+     * @brief Construct a new BitReader object.
+     * @param words pointer to first word of stream.
+     * @param position bit position where reading starts.
+     */
+    explicit BitReader(const uint64_t* words, size_t position = 0)
+    : words{words}, position{position} {
+    }
+
+    /**
+     * @brief Read bit field from stream.
+     * @param bits number of bits in range 0 - 64.
+     * @return uint64_t represent value of bit field.
+     */
+    uint64_t read(unsigned bits) {
+      if (bits == 0) {
+        return 0;
+      }
+      size_t index = this->position >> 6;
+      unsigned used = this->position & 63;
+      unsigned avail = 64 - used;
+      uint64_t result{0};
+      if (bits <= avail) {
+        result = (this->words[index] << used) >> (64 - bits);
+      } else {
+        unsigned rest = bits - avail;
+        result = ((this->words[index] << used) >> used) << rest;
+        result |= this->words[index + 1] >> (64 - rest);
+      }
+      this->position += bits;
+      return result;
+    }
+
+    /**
+     * @brief Read single bit from stream.
+     * @return bool value of bit.
+     */
+    bool read_bit() {
+      bool bit = (this->words[this->position >> 6] >>
+          (63 - (this->position & 63))) & 1;
+      ++(this->position);
+      return bit;
+    }
+
+    /**
+     * @brief Getter for current bit position.
+     * @return size_t position in bits.
+     */
+    size_t get_position() const {
+      return this->position;
+    }
+};
+
+#endif
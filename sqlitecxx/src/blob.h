@@ -20,10 +20,10 @@
 #ifndef BLOB_H
 #define BLOB_H
 
+#include <string>
+#include <ostream>
 #include <base.h>
 
-#define SQLITECXX_BLOB "sqlitecxx::blob::"
-
 /**
  * @brief Blob<T>. Value is a blob of data, stored exactly as it was input.
  * @tparam T - int8_t | char.
@@ -42,10 +42,7 @@ class Blob final : Base<T> {
      * @param payload value for BLOB data.
      */
     explicit Blob(T payload) : Base<T>(payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " user defined cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, constructor, this, payload);
     }
 
     /**
@@ -53,10 +50,7 @@ class Blob final : Base<T> {
      * @param source reference to Blob<T> object for copy. 
      */
     Blob(Blob<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__ << " Blob<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, copy_constructor, this);
     }
 
     /**
@@ -64,20 +58,14 @@ class Blob final : Base<T> {
      * @param source const reference to Blob<T> object for copy. 
      */
     Blob(const Blob<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__ << " const Blob<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, copy_constructor, this);
     }
 
     /**
      * @brief Destructor for Blob<T> object.
      */
     ~Blob() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " default dstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, destructor, this);
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -94,6 +82,11 @@ class Blob final : Base<T> {
       return "Blob";
     }
 
+    /**
+     * @brief Getters for payload of Blob<T> BLOB data.
+     */
+    using Base<T>::get;
+
     ///////////////////////////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////
     // Assignment operators
@@ -105,11 +98,7 @@ class Blob final : Base<T> {
      * @param payload payload for BLOB data.
      */
     void operator=(T payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__ << " BLOB";
-      std::cout << " arg : " << payload;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, assign, this, payload);
       this->payload = payload;
     }
 
@@ -118,12 +107,7 @@ class Blob final : Base<T> {
      * @param source reference to Blob<T> object.
      */
     void operator=(Blob<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__ << " Blob<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -132,12 +116,7 @@ class Blob final : Base<T> {
      * @param source const reference to Blob<T> object.
      */
     void operator=(const Blob<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__ << " const Blob<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -153,10 +132,7 @@ class Blob final : Base<T> {
      * @return Blob<T> represent result Blob<T> object.
      */
     Blob<T> operator+(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(blob, add, this);
       Blob<T> temp{0};
       temp.payload = (
           (this->payload) + (other.payload)
@@ -169,11 +145,8 @@ class Blob final : Base<T> {
      * @param source const reference to right operand Blob<T> object.
      * @return bool true for not equal else false.
      */
-    bool operator!=(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator!=(const Blob<T>& other) const {
+      SQLITECXX_TRACE(blob, not_equal, this);
       return (this->payload) != (other.payload);
     }
 
@@ -182,11 +155,8 @@ class Blob final : Base<T> {
      * @param source const reference to right operand Blob<T> object.
      * @return bool true for equal else false.
      */
-    bool operator==(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator==(const Blob<T>& other) const {
+      SQLITECXX_TRACE(blob, equal, this);
       return (this->payload) == (other.payload);
     }
 
@@ -195,11 +165,8 @@ class Blob final : Base<T> {
      * @param source const reference to right operand Blob<T> object.
      * @return bool true for greater or equal else false.
      */
-    bool operator>=(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>=(const Blob<T>& other) const {
+      SQLITECXX_TRACE(blob, greater_equal, this);
       return (this->payload) >= (other.payload);
     }
 
@@ -208,11 +175,8 @@ class Blob final : Base<T> {
      * @param source const reference to right operand Blob<T> object.
      * @return bool true for less or equal else false.
      */
-    bool operator<=(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<=(const Blob<T>& other) const {
+      SQLITECXX_TRACE(blob, less_equal, this);
       return (this->payload) <= (other.payload);
     }
 
@@ -221,11 +185,8 @@ class Blob final : Base<T> {
      * @param source const reference to right operand Blob<T> object.
      * @return bool true for greater else false.
      */
-    bool operator>(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>(const Blob<T>& other) const {
+      SQLITECXX_TRACE(blob, greater, this);
       return (this->payload) > (other.payload);
     }
 
@@ -234,11 +195,8 @@ class Blob final : Base<T> {
      * @param source const reference to right operand Blob<T> object.
      * @return bool true for less else false.
      */
-    bool operator<(const Blob<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_BLOB << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<(const Blob<T>& other) const {
+      SQLITECXX_TRACE(blob, less, this);
       return (this->payload) < (other.payload);
     }
 
@@ -0,0 +1,271 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * busy.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUSY_H
+#define BUSY_H
+
+#include <map>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include <condition_variable>
+#include <sqlite3.h>
+#include "histogram.h"
+
+/**
+ * @brief BusyOptions. Busy strategy of connection.
+ */
+struct BusyOptions {
+  std::chrono::microseconds initial_delay{100};   /* first backoff delay */
+  std::chrono::microseconds max_delay{50000};     /* cap of one delay */
+  std::chrono::microseconds max_wait{5000000};    /* give up (SQLITE_BUSY) after */
+  double multiplier{2.0};                         /* delay growth per retry */
+  double jitter{0.5};                             /* random part of delay, 0.0 - 1.0 */
+  bool fair{false};                               /* FIFO order of waiters in process */
+};
+
+/**
+ * @brief BusyMetrics. Contention counters of one connection.
+ */
+struct BusyMetrics {
+  uint64_t busy_events{0};     /* lock conflicts (first busy callback) */
+  uint64_t retries{0};         /* busy callback invocations */
+  uint64_t timeouts{0};        /* conflicts given up after max_wait */
+  uint64_t wait_nanoseconds{0};/* time spent sleeping in busy handler */
+  Histogram acquisition;       /* first conflict until successful retry (ns) */
+};
+
+/**
+ * @brief BusyHandler. sqlite3_busy_handler() with exponential backoff,
+ *        jitter and maximal wait. In fair mode waiters on same database
+ *        file in this process are queued in arrival order and head of
+ *        queue polls the lock with backoff, others mostly sleep. Conflict
+ *        is finished by the next conflict or statement end.
+ */
+class BusyHandler final {
+
+  /**
+   * @brief FIFO of waiting connections of one database file.
+   */
+  struct FairQueue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<const BusyHandler*> waiters;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  BusyOptions options;
+  std::shared_ptr<FairQueue> queue{};
+  std::mt19937_64 random;
+  std::mutex mutex;
+  BusyMetrics metrics;
+  bool pending{false};
+  bool queued{false};
+  Clock::time_point started{};
+  Clock::time_point retried{};
+
+  static std::shared_ptr<FairQueue> fair_queue(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<FairQueue>> queues;
+    std::lock_guard<std::mutex> lock{mutex};
+    std::shared_ptr<FairQueue> queue = queues[path].lock();
+    if (!queue) {
+      queue = std::make_shared<FairQueue>();
+      queues[path] = queue;
+    }
+    return queue;
+  }
+
+  void enqueue() {
+    if (!this->queue || this->queued) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock{this->queue->mutex};
+    this->queue->waiters.push_back(this);
+    this->queued = true;
+  }
+
+  void dequeue() {
+    if (!this->queue || !this->queued) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock{this->queue->mutex};
+      auto& waiters = this->queue->waiters;
+      waiters.erase(std::remove(waiters.begin(), waiters.end(), this), waiters.end());
+      this->queued = false;
+    }
+    this->queue->changed.notify_all();
+  }
+
+  /**
+   * @brief Finish pending conflict, successful when not timed out.
+   */
+  void finish(bool acquired) {
+    if (!this->pending) {
+      return;
+    }
+    this->pending = false;
+    this->dequeue();
+    std::lock_guard<std::mutex> lock{this->mutex};
+    if (acquired) {
+      this->metrics.acquisition.record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              this->retried - this->started
+          ).count()
+      ));
+    } else {
+      ++(this->metrics.timeouts);
+    }
+  }
+
+  std::chrono::nanoseconds delay(int count) {
+    double delay = static_cast<double>(this->options.initial_delay.count()) *
+        std::pow(this->options.multiplier, std::min(count, 62));
+    delay = std::min(delay, static_cast<double>(this->options.max_delay.count()));
+    double jitter = std::clamp(this->options.jitter, 0.0, 1.0);
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    delay = delay * (1.0 - jitter) + delay * jitter * uniform(this->random);
+    return std::chrono::nanoseconds(static_cast<int64_t>(delay * 1000.0));
+  }
+
+  /**
+   * @brief Wait for next retry, false when max_wait is exceeded. In fair
+   *        mode waiter which is not head of queue sleeps until it becomes
+   *        head or for max_delay, so lock holder stuck behind it in queue
+   *        still makes progress.
+   */
+  bool wait(int count) {
+    Clock::time_point now = Clock::now();
+    Clock::time_point deadline = this->started + this->options.max_wait;
+    if (now >= deadline) {
+      return false;
+    }
+    Clock::time_point begin{now};
+    Clock::time_point wake = std::min(deadline, now + this->delay(count));
+    bool head{true};
+    if (this->queue) {
+      std::unique_lock<std::mutex> lock{this->queue->mutex};
+      head = this->queue->changed.wait_until(
+          lock, std::min(deadline, now + this->options.max_delay), [this] {
+            return !this->queue->waiters.empty() &&
+                this->queue->waiters.front() == this;
+          }
+      );
+      lock.unlock();
+      now = Clock::now();
+      wake = std::min(deadline, now + this->delay(count));
+    }
+    if (head) {
+      std::this_thread::sleep_until(wake);
+    }
+    this->retried = Clock::now();
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->metrics.wait_nanoseconds += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(this->retried - begin).count()
+    );
+    return true;
+  }
+
+  public:
+    /**
+     * @brief Construct a new BusyHandler object.
+     * @param options busy strategy.
+     * @param path database file, waiters of same file share fair queue.
+     * @param metrics counters carried over from replaced handler.
+     */
+    BusyHandler(BusyOptions options, const std::string& path, BusyMetrics metrics = {})
+    : options{options}, random{std::random_device{}()}, metrics{metrics} {
+      if (options.fair) {
+        this->queue = fair_queue(path);
+      }
+    }
+
+    BusyHandler(const BusyHandler&) = delete;
+    BusyHandler& operator=(const BusyHandler&) = delete;
+
+    /**
+     * @brief Destructor for BusyHandler object, leaves fair queue.
+     */
+    ~BusyHandler() {
+      this->dequeue();
+    }
+
+    /**
+     * @brief Busy callback for sqlite3_busy_handler().
+     * @param context pointer to BusyHandler object.
+     * @param count number of prior invocations for same conflict.
+     * @return int 1 to retry, 0 to fail with SQLITE_BUSY.
+     */
+    static int callback(void* context, int count) {
+      BusyHandler* handler = static_cast<BusyHandler*>(context);
+      if (count == 0) {
+        handler->finish(true);
+        handler->pending = true;
+        handler->started = Clock::now();
+        handler->retried = handler->started;
+        handler->enqueue();
+        std::lock_guard<std::mutex> lock{handler->mutex};
+        ++(handler->metrics.busy_events);
+      }
+      {
+        std::lock_guard<std::mutex> lock{handler->mutex};
+        ++(handler->metrics.retries);
+      }
+      if (!handler->wait(count)) {
+        handler->finish(false);
+        return 0;
+      }
+      return 1;
+    }
+
+    /**
+     * @brief Statement finished, pending conflict was resolved.
+     */
+    void on_statement_end() {
+      this->finish(true);
+    }
+
+    /**
+     * @brief Copy of contention counters.
+     * @return BusyMetrics represent metrics snapshot.
+     */
+    BusyMetrics snapshot() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      return this->metrics;
+    }
+
+    /**
+     * @brief Forget contention counters.
+     */
+    void reset() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->metrics = BusyMetrics{};
+    }
+};
+
+#endif
@@ -24,9 +24,7 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
-#include "verbose.h"
-
-#define SQLITECXX_COLUMN "sqlitecxx::column::"
+#include "trace.h"
 
 template <class T>
 class Column final {
@@ -42,83 +40,50 @@ class Column final {
 
     explicit Column(std::string name, bool primary_key)
     : name{name}, type{T::get_sql_type()}, primary_key{primary_key} {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " user defined cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, constructor, this, name);
     }
 
     Column(Column<T>& source)
     :  name{source.name}, type{source.type}, primary_key{source.primary_key} {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__ << " Column<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, copy_constructor, this);
     }
 
     Column(const Column<T>& source)
     :  name{source.name}, type{source.type}, primary_key{source.primary_key} {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__ << " const Column<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, copy_constructor, this);
     }
 
     ~Column() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " default dstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, destructor, this);
     }
 
     std::string& get_name() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, get_name, this);
       return this->name;
     }
 
     void set_name(std::string name) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " arg : " << name;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, set_name, this, name);
       this->name = name;
     }
 
     std::string& get_type() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, get_type, this);
       return this->type;
     }
 
     void set_type(std::string type) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " arg : " << type;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, set_type, this, type);
       this->type = type;
     }
 
     bool& get_primary_key() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, get_primary_key, this);
       return this->primary_key;
     }
 
     void set_primary_key(bool primary_key) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_COLUMN << __func__;
-      std::cout << " arg : " << primary_key;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(column, set_primary_key, this, primary_key);
       this->primary_key = primary_key;
     }
 
@@ -0,0 +1,699 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * columnar.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <span>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <sqlite3.h>
+#include "column.h"
+#include "datatypes.h"
+#include "mapped.h"
+
+/**
+ * @brief Magic bytes at start of columnar file.
+ */
+#define SQLITECXX_COLUMNAR_MAGIC "SQLCXCOL"
+
+/**
+ * @brief Version of columnar file layout.
+ */
+#define SQLITECXX_COLUMNAR_VERSION 1
+
+/**
+ * @brief Alignment of every buffer in file (Arrow recommends 64 bytes).
+ */
+#define SQLITECXX_COLUMNAR_ALIGNMENT 64
+
+/**
+ * @brief ColumnarHeader. First 64 bytes of columnar file.
+ */
+struct ColumnarHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;              /* 0x01020304 in writer byte order */
+  uint64_t rows;
+  uint32_t columns;             /* descriptors follow header */
+  uint32_t reserved;
+  uint64_t strings;             /* offset of names and SQL types */
+  uint64_t strings_size;
+  uint64_t size;                /* file size */
+  uint64_t padding;
+};
+
+/**
+ * @brief ColumnarDescriptor. Location of buffers of one column, buffers
+ *        follow Arrow columnar layout: LSB validity bitmap (absent when
+ *        column has no NULL), value buffer of little-endian fixed width
+ *        values, or offsets (rows + 1 of int32 or int64) into byte buffer
+ *        for TEXT (Utf8/LargeUtf8) and BLOB (Binary/LargeBinary).
+ */
+struct ColumnarDescriptor {
+  uint32_t type;                /* SQLITE_INTEGER | SQLITE_FLOAT | SQLITE_TEXT | SQLITE_BLOB */
+  uint32_t width;               /* bytes per value, bytes per offset for TEXT/BLOB */
+  uint32_t name;                /* name within strings */
+  uint32_t name_size;
+  uint32_t sql_type;            /* get_sql_type() within strings */
+  uint32_t sql_type_size;
+  uint64_t null_count;
+  uint64_t validity;            /* 0 when column has no NULL */
+  uint64_t offsets;             /* 0 for fixed width column */
+  uint64_t values;
+  uint64_t values_size;
+};
+
+static_assert(sizeof(ColumnarHeader) == SQLITECXX_COLUMNAR_ALIGNMENT);
+static_assert(sizeof(ColumnarDescriptor) == SQLITECXX_COLUMNAR_ALIGNMENT);
+
+/**
+ * @brief ColumnarWriter. Collects columns (from Column<T> or query result)
+ *        and writes them as columnar file.
+ */
+class ColumnarWriter final {
+
+  /**
+   * @brief Buffers of one column being built.
+   */
+  struct Builder {
+    std::string name;
+    std::string sql_type;
+    int type{SQLITE_NULL};
+    uint32_t width{0};
+    uint64_t rows{0};
+    uint64_t null_count{0};
+    std::vector<uint8_t> validity;
+    std::vector<int64_t> offsets;
+    std::vector<uint8_t> values;
+
+    bool variable() const {
+      return this->type == SQLITE_TEXT || this->type == SQLITE_BLOB;
+    }
+
+    /**
+     * @brief Fix type of column, NULLs appended before are materialized.
+     */
+    void set_type(int type, uint32_t width) {
+      this->type = type;
+      this->width = width;
+      if (this->variable()) {
+        this->offsets.assign(this->rows + 1, 0);
+      } else {
+        this->values.assign(this->rows * width, 0);
+      }
+    }
+
+    void next(bool valid) {
+      if (this->rows % 8 == 0) {
+        this->validity.push_back(0);
+      }
+      if (valid) {
+        this->validity.back() |= static_cast<uint8_t>(1u << (this->rows % 8));
+      } else {
+        ++(this->null_count);
+      }
+      ++(this->rows);
+    }
+
+    void append(const void* data, size_t size) {
+      const uint8_t* bytes = static_cast<const uint8_t*>(data);
+      this->values.insert(this->values.end(), bytes, bytes + size);
+      if (this->variable()) {
+        this->offsets.push_back(static_cast<int64_t>(this->values.size()));
+      }
+      this->next(true);
+    }
+
+    void append_null() {
+      if (this->variable()) {
+        this->offsets.push_back(static_cast<int64_t>(this->values.size()));
+      } else if (this->type != SQLITE_NULL) {
+        this->values.resize(this->values.size() + this->width, 0);
+      }
+      this->next(false);
+    }
+  };
+
+  std::vector<Builder> builders;
+
+  static uint64_t align(uint64_t offset) {
+    return (offset + SQLITECXX_COLUMNAR_ALIGNMENT - 1) /
+        SQLITECXX_COLUMNAR_ALIGNMENT * SQLITECXX_COLUMNAR_ALIGNMENT;
+  }
+
+  static void pad(std::ofstream& out, uint64_t& offset) {
+    static const char zeros[SQLITECXX_COLUMNAR_ALIGNMENT]{};
+    uint64_t aligned = align(offset);
+    out.write(zeros, static_cast<std::streamsize>(aligned - offset));
+    offset = aligned;
+  }
+
+  template <class T>
+  static void append(Builder& builder, const Integer<T>& value) {
+    auto payload = static_cast<T>(value.get());
+    builder.append(&payload, sizeof(payload));
+  }
+
+  template <class T>
+  static void append(Builder& builder, const Real<T>& value) {
+    auto payload = static_cast<T>(value.get());
+    builder.append(&payload, sizeof(payload));
+  }
+
+  template <class T>
+  static void append(Builder& builder, const Text<T>& value) {
+    builder.append(std::data(value.get()), std::size(value.get()));
+  }
+
+  template <class T>
+  static void append(Builder& builder, const Blob<T>& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      builder.append(&value.get(), sizeof(T));
+    } else {
+      builder.append(
+          std::data(value.get()),
+          std::size(value.get()) * sizeof(*std::data(value.get()))
+      );
+    }
+  }
+
+  template <class T>
+  static void describe(Builder& builder, const Integer<T>*) {
+    builder.set_type(SQLITE_INTEGER, sizeof(T));
+  }
+
+  template <class T>
+  static void describe(Builder& builder, const Real<T>*) {
+    builder.set_type(SQLITE_FLOAT, sizeof(T));
+  }
+
+  template <class T>
+  static void describe(Builder& builder, const Text<T>*) {
+    builder.set_type(SQLITE_TEXT, 0);
+  }
+
+  template <class T>
+  static void describe(Builder& builder, const Blob<T>*) {
+    builder.set_type(SQLITE_BLOB, 0);
+  }
+
+  public:
+    /**
+     * @brief Add copy of column, all added columns must be of same length.
+     * @param column Column<T> of sqlitecxx data type.
+     */
+    template <class T>
+    void add(Column<T>& column) {
+      Builder& builder = this->builders.emplace_back();
+      builder.name = column.get_name();
+      builder.sql_type = column.get_type();
+      describe(builder, static_cast<const T*>(nullptr));
+      builder.values.reserve(column.get_data().size() * builder.width);
+      for (const auto& value : column.get_data()) {
+        append(builder, value);
+      }
+    }
+
+    /**
+     * @brief Add all result columns of query, column type is declared
+     *        affinity or type of first non-NULL value, later values are
+     *        converted to it by SQLite.
+     * @param db connection.
+     * @param sql query.
+     * @return uint64_t number of rows added.
+     */
+    uint64_t add(sqlite3* db, const std::string& sql) {
+      sqlite3_stmt* statement{nullptr};
+      if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(std::string("prepare : ") + sqlite3_errmsg(db));
+      }
+      size_t first = this->builders.size();
+      int count = sqlite3_column_count(statement);
+      for (int column = 0; column < count; ++column) {
+        Builder& builder = this->builders.emplace_back();
+        builder.name = sqlite3_column_name(statement, column);
+        const char* declared = sqlite3_column_decltype(statement, column);
+        builder.sql_type = declared ? declared : "";
+      }
+      uint64_t rows{0};
+      int status;
+      while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+        for (int column = 0; column < count; ++column) {
+          Builder& builder = this->builders[first + column];
+          int type = sqlite3_column_type(statement, column);
+          if (type == SQLITE_NULL) {
+            builder.append_null();
+            continue;
+          }
+          if (builder.type == SQLITE_NULL) {
+            builder.set_type(type, (type == SQLITE_INTEGER || type == SQLITE_FLOAT) ? 8 : 0);
+          }
+          if (builder.type == SQLITE_INTEGER) {
+            int64_t value = sqlite3_column_int64(statement, column);
+            builder.append(&value, sizeof(value));
+          } else if (builder.type == SQLITE_FLOAT) {
+            double value = sqlite3_column_double(statement, column);
+            builder.append(&value, sizeof(value));
+          } else if (builder.type == SQLITE_TEXT) {
+            const unsigned char* text = sqlite3_column_text(statement, column);
+            builder.append(text, static_cast<size_t>(sqlite3_column_bytes(statement, column)));
+          } else {
+            const void* blob = sqlite3_column_blob(statement, column);
+            builder.append(blob, static_cast<size_t>(sqlite3_column_bytes(statement, column)));
+          }
+        }
+        ++rows;
+      }
+      sqlite3_finalize(statement);
+      if (status != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step : ") + sqlite3_errmsg(db));
+      }
+      for (size_t column = first; column < this->builders.size(); ++column) {
+        Builder& builder = this->builders[column];
+        if (builder.type == SQLITE_NULL) {
+          builder.set_type(SQLITE_TEXT, 0);
+        }
+        if (builder.sql_type.empty()) {
+          builder.sql_type = builder.type == SQLITE_INTEGER ? INTEGER::get_sql_type() :
+              builder.type == SQLITE_FLOAT ? REAL::get_sql_type() :
+              builder.type == SQLITE_TEXT ? TEXT::get_sql_type() : BLOB::get_sql_type();
+        }
+      }
+      return rows;
+    }
+
+    /**
+     * @brief Write added columns to file (little-endian host only).
+     * @param path output file, replaced when it exists.
+     */
+    void write(const std::string& path) {
+      uint64_t rows = this->builders.empty() ? 0 : this->builders.front().rows;
+      for (const auto& builder : this->builders) {
+        if (builder.rows != rows) {
+          throw std::invalid_argument("columns differ in length");
+        }
+      }
+      std::string strings;
+      std::vector<ColumnarDescriptor> descriptors(this->builders.size());
+      uint64_t offset = sizeof(ColumnarHeader) + descriptors.size() * sizeof(ColumnarDescriptor);
+      for (size_t column = 0; column < this->builders.size(); ++column) {
+        const Builder& builder = this->builders[column];
+        ColumnarDescriptor& descriptor = descriptors[column];
+        descriptor.type = static_cast<uint32_t>(builder.type);
+        descriptor.name = static_cast<uint32_t>(strings.size());
+        descriptor.name_size = static_cast<uint32_t>(builder.name.size());
+        strings += builder.name;
+        descriptor.sql_type = static_cast<uint32_t>(strings.size());
+        descriptor.sql_type_size = static_cast<uint32_t>(builder.sql_type.size());
+        strings += builder.sql_type;
+      }
+      ColumnarHeader header{};
+      std::memcpy(header.magic, SQLITECXX_COLUMNAR_MAGIC, sizeof(header.magic));
+      header.version = SQLITECXX_COLUMNAR_VERSION;
+      header.endian = 0x01020304;
+      header.rows = rows;
+      header.columns = static_cast<uint32_t>(descriptors.size());
+      header.strings = offset;
+      header.strings_size = strings.size();
+      offset = align(offset + strings.size());
+      for (size_t column = 0; column < this->builders.size(); ++column) {
+        const Builder& builder = this->builders[column];
+        ColumnarDescriptor& descriptor = descriptors[column];
+        descriptor.null_count = builder.null_count;
+        if (builder.null_count) {
+          descriptor.validity = offset;
+          offset = align(offset + builder.validity.size());
+        }
+        if (builder.variable()) {
+          descriptor.width = builder.values.size() >
+              static_cast<size_t>(std::numeric_limits<int32_t>::max()) ? 8 : 4;
+          descriptor.offsets = offset;
+          offset = align(offset + (rows + 1) * descriptor.width);
+        } else {
+          descriptor.width = builder.width;
+        }
+        descriptor.values = offset;
+        descriptor.values_size = builder.values.size();
+        offset = align(offset + builder.values.size());
+      }
+      header.size = offset;
+      std::ofstream out{path, std::ios::binary | std::ios::trunc};
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(
+          reinterpret_cast<const char*>(descriptors.data()),
+          static_cast<std::streamsize>(descriptors.size() * sizeof(ColumnarDescriptor))
+      );
+      out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+      offset = header.strings + strings.size();
+      pad(out, offset);
+      for (size_t column = 0; column < this->builders.size(); ++column) {
+        const Builder& builder = this->builders[column];
+        const ColumnarDescriptor& descriptor = descriptors[column];
+        if (descriptor.validity) {
+          out.write(
+              reinterpret_cast<const char*>(builder.validity.data()),
+              static_cast<std::streamsize>(builder.validity.size())
+          );
+          offset += builder.validity.size();
+          pad(out, offset);
+        }
+        if (descriptor.offsets) {
+          for (int64_t value : builder.offsets) {
+            int32_t narrow = static_cast<int32_t>(value);
+            out.write(
+                descriptor.width == 8 ? reinterpret_cast<const char*>(&value) :
+                reinterpret_cast<const char*>(&narrow), descriptor.width
+            );
+          }
+          offset += (rows + 1) * descriptor.width;
+          pad(out, offset);
+        }
+        out.write(
+            reinterpret_cast<const char*>(builder.values.data()),
+            static_cast<std::streamsize>(builder.values.size())
+        );
+        offset += builder.values.size();
+        pad(out, offset);
+      }
+      if (!out.flush()) {
+        throw std::runtime_error("write " + path);
+      }
+    }
+};
+
+/**
+ * @brief ColumnarFile. Memory-mapped columnar file, values are read in
+ *        place without parsing, only header and buffer bounds are
+ *        validated on open.
+ */
+class ColumnarFile final {
+
+  MappedFile file;
+  const ColumnarHeader* header{nullptr};
+  const ColumnarDescriptor* descriptors{nullptr};
+
+  [[noreturn]] static void invalid(const std::string& what) {
+    throw std::runtime_error("columnar file : " + what);
+  }
+
+  bool inside(uint64_t offset, uint64_t size) const {
+    return offset <= this->file.get_size() && size <= this->file.get_size() - offset;
+  }
+
+  const ColumnarDescriptor& descriptor(size_t column) const {
+    if (column >= this->header->columns) {
+      throw std::out_of_range("column index out of range");
+    }
+    return this->descriptors[column];
+  }
+
+  int64_t offset(const ColumnarDescriptor& descriptor, uint64_t row) const {
+    const char* offsets = this->file.get_data() + descriptor.offsets;
+    if (descriptor.width == 8) {
+      return reinterpret_cast<const int64_t*>(offsets)[row];
+    }
+    return reinterpret_cast<const int32_t*>(offsets)[row];
+  }
+
+  template <class V, class S>
+  V number(const ColumnarDescriptor& descriptor, uint64_t row) const {
+    const char* values = this->file.get_data() + descriptor.values;
+    return static_cast<V>(reinterpret_cast<const S*>(values)[row]);
+  }
+
+  template <class V>
+  V integer(const ColumnarDescriptor& descriptor, uint64_t row) const {
+    switch (descriptor.width) {
+      case 1:
+        return this->number<V, int8_t>(descriptor, row);
+      case 2:
+        return this->number<V, int16_t>(descriptor, row);
+      case 4:
+        return this->number<V, int32_t>(descriptor, row);
+      default:
+        return this->number<V, int64_t>(descriptor, row);
+    }
+  }
+
+  template <class V>
+  V real(const ColumnarDescriptor& descriptor, uint64_t row) const {
+    if (descriptor.width == 4) {
+      return this->number<V, float>(descriptor, row);
+    }
+    return this->number<V, double>(descriptor, row);
+  }
+
+  template <class T>
+  void append(size_t column, uint64_t row, Column<Integer<T>>& target) const {
+    const ColumnarDescriptor& source = this->descriptor(column);
+    T value = source.type == SQLITE_INTEGER ? this->integer<T>(source, row) :
+        source.type == SQLITE_FLOAT ? this->real<T>(source, row) : T{};
+    target.get_data().push_back(Integer<T>{value});
+  }
+
+  template <class T>
+  void append(size_t column, uint64_t row, Column<Real<T>>& target) const {
+    const ColumnarDescriptor& source = this->descriptor(column);
+    T value = source.type == SQLITE_FLOAT ? this->real<T>(source, row) :
+        source.type == SQLITE_INTEGER ? this->integer<T>(source, row) : T{};
+    target.get_data().push_back(Real<T>{value});
+  }
+
+  template <class T>
+  void append(size_t column, uint64_t row, Column<Text<T>>& target) const {
+    target.get_data().push_back(Text<T>{T(this->get_bytes(column, row))});
+  }
+
+  template <class T>
+  void append(size_t column, uint64_t row, Column<Blob<T>>& target) const {
+    std::string_view bytes = this->get_bytes(column, row);
+    if constexpr (std::is_arithmetic_v<T>) {
+      T value{};
+      std::memcpy(&value, bytes.data(), std::min(bytes.size(), sizeof(T)));
+      target.get_data().push_back(Blob<T>{value});
+    } else {
+      target.get_data().push_back(Blob<T>{T(bytes.begin(), bytes.end())});
+    }
+  }
+
+  public:
+    /**
+     * @brief Construct a new ColumnarFile object, maps and validates file.
+     * @param path columnar file written by ColumnarWriter.
+     */
+    explicit ColumnarFile(const std::string& path) : file{path, MADV_WILLNEED} {
+      if (!this->inside(0, sizeof(ColumnarHeader))) {
+        invalid("truncated header");
+      }
+      this->header = reinterpret_cast<const ColumnarHeader*>(this->file.get_data());
+      if (std::memcmp(this->header->magic, SQLITECXX_COLUMNAR_MAGIC, sizeof(this->header->magic))) {
+        invalid("bad magic");
+      }
+      if (this->header->version != SQLITECXX_COLUMNAR_VERSION) {
+        invalid("unsupported version");
+      }
+      if (this->header->endian != 0x01020304) {
+        invalid("foreign byte order");
+      }
+      if (this->header->size != this->file.get_size() ||
+          !this->inside(sizeof(ColumnarHeader),
+              uint64_t{this->header->columns} * sizeof(ColumnarDescriptor)) ||
+          !this->inside(this->header->strings, this->header->strings_size)) {
+        invalid("truncated file");
+      }
+      this->descriptors = reinterpret_cast<const ColumnarDescriptor*>(
+          this->file.get_data() + sizeof(ColumnarHeader)
+      );
+      uint64_t rows = this->header->rows;
+      for (uint32_t column = 0; column < this->header->columns; ++column) {
+        const ColumnarDescriptor& descriptor = this->descriptors[column];
+        bool variable = descriptor.type == SQLITE_TEXT || descriptor.type == SQLITE_BLOB;
+        bool valid =
+            uint64_t{descriptor.name} + descriptor.name_size <= this->header->strings_size &&
+            uint64_t{descriptor.sql_type} + descriptor.sql_type_size <= this->header->strings_size &&
+            (!descriptor.validity || this->inside(descriptor.validity, (rows + 7) / 8)) &&
+            this->inside(descriptor.values, descriptor.values_size);
+        if (variable) {
+          valid = valid && (descriptor.width == 4 || descriptor.width == 8) &&
+              this->inside(descriptor.offsets, (rows + 1) * descriptor.width) &&
+              this->offset(descriptor, rows) >= 0 &&
+              static_cast<uint64_t>(this->offset(descriptor, rows)) <= descriptor.values_size;
+        } else {
+          valid = valid && (descriptor.type == SQLITE_INTEGER || descriptor.type == SQLITE_FLOAT) &&
+              descriptor.width && descriptor.values_size == rows * descriptor.width;
+        }
+        if (!valid) {
+          invalid("bad column " + std::to_string(column));
+        }
+      }
+    }
+
+    /**
+     * @brief Getter for number of rows.
+     * @return uint64_t rows of every column.
+     */
+    uint64_t get_rows() const {
+      return this->header->rows;
+    }
+
+    /**
+     * @brief Getter for number of columns.
+     * @return size_t number of columns.
+     */
+    size_t get_columns() const {
+      return this->header->columns;
+    }
+
+    /**
+     * @brief Index of column with name.
+     * @param name column name.
+     * @return size_t index or get_columns() when there is no such column.
+     */
+    size_t find(std::string_view name) const {
+      size_t column{0};
+      while (column < this->get_columns() && this->get_name(column) != name) {
+        ++column;
+      }
+      return column;
+    }
+
+    /**
+     * @brief Getter for column name.
+     * @param column column index.
+     * @return std::string_view name in mapping.
+     */
+    std::string_view get_name(size_t column) const {
+      const ColumnarDescriptor& source = this->descriptor(column);
+      return {this->file.get_data() + this->header->strings + source.name, source.name_size};
+    }
+
+    /**
+     * @brief Getter for SQL type of column (get_sql_type() or declared).
+     * @param column column index.
+     * @return std::string_view SQL type in mapping.
+     */
+    std::string_view get_sql_type(size_t column) const {
+      const ColumnarDescriptor& source = this->descriptor(column);
+      return {
+        this->file.get_data() + this->header->strings + source.sql_type, source.sql_type_size
+      };
+    }
+
+    /**
+     * @brief Getter for storage type of column.
+     * @param column column index.
+     * @return int SQLITE_INTEGER | SQLITE_FLOAT | SQLITE_TEXT | SQLITE_BLOB.
+     */
+    int get_type(size_t column) const {
+      return static_cast<int>(this->descriptor(column).type);
+    }
+
+    /**
+     * @brief Getter for bytes per value (bytes per offset for TEXT/BLOB).
+     * @param column column index.
+     * @return uint32_t width of value.
+     */
+    uint32_t get_width(size_t column) const {
+      return this->descriptor(column).width;
+    }
+
+    /**
+     * @brief Getter for number of NULL values of column.
+     * @param column column index.
+     * @return uint64_t number of NULLs.
+     */
+    uint64_t get_null_count(size_t column) const {
+      return this->descriptor(column).null_count;
+    }
+
+    /**
+     * @brief Check whether value is not NULL.
+     * @param column column index.
+     * @param row row index.
+     * @return bool true for non-NULL value.
+     */
+    bool is_valid(size_t column, uint64_t row) const {
+      const ColumnarDescriptor& source = this->descriptor(column);
+      if (!source.validity) {
+        return true;
+      }
+      const uint8_t* bitmap = reinterpret_cast<const uint8_t*>(this->file.get_data() + source.validity);
+      return (bitmap[row >> 3] >> (row & 7)) & 1;
+    }
+
+    /**
+     * @brief Values of fixed width column in place (NULL slots are 0).
+     * @tparam T value type of width and kind of column (int64_t, double...).
+     * @param column column index.
+     * @return std::span<const T> represent values in mapping.
+     */
+    template <class T>
+    std::span<const T> get_values(size_t column) const {
+      const ColumnarDescriptor& source = this->descriptor(column);
+      bool integral = source.type == SQLITE_INTEGER && std::is_integral_v<T>;
+      bool floating = source.type == SQLITE_FLOAT && std::is_floating_point_v<T>;
+      if ((!integral && !floating) || source.width != sizeof(T)) {
+        throw std::invalid_argument("column is not of requested value type");
+      }
+      return {reinterpret_cast<const T*>(this->file.get_data() + source.values), this->get_rows()};
+    }
+
+    /**
+     * @brief Bytes of TEXT or BLOB value in place.
+     * @param column column index.
+     * @param row row index.
+     * @return std::string_view represent value (empty for NULL).
+     */
+    std::string_view get_bytes(size_t column, uint64_t row) const {
+      const ColumnarDescriptor& source = this->descriptor(column);
+      if (!source.offsets) {
+        throw std::invalid_argument("column is not TEXT or BLOB");
+      }
+      int64_t begin = this->offset(source, row);
+      int64_t end = this->offset(source, row + 1);
+      if (begin < 0 || end < begin || static_cast<uint64_t>(end) > source.values_size) {
+        invalid("bad offsets");
+      }
+      return {this->file.get_data() + source.values + begin, static_cast<size_t>(end - begin)};
+    }
+
+    /**
+     * @brief Copy column into Column<T> (appended in row order), NULL is
+     *        default value, Column<Text<std::string_view>> references
+     *        mapping instead of copying.
+     * @param column column index.
+     * @param target Column<T> of sqlitecxx data type.
+     */
+    template <class T>
+    void load(size_t column, Column<T>& target) const {
+      for (uint64_t row = 0; row < this->get_rows(); ++row) {
+        this->append(column, row, target);
+      }
+    }
+};
+
+#endif
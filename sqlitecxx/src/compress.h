@@ -0,0 +1,840 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * compress.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <map>
+#include <new>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <sqlite3.h>
+#include "hash.h"
+#include "lz.h"
+
+/**
+ * @brief Name of page-compressing VFS.
+ */
+#define SQLITECXX_COMPRESS_VFS "sqlitecxx-compress"
+
+/**
+ * @brief Magic bytes of header of compressed database file.
+ */
+#define SQLITECXX_COMPRESS_MAGIC "SQLCXCMP"
+
+/**
+ * @brief Bytes at start of compressed file reserved for two headers.
+ */
+#define SQLITECXX_COMPRESS_RESERVED 4096
+
+/**
+ * @brief Decompressed pages cached per open database file.
+ */
+#define SQLITECXX_COMPRESS_CACHE 64
+
+/**
+ * @brief CompressOptions. Behaviour of page-compressing VFS.
+ */
+struct CompressOptions {
+  size_t cache{SQLITECXX_COMPRESS_CACHE};   /* decompressed pages per file */
+};
+
+/**
+ * @brief CompressStats. Counters of page-compressing VFS since install().
+ */
+struct CompressStats {
+  uint64_t page_writes{0};     /* pages stored */
+  uint64_t logical_bytes{0};   /* bytes of stored pages */
+  uint64_t stored_bytes{0};    /* bytes written for them */
+  uint64_t page_reads{0};      /* pages read and decompressed */
+  uint64_t cache_hits{0};      /* pages served from cache */
+  uint64_t commits{0};         /* page index commits */
+};
+
+/**
+ * @brief CompressVfs. Shim VFS which stores every page of main database
+ *        files compressed by Lz codec (journals, WAL and temporary files
+ *        pass through). Pages live in variable sized extents located by
+ *        page index, rewritten page gets new extent (shadow paging) and
+ *        index is written to free space and published by one of two
+ *        checksummed headers on sync (or, when sync is off, at unlock and
+ *        at end of WAL checkpoint before frames are marked backfilled), so
+ *        file on disk always holds last published index. Freed extents
+ *        are reused after next publication, free tail is truncated. Index
+ *        is reloaded when another connection published newer one before
+ *        shared (or WAL read) lock is taken. Memory mapping is disabled
+ *        for compressed files.
+ */
+class CompressVfs final {
+
+  /**
+   * @brief Header, one copy at offsets 0 and 512.
+   */
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t block;            /* page size */
+    uint64_t size;             /* logical file size */
+    uint64_t index;            /* offset of page index */
+    uint64_t index_size;
+    uint64_t generation;
+    uint64_t checksum;
+  };
+
+  /**
+   * @brief Page index entry.
+   */
+  struct Entry {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t kind;             /* zero, lz or raw */
+  };
+
+  static constexpr uint32_t zero{0};
+  static constexpr uint32_t lz{1};
+  static constexpr uint32_t raw{2};
+  static constexpr uint32_t version{1};
+
+  struct File {
+    sqlite3_file base;
+    sqlite3_file* real;
+    bool compressed{false};
+    bool loaded{false};
+    bool dirty{false};
+    uint32_t block{0};
+    uint64_t size{0};
+    uint64_t generation{0};
+    uint64_t index{0};
+    uint64_t index_size{0};
+    uint64_t end{SQLITECXX_COMPRESS_RESERVED};
+    std::vector<Entry> entries;
+    std::map<uint64_t, uint64_t> free;
+    std::vector<std::pair<uint64_t, uint64_t>> released;
+    std::unordered_set<uint64_t> fresh;
+    std::list<std::pair<uint64_t, std::vector<uint8_t>>> lru;
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, std::vector<uint8_t>>>::iterator> cached;
+    std::vector<uint8_t> packed;
+    std::vector<uint8_t> page;
+  };
+
+  static sqlite3_vfs* base_vfs;
+  static sqlite3_vfs vfs;
+  static CompressOptions options;
+  static std::atomic<uint64_t> counters[6];
+
+  static size_t file_size() {
+    return (sizeof(File) + 15) / 16 * 16;
+  }
+
+  static File& self(sqlite3_file* file) {
+    return *reinterpret_cast<File*>(file);
+  }
+
+  static uint64_t checksum(const Header& header) {
+    return Hash::bytes(&header, offsetof(Header, checksum), 0x636f6d7072657373ull);
+  }
+
+  static int physical_read(File& file, void* data, size_t size, uint64_t offset) {
+    return file.real->pMethods->xRead(
+        file.real, data, static_cast<int>(size), static_cast<sqlite3_int64>(offset)
+    );
+  }
+
+  static int physical_write(File& file, const void* data, size_t size, uint64_t offset) {
+    return file.real->pMethods->xWrite(
+        file.real, data, static_cast<int>(size), static_cast<sqlite3_int64>(offset)
+    );
+  }
+
+  /**
+   * @brief Coalescing insert into free extents.
+   */
+  static void add_free(File& file, uint64_t offset, uint64_t length) {
+    if (!length) {
+      return;
+    }
+    auto next = file.free.lower_bound(offset);
+    if (next != file.free.begin()) {
+      auto previous = std::prev(next);
+      if (previous->first + previous->second == offset) {
+        offset = previous->first;
+        length += previous->second;
+        file.free.erase(previous);
+      }
+    }
+    if (next != file.free.end() && offset + length == next->first) {
+      length += next->second;
+      file.free.erase(next);
+    }
+    file.free[offset] = length;
+  }
+
+  /**
+   * @brief First fit extent from free space or end of file.
+   */
+  static uint64_t allocate(File& file, uint64_t length) {
+    for (auto extent = file.free.begin(); extent != file.free.end(); ++extent) {
+      if (extent->second >= length) {
+        uint64_t offset = extent->first;
+        uint64_t rest = extent->second - length;
+        file.free.erase(extent);
+        if (rest) {
+          file.free[offset + length] = rest;
+        }
+        file.fresh.insert(offset);
+        return offset;
+      }
+    }
+    uint64_t offset = file.end;
+    file.end += length;
+    file.fresh.insert(offset);
+    return offset;
+  }
+
+  /**
+   * @brief Extent no longer used by current pages, extent referenced by
+   *        published index is reusable only after next publication.
+   */
+  static void release(File& file, uint64_t offset, uint64_t length) {
+    if (!length) {
+      return;
+    }
+    if (file.fresh.erase(offset)) {
+      add_free(file, offset, length);
+    } else {
+      file.released.emplace_back(offset, length);
+    }
+  }
+
+  static void cache_put(File& file, uint64_t block, const uint8_t* data) {
+    if (!options.cache) {
+      return;
+    }
+    auto found = file.cached.find(block);
+    if (found != file.cached.end()) {
+      std::memcpy(found->second->second.data(), data, file.block);
+      file.lru.splice(file.lru.begin(), file.lru, found->second);
+      return;
+    }
+    if (file.lru.size() >= options.cache) {
+      file.cached.erase(file.lru.back().first);
+      file.lru.pop_back();
+    }
+    file.lru.emplace_front(block, std::vector<uint8_t>(data, data + file.block));
+    file.cached[block] = file.lru.begin();
+  }
+
+  static void cache_clear(File& file) {
+    file.lru.clear();
+    file.cached.clear();
+  }
+
+  /**
+   * @brief Read valid header with highest generation.
+   * @return int SQLITE_OK (header.generation 0 for empty file) or error.
+   */
+  static int read_header(File& file, Header& header) {
+    uint8_t slots[1024];
+    std::memset(&header, 0, sizeof(header));
+    int status = physical_read(file, slots, sizeof(slots), 0);
+    if (status != SQLITE_OK && status != SQLITE_IOERR_SHORT_READ) {
+      return status;
+    }
+    bool empty{true};
+    for (size_t slot = 0; slot < 2; ++slot) {
+      Header candidate;
+      std::memcpy(&candidate, slots + slot * 512, sizeof(candidate));
+      if (std::memcmp(candidate.magic, SQLITECXX_COMPRESS_MAGIC, sizeof(candidate.magic)) == 0) {
+        empty = false;
+        if (candidate.checksum == checksum(candidate) && candidate.version == version &&
+            candidate.generation > header.generation) {
+          header = candidate;
+        }
+      }
+    }
+    if (header.generation == 0 && (!empty || std::any_of(slots, slots + sizeof(slots),
+        [](uint8_t byte) { return byte != 0; }))) {
+      return SQLITE_NOTADB;
+    }
+    return SQLITE_OK;
+  }
+
+  /**
+   * @brief Load page index of newest header unless it is already loaded.
+   */
+  static int load(File& file) {
+    Header header;
+    int status = read_header(file, header);
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    if (file.loaded && header.generation == file.generation) {
+      return SQLITE_OK;
+    }
+    std::vector<Entry> entries;
+    if (header.generation) {
+      size_t count = header.index_size >= sizeof(uint64_t) ?
+          (header.index_size - sizeof(uint64_t)) / sizeof(Entry) : 0;
+      entries.resize(count);
+      uint64_t stored{0};
+      if (count && physical_read(file, entries.data(), count * sizeof(Entry), header.index) != SQLITE_OK) {
+        return SQLITE_CORRUPT;
+      }
+      if (physical_read(file, &stored, sizeof(stored), header.index + count * sizeof(Entry)) != SQLITE_OK ||
+          stored != Hash::bytes(entries.data(), count * sizeof(Entry), header.generation)) {
+        return SQLITE_CORRUPT;
+      }
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> used;
+    for (const auto& entry : entries) {
+      if (entry.kind != zero) {
+        used.emplace_back(entry.offset, entry.length);
+      }
+    }
+    if (header.generation) {
+      used.emplace_back(header.index, header.index_size);
+    }
+    std::sort(used.begin(), used.end());
+    file.free.clear();
+    file.released.clear();
+    file.fresh.clear();
+    uint64_t position = SQLITECXX_COMPRESS_RESERVED;
+    for (const auto& extent : used) {
+      if (extent.first > position) {
+        add_free(file, position, extent.first - position);
+      }
+      position = std::max(position, extent.first + extent.second);
+    }
+    file.end = position;
+    file.entries = std::move(entries);
+    file.block = header.block;
+    file.size = header.size;
+    file.generation = header.generation;
+    file.index = header.index;
+    file.index_size = header.index_size;
+    file.loaded = true;
+    cache_clear(file);
+    return SQLITE_OK;
+  }
+
+  static int ensure(File& file) {
+    return file.loaded ? SQLITE_OK : load(file);
+  }
+
+  /**
+   * @brief Publish page index: write index, sync, write other header
+   *        slot, sync, then reuse released extents.
+   */
+  static int commit(File& file, int flags, bool durable) {
+    if (!file.dirty) {
+      return SQLITE_OK;
+    }
+    uint64_t generation = file.generation + 1;
+    size_t bytes = file.entries.size() * sizeof(Entry);
+    file.packed.resize(bytes + sizeof(uint64_t));
+    std::memcpy(file.packed.data(), file.entries.data(), bytes);
+    uint64_t sum = Hash::bytes(file.entries.data(), bytes, generation);
+    std::memcpy(file.packed.data() + bytes, &sum, sizeof(sum));
+    uint64_t index = allocate(file, file.packed.size());
+    int status = physical_write(file, file.packed.data(), file.packed.size(), index);
+    if (status == SQLITE_OK && durable) {
+      status = file.real->pMethods->xSync(file.real, flags);
+    }
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SQLITECXX_COMPRESS_MAGIC, sizeof(header.magic));
+    header.version = version;
+    header.block = file.block;
+    header.size = file.size;
+    header.index = index;
+    header.index_size = file.packed.size();
+    header.generation = generation;
+    header.checksum = checksum(header);
+    status = physical_write(file, &header, sizeof(header), (generation % 2) * 512);
+    if (status == SQLITE_OK && durable) {
+      status = file.real->pMethods->xSync(file.real, flags);
+    }
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    file.fresh.clear();
+    if (file.generation) {
+      file.released.emplace_back(file.index, file.index_size);
+    }
+    for (const auto& extent : file.released) {
+      add_free(file, extent.first, extent.second);
+    }
+    file.released.clear();
+    file.generation = generation;
+    file.index = index;
+    file.index_size = header.index_size;
+    file.dirty = false;
+    counters[5]++;
+    if (!file.free.empty()) {
+      auto last = std::prev(file.free.end());
+      if (last->first + last->second == file.end) {
+        file.end = last->first;
+        file.free.erase(last);
+        file.real->pMethods->xTruncate(file.real, static_cast<sqlite3_int64>(file.end));
+      }
+    }
+    return SQLITE_OK;
+  }
+
+  /**
+   * @brief Decompressed page into out.
+   */
+  static int fetch(File& file, uint64_t block, uint8_t* out) {
+    if (block >= file.entries.size() || file.entries[block].kind == zero) {
+      std::memset(out, 0, file.block);
+      return SQLITE_OK;
+    }
+    auto found = file.cached.find(block);
+    if (found != file.cached.end()) {
+      std::memcpy(out, found->second->second.data(), file.block);
+      file.lru.splice(file.lru.begin(), file.lru, found->second);
+      counters[4]++;
+      return SQLITE_OK;
+    }
+    const Entry& entry = file.entries[block];
+    if (entry.kind == raw) {
+      if (entry.length != file.block ||
+          physical_read(file, out, file.block, entry.offset) != SQLITE_OK) {
+        return SQLITE_CORRUPT;
+      }
+    } else {
+      file.packed.resize(entry.length);
+      if (physical_read(file, file.packed.data(), entry.length, entry.offset) != SQLITE_OK ||
+          Lz::decompress(file.packed.data(), entry.length, out, file.block) != file.block) {
+        return SQLITE_CORRUPT;
+      }
+    }
+    counters[3]++;
+    cache_put(file, block, out);
+    return SQLITE_OK;
+  }
+
+  /**
+   * @brief Compress and store full page.
+   */
+  static int store(File& file, uint64_t block, const uint8_t* data) {
+    if (block >= file.entries.size()) {
+      file.entries.resize(block + 1, Entry{0, 0, zero});
+    }
+    Entry& entry = file.entries[block];
+    Entry previous = entry;
+    file.dirty = true;
+    if (std::all_of(data, data + file.block, [](uint8_t byte) { return byte == 0; })) {
+      entry = Entry{0, 0, zero};
+    } else {
+      Lz::compress(data, file.block, file.packed);
+      bool packed = file.packed.size() < file.block;
+      const uint8_t* stored = packed ? file.packed.data() : data;
+      uint32_t length = packed ? static_cast<uint32_t>(file.packed.size()) : file.block;
+      uint64_t offset = allocate(file, length);
+      int status = physical_write(file, stored, length, offset);
+      if (status != SQLITE_OK) {
+        release(file, offset, length);
+        return status;
+      }
+      entry = Entry{offset, length, packed ? lz : raw};
+      counters[2] += length;
+    }
+    if (previous.kind != zero) {
+      release(file, previous.offset, previous.length);
+    }
+    counters[0]++;
+    counters[1] += file.block;
+    cache_put(file, block, data);
+    return SQLITE_OK;
+  }
+
+  /**
+   * @brief Page size of new file from first write (SQLite header of page 1).
+   */
+  static uint32_t block_size(const uint8_t* data, int amount, sqlite3_int64 offset) {
+    if (offset == 0 && amount >= 100) {
+      uint32_t size = (static_cast<uint32_t>(data[16]) << 8) | data[17];
+      size = size == 1 ? 65536 : size;
+      if (size >= 512 && size <= 65536 && (size & (size - 1)) == 0) {
+        return size;
+      }
+    }
+    return (amount >= 512 && amount <= 65536 && (amount & (amount - 1)) == 0) ?
+        static_cast<uint32_t>(amount) : 4096;
+  }
+
+  static int close(sqlite3_file* handle) {
+    File& file = self(handle);
+    int status = file.compressed ? commit(file, SQLITE_SYNC_NORMAL, false) : SQLITE_OK;
+    int closed = file.real->pMethods->xClose(file.real);
+    file.~File();
+    return status != SQLITE_OK ? status : closed;
+  }
+
+  static int read(sqlite3_file* handle, void* buffer, int amount, sqlite3_int64 offset) {
+    File& file = self(handle);
+    if (!file.compressed) {
+      return file.real->pMethods->xRead(file.real, buffer, amount, offset);
+    }
+    int status = ensure(file);
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    uint64_t position = static_cast<uint64_t>(offset);
+    uint64_t end = std::min<uint64_t>(position + amount, file.size);
+    if (position < end) {
+      file.page.resize(file.block);
+    }
+    while (position < end) {
+      uint64_t block = position / file.block;
+      size_t within = position % file.block;
+      size_t length = std::min<uint64_t>(file.block - within, end - position);
+      uint8_t* target = (within == 0 && length == file.block) ? out : file.page.data();
+      status = fetch(file, block, target);
+      if (status != SQLITE_OK) {
+        return status;
+      }
+      if (target != out) {
+        std::memcpy(out, target + within, length);
+      }
+      out += length;
+      position += length;
+    }
+    uint64_t requested = static_cast<uint64_t>(offset) + amount;
+    if (position < requested) {
+      std::memset(out, 0, requested - std::max(position, static_cast<uint64_t>(offset)));
+      return SQLITE_IOERR_SHORT_READ;
+    }
+    return SQLITE_OK;
+  }
+
+  static int write(sqlite3_file* handle, const void* data, int amount, sqlite3_int64 offset) {
+    File& file = self(handle);
+    if (!file.compressed) {
+      return file.real->pMethods->xWrite(file.real, data, amount, offset);
+    }
+    int status = ensure(file);
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    if (!file.block) {
+      file.block = block_size(in, amount, offset);
+    }
+    file.page.resize(file.block);
+    uint64_t position = static_cast<uint64_t>(offset);
+    uint64_t end = position + static_cast<uint64_t>(amount);
+    while (position < end) {
+      uint64_t block = position / file.block;
+      size_t within = position % file.block;
+      size_t length = std::min<uint64_t>(file.block - within, end - position);
+      if (within == 0 && length == file.block) {
+        status = store(file, block, in);
+      } else {
+        status = position < file.size ? fetch(file, block, file.page.data()) : SQLITE_OK;
+        if (position >= file.size) {
+          std::memset(file.page.data(), 0, file.block);
+        }
+        if (status == SQLITE_OK) {
+          std::memcpy(file.page.data() + within, in, length);
+          status = store(file, block, file.page.data());
+        }
+      }
+      if (status != SQLITE_OK) {
+        return status;
+      }
+      in += length;
+      position += length;
+    }
+    file.size = std::max(file.size, end);
+    return SQLITE_OK;
+  }
+
+  static int truncate(sqlite3_file* handle, sqlite3_int64 size) {
+    File& file = self(handle);
+    if (!file.compressed) {
+      return file.real->pMethods->xTruncate(file.real, size);
+    }
+    int status = ensure(file);
+    if (status != SQLITE_OK || static_cast<uint64_t>(size) >= file.size) {
+      return status;
+    }
+    file.size = static_cast<uint64_t>(size);
+    file.dirty = true;
+    if (!file.block) {
+      return SQLITE_OK;
+    }
+    uint64_t blocks = (file.size + file.block - 1) / file.block;
+    for (uint64_t block = blocks; block < file.entries.size(); ++block) {
+      if (file.entries[block].kind != zero) {
+        release(file, file.entries[block].offset, file.entries[block].length);
+      }
+      auto found = file.cached.find(block);
+      if (found != file.cached.end()) {
+        file.lru.erase(found->second);
+        file.cached.erase(found);
+      }
+    }
+    file.entries.resize(std::min<uint64_t>(blocks, file.entries.size()));
+    size_t within = file.size % file.block;
+    if (within && blocks <= file.entries.size()) {
+      file.page.resize(file.block);
+      status = fetch(file, blocks - 1, file.page.data());
+      if (status == SQLITE_OK) {
+        std::memset(file.page.data() + within, 0, file.block - within);
+        status = store(file, blocks - 1, file.page.data());
+      }
+    }
+    return status;
+  }
+
+  static int sync(sqlite3_file* handle, int flags) {
+    File& file = self(handle);
+    if (!file.compressed) {
+      return file.real->pMethods->xSync(file.real, flags);
+    }
+    return file.dirty ? commit(file, flags, true) : file.real->pMethods->xSync(file.real, flags);
+  }
+
+  static int size(sqlite3_file* handle, sqlite3_int64* size) {
+    File& file = self(handle);
+    if (!file.compressed) {
+      return file.real->pMethods->xFileSize(file.real, size);
+    }
+    int status = ensure(file);
+    *size = static_cast<sqlite3_int64>(file.size);
+    return status;
+  }
+
+  static int lock(sqlite3_file* handle, int level) {
+    File& file = self(handle);
+    int status = file.real->pMethods->xLock(file.real, level);
+    if (status == SQLITE_OK && file.compressed && level == SQLITE_LOCK_SHARED && !file.dirty) {
+      status = load(file);
+    }
+    return status;
+  }
+
+  static int unlock(sqlite3_file* handle, int level) {
+    File& file = self(handle);
+    int status = file.compressed ? commit(file, SQLITE_SYNC_NORMAL, false) : SQLITE_OK;
+    int unlocked = file.real->pMethods->xUnlock(file.real, level);
+    return status != SQLITE_OK ? status : unlocked;
+  }
+
+  static int reserved(sqlite3_file* handle, int* result) {
+    File& file = self(handle);
+    return file.real->pMethods->xCheckReservedLock(file.real, result);
+  }
+
+  static int control(sqlite3_file* handle, int operation, void* argument) {
+    File& file = self(handle);
+    if (file.compressed && operation == SQLITE_FCNTL_SIZE_HINT) {
+      return SQLITE_OK;
+    }
+    if (file.compressed && operation == SQLITE_FCNTL_CKPT_DONE) {
+      int status = commit(file, SQLITE_SYNC_NORMAL, false);
+      if (status != SQLITE_OK) {
+        return status;
+      }
+    }
+    int status = file.real->pMethods->xFileControl(file.real, operation, argument);
+    if (operation == SQLITE_FCNTL_VFSNAME && status == SQLITE_OK) {
+      char** name = static_cast<char**>(argument);
+      *name = sqlite3_mprintf("%s/%z", SQLITECXX_COMPRESS_VFS, *name);
+    }
+    return status;
+  }
+
+  static int sector_size(sqlite3_file* handle) {
+    File& file = self(handle);
+    return file.real->pMethods->xSectorSize(file.real);
+  }
+
+  static int characteristics(sqlite3_file* handle) {
+    File& file = self(handle);
+    int flags = file.real->pMethods->xDeviceCharacteristics(file.real);
+    if (file.compressed) {
+      flags &= ~(SQLITE_IOCAP_ATOMIC | SQLITE_IOCAP_ATOMIC512 | SQLITE_IOCAP_ATOMIC1K |
+          SQLITE_IOCAP_ATOMIC2K | SQLITE_IOCAP_ATOMIC4K | SQLITE_IOCAP_ATOMIC8K |
+          SQLITE_IOCAP_ATOMIC16K | SQLITE_IOCAP_ATOMIC32K | SQLITE_IOCAP_ATOMIC64K |
+          SQLITE_IOCAP_BATCH_ATOMIC);
+    }
+    return flags;
+  }
+
+  static int shm_map(sqlite3_file* handle, int region, int size, int extend, void volatile** memory) {
+    File& file = self(handle);
+    return file.real->pMethods->xShmMap(file.real, region, size, extend, memory);
+  }
+
+  static int shm_lock(sqlite3_file* handle, int offset, int count, int flags) {
+    File& file = self(handle);
+    if (file.compressed && (flags & SQLITE_SHM_UNLOCK)) {
+      int status = commit(file, SQLITE_SYNC_NORMAL, false);
+      if (status != SQLITE_OK) {
+        return status;
+      }
+    }
+    int status = file.real->pMethods->xShmLock(file.real, offset, count, flags);
+    if (status == SQLITE_OK && file.compressed && !file.dirty &&
+        (flags & SQLITE_SHM_LOCK) && (flags & SQLITE_SHM_SHARED)) {
+      status = load(file);
+    }
+    return status;
+  }
+
+  static void shm_barrier(sqlite3_file* handle) {
+    File& file = self(handle);
+    file.real->pMethods->xShmBarrier(file.real);
+  }
+
+  static int shm_unmap(sqlite3_file* handle, int remove) {
+    File& file = self(handle);
+    return file.real->pMethods->xShmUnmap(file.real, remove);
+  }
+
+  static int fetch_map(sqlite3_file* handle, sqlite3_int64 offset, int amount, void** pointer) {
+    File& file = self(handle);
+    if (file.compressed) {
+      *pointer = nullptr;
+      return SQLITE_OK;
+    }
+    return file.real->pMethods->xFetch(file.real, offset, amount, pointer);
+  }
+
+  static int unfetch_map(sqlite3_file* handle, sqlite3_int64 offset, void* pointer) {
+    File& file = self(handle);
+    return file.compressed ? SQLITE_OK : file.real->pMethods->xUnfetch(file.real, offset, pointer);
+  }
+
+  static const sqlite3_io_methods* methods() {
+    static const sqlite3_io_methods io = [] {
+      sqlite3_io_methods io{};
+      io.iVersion = 3;
+      io.xClose = &close;
+      io.xRead = &read;
+      io.xWrite = &write;
+      io.xTruncate = &truncate;
+      io.xSync = &sync;
+      io.xFileSize = &size;
+      io.xLock = &lock;
+      io.xUnlock = &unlock;
+      io.xCheckReservedLock = &reserved;
+      io.xFileControl = &control;
+      io.xSectorSize = &sector_size;
+      io.xDeviceCharacteristics = &characteristics;
+      io.xShmMap = &shm_map;
+      io.xShmLock = &shm_lock;
+      io.xShmBarrier = &shm_barrier;
+      io.xShmUnmap = &shm_unmap;
+      io.xFetch = &fetch_map;
+      io.xUnfetch = &unfetch_map;
+      return io;
+    }();
+    return &io;
+  }
+
+  static int open(sqlite3_vfs*, const char* name, sqlite3_file* handle, int flags, int* out) {
+    File* file = new (handle) File{};
+    file->real = reinterpret_cast<sqlite3_file*>(reinterpret_cast<char*>(handle) + file_size());
+    int status = base_vfs->xOpen(base_vfs, name, file->real, flags, out);
+    if (status != SQLITE_OK || !file->real->pMethods) {
+      file->~File();
+      handle->pMethods = nullptr;
+      return status;
+    }
+    file->base.pMethods = methods();
+    file->compressed = flags & SQLITE_OPEN_MAIN_DB;
+    return SQLITE_OK;
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    CompressVfs() = delete;
+
+    /**
+     * @brief Register page-compressing VFS, databases are opened with it
+     *        by name (sqlite3_open_v2() or ?vfs= URI) unless it is default.
+     * @param compress options of VFS.
+     * @param make_default use VFS for connections opened without VFS name.
+     * @param base name of wrapped VFS (nullptr for current default).
+     * @return bool true when VFS is registered.
+     */
+    static bool install(CompressOptions compress = {}, bool make_default = false, const char* base = nullptr) {
+      static std::mutex mutex;
+      std::lock_guard<std::mutex> lock{mutex};
+      options = compress;
+      if (base_vfs) {
+        return sqlite3_vfs_register(&vfs, make_default) == SQLITE_OK;
+      }
+      sqlite3_vfs* wrapped = sqlite3_vfs_find(base);
+      if (!wrapped || wrapped == &vfs) {
+        return false;
+      }
+      base_vfs = wrapped;
+      vfs = *wrapped;
+      vfs.szOsFile = static_cast<int>(file_size()) + wrapped->szOsFile;
+      vfs.zName = SQLITECXX_COMPRESS_VFS;
+      vfs.pNext = nullptr;
+      vfs.pAppData = nullptr;
+      vfs.xOpen = &open;
+      return sqlite3_vfs_register(&vfs, make_default) == SQLITE_OK;
+    }
+
+    /**
+     * @brief Unregister page-compressing VFS, connections using it must
+     *        be closed.
+     */
+    static void uninstall() {
+      if (base_vfs) {
+        sqlite3_vfs_unregister(&vfs);
+      }
+    }
+
+    /**
+     * @brief Copy of VFS counters.
+     * @return CompressStats represent counters.
+     */
+    static CompressStats stats() {
+      return {counters[0], counters[1], counters[2], counters[3], counters[4], counters[5]};
+    }
+};
+
+inline sqlite3_vfs* CompressVfs::base_vfs{nullptr};
+inline sqlite3_vfs CompressVfs::vfs{};
+inline CompressOptions CompressVfs::options{};
+inline std::atomic<uint64_t> CompressVfs::counters[6]{};
+
+#endif
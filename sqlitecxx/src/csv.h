@@ -0,0 +1,768 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * csv.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CSV_H
+#define CSV_H
+
+#include <bit>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <string_view>
+#include <condition_variable>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include <sqlite3.h>
+#include "column.h"
+#include "datatypes.h"
+#include "mapped.h"
+#include "parallel.h"
+
+/**
+ * @brief Nominal size of one parsed range of file (bytes).
+ */
+#define SQLITECXX_CSV_RANGE (16u << 20)
+
+/**
+ * @brief Rows inserted per transaction by Csv::import().
+ */
+#define SQLITECXX_CSV_TRANSACTION 500000
+
+/**
+ * @brief Rows sampled to infer column types.
+ */
+#define SQLITECXX_CSV_SAMPLE 1000
+
+/**
+ * @brief CsvOptions. Dialect and parallelism of CSV/TSV import.
+ */
+struct CsvOptions {
+  char delimiter{','};                          /* '\t' for TSV */
+  char quote{'"'};                              /* 0 disables quoting */
+  bool header{true};                            /* first record names columns */
+  unsigned threads{0};                          /* parser threads, 0 for all cores */
+  size_t range{SQLITECXX_CSV_RANGE};            /* bytes per parsed range */
+  size_t transaction{SQLITECXX_CSV_TRANSACTION};/* rows per transaction */
+  size_t sample{SQLITECXX_CSV_SAMPLE};          /* rows sampled for types */
+};
+
+/**
+ * @brief CsvReport. Result of one import.
+ */
+struct CsvReport {
+  uint64_t rows{0};            /* imported records */
+  uint64_t bytes{0};           /* size of file */
+  uint64_t ranges{0};          /* ranges parsed in parallel */
+  uint64_t mismatched{0};      /* records with missing or extra fields */
+  uint64_t transactions{0};    /* committed transactions */
+  double seconds{0.0};         /* wall time */
+};
+
+/**
+ * @brief Csv. Parallel importer of memory-mapped CSV/TSV files. File is
+ *        split into ranges which end at newline outside of quotes (found
+ *        from parity of quote counts, so quoted fields may span lines),
+ *        ranges are parsed by worker threads with SIMD delimiter scanning
+ *        and consumed in file order by calling thread, either into table
+ *        through one prepared INSERT or into typed columns. Parsers run at
+ *        most two ranges per worker ahead of consumer, so memory is bounded
+ *        regardless of file size. Empty unquoted field is NULL.
+ */
+class Csv final {
+
+  /**
+   * @brief Parsed field, text points into mapping or unescaped copy.
+   */
+  struct Value {
+    int type{SQLITE_NULL};
+    union {
+      int64_t integer{0};
+      double real;
+    };
+    std::string_view text{};
+  };
+
+  /**
+   * @brief Parsed range, row major values.
+   */
+  struct Chunk {
+    std::vector<Value> values;
+    std::deque<std::string> unescaped;
+    size_t rows{0};
+    uint64_t mismatched{0};
+  };
+
+  /**
+   * @brief Columns of file and offset of first data record.
+   */
+  struct Layout {
+    std::vector<std::string> names;
+    std::vector<int> types;
+    size_t body{0};
+    size_t row_bytes{64};
+  };
+
+  /**
+   * @brief Finds delimiters and newlines, 64 byte blocks are turned into
+   *        bit masks of structural characters once and fields are popped
+   *        from mask.
+   */
+  class Scanner {
+
+    const char* end;
+    char delimiter;
+    const char* base{nullptr};
+    uint64_t mask{0};
+
+    void load(const char* position) {
+      this->base = position;
+      this->mask = 0;
+      size_t available = static_cast<size_t>(std::min<ptrdiff_t>(this->end - position, 64));
+#if defined(__AVX2__)
+      if (available == 64) {
+        const __m256i delimiters = _mm256_set1_epi8(this->delimiter);
+        const __m256i newlines = _mm256_set1_epi8('\n');
+        for (int offset = 0; offset < 64; offset += 32) {
+          __m256i block = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(position + offset)
+          );
+          uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+              _mm256_cmpeq_epi8(block, delimiters), _mm256_cmpeq_epi8(block, newlines)
+          )));
+          this->mask |= static_cast<uint64_t>(bits) << offset;
+        }
+        return;
+      }
+#elif defined(__SSE2__)
+      if (available == 64) {
+        const __m128i delimiters = _mm_set1_epi8(this->delimiter);
+        const __m128i newlines = _mm_set1_epi8('\n');
+        for (int offset = 0; offset < 64; offset += 16) {
+          __m128i block = _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(position + offset)
+          );
+          uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(
+              _mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, newlines)
+          )));
+          this->mask |= static_cast<uint64_t>(bits) << offset;
+        }
+        return;
+      }
+#endif
+      for (size_t index = 0; index < available; ++index) {
+        if (position[index] == this->delimiter || position[index] == '\n') {
+          this->mask |= uint64_t{1} << index;
+        }
+      }
+    }
+
+    public:
+      Scanner(const char* end, char delimiter) : end{end}, delimiter{delimiter} {}
+
+      /**
+       * @brief First delimiter or newline at or after position.
+       * @return const char* structural character or end.
+       */
+      const char* find(const char* position) {
+        if (!this->base || position < this->base || position >= this->base + 64) {
+          this->load(position);
+        }
+        for (;;) {
+          uint64_t bits = this->mask & (~uint64_t{0} << (position - this->base));
+          if (bits) {
+            return this->base + std::countr_zero(bits);
+          }
+          if (this->end - this->base <= 64) {
+            return this->end;
+          }
+          this->load(this->base + 64);
+          position = this->base;
+        }
+      }
+  };
+
+  /**
+   * @brief Split one record into fields.
+   * @param field callable(size_t column, std::string_view text, bool quoted).
+   * @return const char* first byte of next record.
+   */
+  template <class F>
+  static const char* record(
+      Scanner& scanner, const char* position, const char* end,
+      const CsvOptions& options, std::deque<std::string>& unescaped, F field
+  ) {
+    for (size_t column = 0;; ++column) {
+      std::string_view text;
+      bool quoted = options.quote && position < end && *position == options.quote;
+      if (quoted) {
+        const char* start = ++position;
+        const char* close = end;
+        bool escaped{false};
+        while (position < end) {
+          const char* found = static_cast<const char*>(
+              std::memchr(position, options.quote, end - position)
+          );
+          if (!found) {
+            position = end;
+          } else if (found + 1 < end && found[1] == options.quote) {
+            escaped = true;
+            position = found + 2;
+            continue;
+          } else {
+            close = found;
+            position = found + 1;
+          }
+          break;
+        }
+        text = std::string_view(start, close - start);
+        if (escaped) {
+          std::string& copy = unescaped.emplace_back();
+          copy.reserve(text.size());
+          for (size_t index = 0; index < text.size(); ++index) {
+            copy.push_back(text[index]);
+            index += text[index] == options.quote;
+          }
+          text = copy;
+        }
+        position = scanner.find(position);
+      } else {
+        const char* stop = scanner.find(position);
+        text = std::string_view(position, stop - position);
+        if (!text.empty() && text.back() == '\r') {
+          text.remove_suffix(1);
+        }
+        position = stop;
+      }
+      field(column, text, quoted);
+      if (position >= end) {
+        return end;
+      }
+      if (*position++ == '\n') {
+        return position;
+      }
+    }
+  }
+
+  static const char* skip_blank(const char* position, const char* end) {
+    while (position < end && (*position == '\n' ||
+        (*position == '\r' && position + 1 < end && position[1] == '\n'))) {
+      position += *position == '\r' ? 2 : 1;
+    }
+    return position;
+  }
+
+  static bool integer(std::string_view text, int64_t& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+  }
+
+  static bool real(std::string_view text, double& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+  }
+
+  /**
+   * @brief Convert field to value of column type, numeric column keeps
+   *        field which is not a number as text (like column affinity).
+   */
+  static Value convert(std::string_view text, int type, bool quoted) {
+    Value value;
+    value.text = text;
+    if (text.empty() && !quoted) {
+      return value;
+    }
+    if (type == SQLITE_INTEGER && integer(text, value.integer)) {
+      value.type = SQLITE_INTEGER;
+    } else if (type != SQLITE_TEXT && real(text, value.real)) {
+      value.type = SQLITE_FLOAT;
+    } else {
+      value.type = SQLITE_TEXT;
+    }
+    return value;
+  }
+
+  /**
+   * @brief Parse records of range [begin, end) into chunk.
+   */
+  static void parse(
+      const char* begin, const char* end, const Layout& layout,
+      const CsvOptions& options, Chunk& chunk
+  ) {
+    Scanner scanner{end, options.delimiter};
+    size_t columns = layout.types.size();
+    chunk.values.reserve(
+        (static_cast<size_t>(end - begin) / layout.row_bytes + 1) * columns
+    );
+    const char* position = skip_blank(begin, end);
+    while (position < end) {
+      size_t base = chunk.values.size();
+      size_t fields{0};
+      chunk.values.resize(base + columns);
+      position = record(
+          scanner, position, end, options, chunk.unescaped,
+          [&](size_t column, std::string_view text, bool quoted) {
+            if (column < columns) {
+              chunk.values[base + column] = convert(text, layout.types[column], quoted);
+            }
+            fields = column + 1;
+          }
+      );
+      chunk.mismatched += fields != columns;
+      ++(chunk.rows);
+      position = skip_blank(position, end);
+    }
+  }
+
+  /**
+   * @brief Read header and infer column types from sample of records,
+   *        column is INTEGER or REAL when all sampled fields are numbers.
+   */
+  static Layout detect(const MappedFile& file, const CsvOptions& options) {
+    Layout layout;
+    const char* data = file.get_data();
+    const char* end = data + file.get_size();
+    std::deque<std::string> unescaped;
+    Scanner scanner{end, options.delimiter};
+    const char* position = skip_blank(data, end);
+    if (position == end) {
+      throw std::invalid_argument("csv file is empty");
+    }
+    std::vector<std::string> first;
+    const char* body = record(
+        scanner, position, end, options, unescaped,
+        [&](size_t, std::string_view text, bool) {
+          first.emplace_back(text);
+        }
+    );
+    if (options.header) {
+      layout.names = std::move(first);
+      layout.body = static_cast<size_t>(body - data);
+    } else {
+      for (size_t column = 0; column < first.size(); ++column) {
+        layout.names.push_back("c" + std::to_string(column + 1));
+      }
+      layout.body = static_cast<size_t>(position - data);
+    }
+    size_t columns = layout.names.size();
+    layout.types.assign(columns, SQLITE_INTEGER);
+    std::vector<bool> seen(columns, false);
+    size_t rows{0};
+    position = skip_blank(data + layout.body, end);
+    const char* start = position;
+    while (position < end && rows < options.sample) {
+      position = record(
+          scanner, position, end, options, unescaped,
+          [&](size_t column, std::string_view text, bool quoted) {
+            if (column >= columns || (text.empty() && !quoted)) {
+              return;
+            }
+            int64_t integral;
+            double floating;
+            int& type = layout.types[column];
+            seen[column] = true;
+            if (type == SQLITE_INTEGER && !integer(text, integral)) {
+              type = SQLITE_FLOAT;
+            }
+            if (type == SQLITE_FLOAT && !real(text, floating)) {
+              type = SQLITE_TEXT;
+            }
+          }
+      );
+      ++rows;
+      position = skip_blank(position, end);
+    }
+    for (size_t column = 0; column < columns; ++column) {
+      if (!seen[column]) {
+        layout.types[column] = SQLITE_TEXT;
+      }
+    }
+    if (rows > 0) {
+      layout.row_bytes = std::max<size_t>(1, (position - start) / rows);
+    }
+    return layout;
+  }
+
+  /**
+   * @brief Split body into ranges ending after newline which is not
+   *        inside quotes, quotes of nominal ranges are counted in parallel
+   *        and their prefix parity tells quoting state at range start.
+   */
+  static std::vector<std::pair<size_t, size_t>> split(
+      const MappedFile& file, size_t begin, const CsvOptions& options, unsigned threads
+  ) {
+    const char* data = file.get_data();
+    size_t end = file.get_size();
+    size_t range = std::max<size_t>(options.range, 1);
+    size_t count = (end - begin + range - 1) / range;
+    std::vector<uint8_t> parity(count + 1, 0);
+    if (options.quote && count > 1) {
+      Parallel::for_each(count, Parallel::workers(threads, count), [&](unsigned, size_t item) {
+        const char* first = data + begin + item * range;
+        const char* last = data + std::min(end, begin + (item + 1) * range);
+        parity[item + 1] = std::count(first, last, options.quote) & 1;
+      });
+      for (size_t item = 1; item <= count; ++item) {
+        parity[item] ^= parity[item - 1];
+      }
+    }
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t start = begin;
+    for (size_t item = 1; item < count && start < end; ++item) {
+      size_t position = std::max(start, begin + item * range);
+      bool inside = position == begin + item * range && parity[item];
+      while (position < end) {
+        char character = data[position++];
+        if (character == options.quote && options.quote) {
+          inside = !inside;
+        } else if (character == '\n' && !inside) {
+          break;
+        }
+      }
+      if (position > start) {
+        ranges.emplace_back(start, position);
+        start = position;
+      }
+    }
+    if (start < end) {
+      ranges.emplace_back(start, end);
+    }
+    return ranges;
+  }
+
+  /**
+   * @brief Parse ranges on worker threads and hand chunks to consumer on
+   *        calling thread in file order.
+   * @param consume callable(Chunk&).
+   */
+  template <class C>
+  static CsvReport stream(
+      const MappedFile& file, const Layout& layout, const CsvOptions& options, C consume
+  ) {
+    auto started = std::chrono::steady_clock::now();
+    CsvReport report;
+    report.bytes = file.get_size();
+    auto ranges = split(file, layout.body, options, options.threads);
+    report.ranges = ranges.size();
+    unsigned workers = Parallel::workers(options.threads, ranges.size());
+    size_t window = static_cast<size_t>(workers) * 2;
+    std::vector<std::unique_ptr<Chunk>> chunks(ranges.size());
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable consumed;
+    size_t done{0};
+    bool stop{false};
+    std::exception_ptr error{};
+    std::atomic<size_t> next{0};
+    auto fail = [&](std::exception_ptr exception) {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (!error) {
+        error = exception;
+      }
+      stop = true;
+    };
+    auto work = [&]() {
+      for (size_t item = next++; item < ranges.size(); item = next++) {
+        {
+          std::unique_lock<std::mutex> lock{mutex};
+          consumed.wait(lock, [&] { return stop || item < done + window; });
+          if (stop) {
+            return;
+          }
+        }
+        auto chunk = std::make_unique<Chunk>();
+        try {
+          parse(
+              file.get_data() + ranges[item].first, file.get_data() + ranges[item].second,
+              layout, options, *chunk
+          );
+          std::lock_guard<std::mutex> lock{mutex};
+          chunks[item] = std::move(chunk);
+        } catch (...) {
+          fail(std::current_exception());
+        }
+        ready.notify_all();
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned worker = 0; worker < workers && !ranges.empty(); ++worker) {
+      threads.emplace_back(work);
+    }
+    try {
+      for (size_t item = 0; item < ranges.size(); ++item) {
+        std::unique_ptr<Chunk> chunk;
+        {
+          std::unique_lock<std::mutex> lock{mutex};
+          ready.wait(lock, [&] { return stop || chunks[item]; });
+          if (stop) {
+            break;
+          }
+          chunk = std::move(chunks[item]);
+        }
+        consume(*chunk);
+        report.rows += chunk->rows;
+        report.mismatched += chunk->mismatched;
+        chunk.reset();
+        {
+          std::lock_guard<std::mutex> lock{mutex};
+          ++done;
+        }
+        consumed.notify_all();
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      stop = true;
+    }
+    consumed.notify_all();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    report.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started
+    ).count();
+    return report;
+  }
+
+  static std::string identifier(const std::string& name) {
+    std::string quoted{"\""};
+    for (char character : name) {
+      quoted += character;
+      if (character == '"') {
+        quoted += '"';
+      }
+    }
+    return quoted + "\"";
+  }
+
+  static void check(sqlite3* db, int status, const char* what) {
+    if (status != SQLITE_OK && status != SQLITE_DONE) {
+      throw std::runtime_error(std::string(what) + " : " + sqlite3_errmsg(db));
+    }
+  }
+
+  static int affinity(const std::string& declared) {
+    std::string type{declared};
+    std::transform(type.begin(), type.end(), type.begin(), ::toupper);
+    if (type.find("INT") != std::string::npos) {
+      return SQLITE_INTEGER;
+    }
+    if (type.find("CHAR") != std::string::npos || type.find("CLOB") != std::string::npos ||
+        type.find("TEXT") != std::string::npos || type.find("BLOB") != std::string::npos ||
+        type.empty()) {
+      return SQLITE_TEXT;
+    }
+    return SQLITE_FLOAT;
+  }
+
+  /**
+   * @brief Declared types of existing table, empty when table is missing.
+   */
+  static std::vector<int> table_types(sqlite3* db, const std::string& table) {
+    std::vector<int> types;
+    sqlite3_stmt* statement{nullptr};
+    std::string sql = "PRAGMA table_info(" + identifier(table) + ")";
+    check(db, sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr), "table_info");
+    while (sqlite3_step(statement) == SQLITE_ROW) {
+      const unsigned char* declared = sqlite3_column_text(statement, 2);
+      types.push_back(affinity(declared ? reinterpret_cast<const char*>(declared) : ""));
+    }
+    sqlite3_finalize(statement);
+    return types;
+  }
+
+  static int bind(sqlite3_stmt* statement, int index, const Value& value) {
+    switch (value.type) {
+      case SQLITE_INTEGER:
+        return sqlite3_bind_int64(statement, index, value.integer);
+      case SQLITE_FLOAT:
+        return sqlite3_bind_double(statement, index, value.real);
+      case SQLITE_TEXT:
+        return sqlite3_bind_text64(
+            statement, index, value.text.data(), value.text.size(),
+            SQLITE_STATIC, SQLITE_UTF8
+        );
+      default:
+        return sqlite3_bind_null(statement, index);
+    }
+  }
+
+  template <class T>
+  static constexpr int column_type(const Integer<T>*) {
+    return SQLITE_INTEGER;
+  }
+
+  template <class T>
+  static constexpr int column_type(const Real<T>*) {
+    return SQLITE_FLOAT;
+  }
+
+  template <class T>
+  static constexpr int column_type(const Text<T>*) {
+    return SQLITE_TEXT;
+  }
+
+  template <class T>
+  static void append(Column<Integer<T>>& column, const Value& value) {
+    T payload{};
+    if (value.type == SQLITE_INTEGER) {
+      payload = static_cast<T>(value.integer);
+    } else if (value.type == SQLITE_FLOAT) {
+      payload = static_cast<T>(value.real);
+    }
+    column.get_data().push_back(Integer<T>{payload});
+  }
+
+  template <class T>
+  static void append(Column<Real<T>>& column, const Value& value) {
+    T payload{};
+    if (value.type == SQLITE_INTEGER) {
+      payload = static_cast<T>(value.integer);
+    } else if (value.type == SQLITE_FLOAT) {
+      payload = static_cast<T>(value.real);
+    }
+    column.get_data().push_back(Real<T>{payload});
+  }
+
+  template <class T>
+  static void append(Column<Text<T>>& column, const Value& value) {
+    column.get_data().push_back(Text<T>{T(value.text)});
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Csv() = delete;
+
+    /**
+     * @brief Import file into table through one prepared INSERT, table is
+     *        created from header and inferred types when it does not exist,
+     *        otherwise fields are converted to declared column affinities
+     *        and matched by position.
+     * @param db connection outside of transaction.
+     * @param path CSV/TSV file.
+     * @param table target table.
+     * @param options dialect and parallelism.
+     * @return CsvReport represent import statistics.
+     */
+    static CsvReport import(
+        sqlite3* db, const std::string& path, const std::string& table,
+        const CsvOptions& options = {}
+    ) {
+      MappedFile file{path};
+      Layout layout = detect(file, options);
+      std::vector<int> types = table_types(db, table);
+      if (types.empty()) {
+        std::string sql = "CREATE TABLE " + identifier(table) + "(";
+        for (size_t column = 0; column < layout.names.size(); ++column) {
+          sql += (column ? ", " : "") + identifier(layout.names[column]) + " " +
+              (layout.types[column] == SQLITE_INTEGER ? "INTEGER" :
+              layout.types[column] == SQLITE_FLOAT ? "REAL" : "TEXT");
+        }
+        check(db, sqlite3_exec(db, (sql + ")").c_str(), nullptr, nullptr, nullptr), "create");
+      } else {
+        layout.types = types;
+      }
+      std::string sql = "INSERT INTO " + identifier(table) + " VALUES(";
+      for (size_t column = 0; column < layout.types.size(); ++column) {
+        sql += column ? ",?" : "?";
+      }
+      sqlite3_stmt* statement{nullptr};
+      check(db, sqlite3_prepare_v3(
+          db, (sql + ")").c_str(), -1, SQLITE_PREPARE_PERSISTENT, &statement, nullptr
+      ), "prepare");
+      size_t pending{0};
+      uint64_t transactions{0};
+      try {
+        check(db, sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr), "begin");
+        CsvReport report = stream(file, layout, options, [&](Chunk& chunk) {
+          size_t columns = layout.types.size();
+          for (size_t row = 0; row < chunk.rows; ++row) {
+            const Value* values = chunk.values.data() + row * columns;
+            for (size_t column = 0; column < columns; ++column) {
+              check(db, bind(statement, static_cast<int>(column + 1), values[column]), "bind");
+            }
+            check(db, sqlite3_step(statement), "insert");
+            sqlite3_reset(statement);
+            if (++pending >= options.transaction) {
+              check(db, sqlite3_exec(db, "COMMIT; BEGIN", nullptr, nullptr, nullptr), "commit");
+              ++transactions;
+              pending = 0;
+            }
+          }
+        });
+        sqlite3_clear_bindings(statement);
+        check(db, sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr), "commit");
+        sqlite3_finalize(statement);
+        report.transactions = transactions + (pending > 0);
+        return report;
+      } catch (...) {
+        sqlite3_finalize(statement);
+        if (!sqlite3_get_autocommit(db)) {
+          sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+        throw;
+      }
+    }
+
+    /**
+     * @brief Read file into typed columns, fields are matched by position
+     *        and appended in file order, NULL or field which is not a
+     *        number becomes 0 in numeric column.
+     * @param path CSV/TSV file.
+     * @param options dialect and parallelism.
+     * @param columns Column<INTEGER> | Column<REAL> | Column<TEXT> targets.
+     * @return CsvReport represent import statistics.
+     */
+    template <class... T>
+    static CsvReport read(const std::string& path, const CsvOptions& options, Column<T>&... columns) {
+      MappedFile file{path};
+      Layout layout = detect(file, options);
+      layout.types = {column_type(static_cast<const T*>(nullptr))...};
+      return stream(file, layout, options, [&](Chunk& chunk) {
+        const Value* values = chunk.values.data();
+        for (size_t row = 0; row < chunk.rows; ++row, values += sizeof...(T)) {
+          size_t column{0};
+          (append(columns, values[column++]), ...);
+        }
+      });
+    }
+};
+
+#endif
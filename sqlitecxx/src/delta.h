@@ -0,0 +1,320 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * delta.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <bit>
+#include <vector>
+#include <algorithm>
+#include "column.h"
+#include "integer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Number of values in one frame of reference block.
+ */
+#define SQLITECXX_DELTA_BLOCK 128
+
+/**
+ * @brief DeltaInteger<T>. Frame of reference encoding of Integer<T>
+ *        columns, every block keeps base value, minimal delta and
+ *        deltas (minus minimal delta) bit-packed to the same width.
+ *        Decoding unpacks bit fields with scalar code, only prefix sum
+ *        uses SSE2.
+ * @tparam T - int8_t | int16_t | int32_t | int64_t | short | int | long.
+ */
+template <class T>
+class DeltaInteger final {
+
+  /**
+   * @brief Block header, offset is index of first packed word.
+   */
+  struct Block {
+    uint64_t base;
+    uint64_t min_delta;
+    size_t offset;
+    unsigned width;
+  };
+
+  std::vector<Block> blocks;
+  std::vector<uint64_t> words;
+  size_t count{0};
+
+  /**
+   * @brief Unpack LSB-first bit fields of equal width.
+   */
+  static void unpack(const uint64_t* packed, unsigned width, size_t length,
+      uint64_t* out) {
+    if (width == 0) {
+      std::fill(out, out + length, 0);
+      return;
+    }
+    uint64_t mask = (width == 64) ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+    for (size_t index = 0; index < length; ++index) {
+      size_t bit = index * width;
+      size_t word = bit >> 6;
+      unsigned shift = bit & 63;
+      uint64_t value = packed[word] >> shift;
+      if (shift + width > 64) {
+        value |= packed[word + 1] << (64 - shift);
+      }
+      out[index] = value & mask;
+    }
+  }
+
+  /**
+   * @brief Inclusive prefix sum of deltas starting from base.
+   */
+  static void prefix_sum(uint64_t* values, size_t length, uint64_t base) {
+    size_t index{0};
+#if defined(__SSE2__)
+    __m128i carry = _mm_set1_epi64x(static_cast<int64_t>(base));
+    for (; index + 2 <= length; index += 2) {
+      __m128i pair = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(values + index)
+      );
+      pair = _mm_add_epi64(pair, _mm_slli_si128(pair, 8));
+      pair = _mm_add_epi64(pair, carry);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(values + index), pair);
+      carry = _mm_shuffle_epi32(pair, 0xEE);
+    }
+    if (index > 0) {
+      base = values[index - 1];
+    }
+#endif
+    for (; index < length; ++index) {
+      base += values[index];
+      values[index] = base;
+    }
+  }
+
+  /**
+   * @brief Decode block into 64-bit values.
+   */
+  void decode_raw(size_t block, uint64_t* out) const {
+    const Block& header = this->blocks[block];
+    size_t length = this->block_length(block);
+    out[0] = 0;
+    unpack(this->words.data() + header.offset, header.width, length - 1, out + 1);
+    for (size_t index = 1; index < length; ++index) {
+      out[index] += header.min_delta;
+    }
+    prefix_sum(out, length, header.base);
+  }
+
+  public:
+    /**
+     * @brief Encode values, previous content is discarded.
+     * @param values pointer to first value.
+     * @param length number of values.
+     */
+    void encode(const T* values, size_t length) {
+      this->blocks.clear();
+      this->words.clear();
+      this->count = length;
+      uint64_t deltas[SQLITECXX_DELTA_BLOCK];
+      for (size_t first = 0; first < length; first += SQLITECXX_DELTA_BLOCK) {
+        size_t block_length = std::min<size_t>(
+            SQLITECXX_DELTA_BLOCK, length - first
+        );
+        Block header{};
+        header.base = static_cast<uint64_t>(static_cast<int64_t>(values[first]));
+        header.offset = this->words.size();
+        uint64_t previous = header.base;
+        int64_t min_delta{0};
+        for (size_t index = 1; index < block_length; ++index) {
+          uint64_t current = static_cast<uint64_t>(
+              static_cast<int64_t>(values[first + index])
+          );
+          deltas[index - 1] = current - previous;
+          previous = current;
+          int64_t delta = static_cast<int64_t>(deltas[index - 1]);
+          min_delta = (index == 1) ? delta : std::min(min_delta, delta);
+        }
+        header.min_delta = static_cast<uint64_t>(min_delta);
+        uint64_t widest{0};
+        for (size_t index = 0; index + 1 < block_length; ++index) {
+          deltas[index] -= header.min_delta;
+          widest |= deltas[index];
+        }
+        header.width = std::bit_width(widest);
+        size_t bits = header.width * (block_length - 1);
+        this->words.resize(header.offset + (bits + 63) / 64, 0);
+        uint64_t* packed = this->words.data() + header.offset;
+        for (size_t index = 0; header.width && index + 1 < block_length; ++index) {
+          size_t bit = index * header.width;
+          unsigned shift = bit & 63;
+          packed[bit >> 6] |= deltas[index] << shift;
+          if (shift + header.width > 64) {
+            packed[(bit >> 6) + 1] |= deltas[index] >> (64 - shift);
+          }
+        }
+        this->blocks.push_back(header);
+      }
+    }
+
+    /**
+     * @brief Encode all values of column (in list order).
+     * @param column reference to Column<Integer<T>> object.
+     */
+    void encode(Column<Integer<T>>& column) {
+      std::vector<T> values;
+      values.reserve(column.get_data().size());
+      for (const auto& integer : column.get_data()) {
+        values.push_back(integer.get());
+      }
+      this->encode(values.data(), values.size());
+    }
+
+    /**
+     * @brief Getter for number of encoded values.
+     * @return size_t number of values.
+     */
+    size_t size() const {
+      return this->count;
+    }
+
+    /**
+     * @brief Getter for number of blocks.
+     * @return size_t number of blocks.
+     */
+    size_t block_count() const {
+      return this->blocks.size();
+    }
+
+    /**
+     * @brief Getter for number of values in block.
+     * @param block index of block.
+     * @return size_t number of values in block.
+     */
+    size_t block_length(size_t block) const {
+      return std::min<size_t>(
+          SQLITECXX_DELTA_BLOCK, this->count - block * SQLITECXX_DELTA_BLOCK
+      );
+    }
+
+    /**
+     * @brief Getter for memory used by encoded data.
+     * @return size_t number of bytes.
+     */
+    size_t size_in_bytes() const {
+      return this->words.size() * sizeof(uint64_t) +
+          this->blocks.size() * sizeof(Block);
+    }
+
+    /**
+     * @brief Decode one block.
+     * @param block index of block.
+     * @param destination buffer for block_length(block) values.
+     */
+    void decode_block(size_t block, T* destination) const {
+      uint64_t values[SQLITECXX_DELTA_BLOCK];
+      this->decode_raw(block, values);
+      size_t length = this->block_length(block);
+      for (size_t index = 0; index < length; ++index) {
+        destination[index] = static_cast<T>(static_cast<int64_t>(values[index]));
+      }
+    }
+
+    /**
+     * @brief Decode all values.
+     * @param out destination vector.
+     */
+    void decode(std::vector<T>& out) const {
+      out.resize(this->count);
+      for (size_t block = 0; block < this->blocks.size(); ++block) {
+        this->decode_block(block, out.data() + block * SQLITECXX_DELTA_BLOCK);
+      }
+    }
+
+    /**
+     * @brief Decode all values and append them to column.
+     * @param column reference to Column<Integer<T>> object.
+     */
+    void decode(Column<Integer<T>>& column) const {
+      std::vector<T> values;
+      this->decode(values);
+      for (const T& value : values) {
+        column.get_data().push_back(Integer<T>{value});
+      }
+    }
+
+    /**
+     * @brief Random access to single value, only its block is touched.
+     * @param index position of value.
+     * @return T represent decoded value.
+     */
+    T at(size_t index) const {
+      size_t block = index / SQLITECXX_DELTA_BLOCK;
+      size_t position = index % SQLITECXX_DELTA_BLOCK;
+      const Block& header = this->blocks[block];
+      uint64_t deltas[SQLITECXX_DELTA_BLOCK];
+      unpack(this->words.data() + header.offset, header.width, position, deltas);
+      uint64_t value = header.base + header.min_delta * position;
+      for (size_t delta = 0; delta < position; ++delta) {
+        value += deltas[delta];
+      }
+      return static_cast<T>(static_cast<int64_t>(value));
+    }
+
+    /**
+     * @brief Position of first value not less than key, for columns
+     *        encoded in ascending order. Only last block with base less
+     *        than key is decoded, when all its values are less than key
+     *        result is first value of next block (duplicates of key may
+     *        cross block boundary).
+     * @param key searched value.
+     * @return size_t index of value or size() if there is none.
+     */
+    size_t lower_bound(T key) const {
+      auto block = std::lower_bound(
+          this->blocks.begin(), this->blocks.end(), static_cast<int64_t>(key),
+          [](const Block& header, int64_t value) {
+            return static_cast<int64_t>(header.base) < value;
+          }
+      );
+      if (block == this->blocks.begin()) {
+        return 0;
+      }
+      size_t index = static_cast<size_t>(block - this->blocks.begin()) - 1;
+      T values[SQLITECXX_DELTA_BLOCK];
+      this->decode_block(index, values);
+      size_t length = this->block_length(index);
+      size_t position = static_cast<size_t>(
+          std::lower_bound(values, values + length, key) - values
+      );
+      return index * SQLITECXX_DELTA_BLOCK + position;
+    }
+
+    /**
+     * @brief Check if key is present, for columns encoded in ascending order.
+     * @param key searched value.
+     * @return bool true if key is present else false.
+     */
+    bool contains(T key) const {
+      size_t index = this->lower_bound(key);
+      return index < this->count && this->at(index) == key;
+    }
+};
+
+#endif
@@ -0,0 +1,320 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * function.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUNCTION_H
+#define FUNCTION_H
+
+#include <new>
+#include <span>
+#include <tuple>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+#include <sqlite3.h>
+#include "datatypes.h"
+
+/**
+ * @brief Default flags of registered functions, result depends only on
+ *        arguments (constant folding, use in indexes and generated columns)
+ *        and function is safe in schema and triggers.
+ */
+#define SQLITECXX_FUNCTION_FLAGS (SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS)
+
+/**
+ * @brief Convert. Compile time conversion between sqlite3_value or
+ *        sqlite3_context and C++ types: sqlitecxx data types, arithmetic
+ *        types, std::string, std::string_view and std::span<const uint8_t>
+ *        (views of argument without copy, valid during call only) and
+ *        std::optional of them (NULL).
+ */
+class Convert final {
+
+  template <class T>
+  struct Tag {};
+
+  template <class T>
+  static Integer<T> from(Tag<Integer<T>>, sqlite3_value* value) {
+    return Integer<T>{static_cast<T>(sqlite3_value_int64(value))};
+  }
+
+  template <class T>
+  static Real<T> from(Tag<Real<T>>, sqlite3_value* value) {
+    return Real<T>{static_cast<T>(sqlite3_value_double(value))};
+  }
+
+  template <class T>
+  static Text<T> from(Tag<Text<T>>, sqlite3_value* value) {
+    return Text<T>{from(Tag<T>{}, value)};
+  }
+
+  template <class T>
+  static Blob<T> from(Tag<Blob<T>>, sqlite3_value* value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      T payload{};
+      const void* bytes = sqlite3_value_blob(value);
+      size_t size = static_cast<size_t>(sqlite3_value_bytes(value));
+      if (bytes) {
+        std::memcpy(&payload, bytes, std::min(size, sizeof(T)));
+      }
+      return Blob<T>{payload};
+    } else {
+      std::span<const uint8_t> bytes = from(Tag<std::span<const uint8_t>>{}, value);
+      return Blob<T>{T(bytes.begin(), bytes.end())};
+    }
+  }
+
+  template <class T>
+  static std::optional<T> from(Tag<std::optional<T>>, sqlite3_value* value) {
+    if (sqlite3_value_type(value) == SQLITE_NULL) {
+      return std::nullopt;
+    }
+    return from(Tag<T>{}, value);
+  }
+
+  static std::string_view from(Tag<std::string_view>, sqlite3_value* value) {
+    const unsigned char* text = sqlite3_value_text(value);
+    return text ? std::string_view{
+        reinterpret_cast<const char*>(text), static_cast<size_t>(sqlite3_value_bytes(value))
+    } : std::string_view{};
+  }
+
+  static std::string from(Tag<std::string>, sqlite3_value* value) {
+    return std::string{from(Tag<std::string_view>{}, value)};
+  }
+
+  static std::span<const uint8_t> from(Tag<std::span<const uint8_t>>, sqlite3_value* value) {
+    const void* bytes = sqlite3_value_blob(value);
+    return bytes ? std::span<const uint8_t>{
+        static_cast<const uint8_t*>(bytes), static_cast<size_t>(sqlite3_value_bytes(value))
+    } : std::span<const uint8_t>{};
+  }
+
+  template <class T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+  static T from(Tag<T>, sqlite3_value* value) {
+    if constexpr (std::is_floating_point_v<T>) {
+      return static_cast<T>(sqlite3_value_double(value));
+    } else if constexpr (std::is_same_v<T, bool>) {
+      return sqlite3_value_int64(value) != 0;
+    } else {
+      return static_cast<T>(sqlite3_value_int64(value));
+    }
+  }
+
+  template <class T>
+  static void text(sqlite3_context* context, const T& value) {
+    sqlite3_result_text64(
+        context, std::data(value), std::size(value), SQLITE_TRANSIENT, SQLITE_UTF8
+    );
+  }
+
+  template <class T>
+  static void blob(sqlite3_context* context, const T& value) {
+    sqlite3_result_blob64(
+        context, std::data(value), std::size(value) * sizeof(*std::data(value)), SQLITE_TRANSIENT
+    );
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Convert() = delete;
+
+    /**
+     * @brief Convert SQL value to C++ type T.
+     * @param value SQL value (argument of function).
+     * @return T represent converted value.
+     */
+    template <class T>
+    static T argument(sqlite3_value* value) {
+      return from(Tag<std::decay_t<T>>{}, value);
+    }
+
+    /**
+     * @brief Set SQL result of function to C++ value, text and blob are copied.
+     * @param context function context.
+     * @param value C++ value.
+     */
+    template <class T>
+    static void result(sqlite3_context* context, const T& value) {
+      if constexpr (std::is_same_v<T, bool>) {
+        sqlite3_result_int(context, value ? 1 : 0);
+      } else if constexpr (std::is_integral_v<T>) {
+        sqlite3_result_int64(context, static_cast<sqlite3_int64>(value));
+      } else if constexpr (std::is_floating_point_v<T>) {
+        sqlite3_result_double(context, static_cast<double>(value));
+      } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        text(context, std::string_view{value});
+      } else if constexpr (std::is_same_v<T, std::span<const uint8_t>>) {
+        blob(context, value);
+      } else {
+        static_assert(std::is_arithmetic_v<T>, "unsupported result type");
+      }
+    }
+
+    template <class T>
+    static void result(sqlite3_context* context, const Integer<T>& value) {
+      sqlite3_result_int64(context, static_cast<sqlite3_int64>(value.get()));
+    }
+
+    template <class T>
+    static void result(sqlite3_context* context, const Real<T>& value) {
+      sqlite3_result_double(context, static_cast<double>(value.get()));
+    }
+
+    template <class T>
+    static void result(sqlite3_context* context, const Text<T>& value) {
+      text(context, value.get());
+    }
+
+    template <class T>
+    static void result(sqlite3_context* context, const Blob<T>& value) {
+      if constexpr (std::is_arithmetic_v<T>) {
+        sqlite3_result_blob64(context, &value.get(), sizeof(T), SQLITE_TRANSIENT);
+      } else {
+        blob(context, value.get());
+      }
+    }
+
+    template <class T>
+    static void result(sqlite3_context* context, const std::optional<T>& value) {
+      if (value) {
+        result(context, *value);
+      } else {
+        sqlite3_result_null(context);
+      }
+    }
+
+    /**
+     * @brief Report exception thrown by C++ callable as SQL error.
+     * @param context function context.
+     */
+    static void error(sqlite3_context* context) {
+      try {
+        throw;
+      } catch (const std::bad_alloc&) {
+        sqlite3_result_error_nomem(context);
+      } catch (const std::exception& exception) {
+        sqlite3_result_error(context, exception.what(), -1);
+      } catch (...) {
+        sqlite3_result_error(context, "exception in sqlitecxx function", -1);
+      }
+    }
+};
+
+/**
+ * @brief Signature. Result and argument types of callable (function,
+ *        function pointer, lambda or other object with one operator()).
+ */
+template <class F>
+struct Signature : Signature<decltype(&F::operator())> {};
+
+template <class R, class... A>
+struct Signature<R(A...)> {
+  using result = R;
+  using arguments = std::tuple<std::decay_t<A>...>;
+  static constexpr int arity = static_cast<int>(sizeof...(A));
+};
+
+template <class R, class... A>
+struct Signature<R(*)(A...)> : Signature<R(A...)> {};
+
+template <class R, class... A>
+struct Signature<R(*)(A...) noexcept> : Signature<R(A...)> {};
+
+template <class C, class R, class... A>
+struct Signature<R(C::*)(A...)> : Signature<R(A...)> {};
+
+template <class C, class R, class... A>
+struct Signature<R(C::*)(A...) const> : Signature<R(A...)> {};
+
+template <class C, class R, class... A>
+struct Signature<R(C::*)(A...) noexcept> : Signature<R(A...)> {};
+
+template <class C, class R, class... A>
+struct Signature<R(C::*)(A...) const noexcept> : Signature<R(A...)> {};
+
+/**
+ * @brief Function. Registration of C++ callables as SQL scalar functions,
+ *        number of arguments and conversions are derived from signature.
+ *        Callable is owned by connection (destroyed when function is
+ *        replaced or connection is closed), exceptions become SQL errors.
+ */
+class Function final {
+
+  template <class F, size_t... I>
+  static void invoke(
+      F& callable, sqlite3_context* context, sqlite3_value** values, std::index_sequence<I...>
+  ) {
+    using Arguments = typename Signature<F>::arguments;
+    Convert::result(context, callable(
+        Convert::argument<std::tuple_element_t<I, Arguments>>(values[I])...
+    ));
+  }
+
+  template <class F>
+  static void call(sqlite3_context* context, int, sqlite3_value** values) {
+    F* callable = static_cast<F*>(sqlite3_user_data(context));
+    try {
+      invoke(*callable, context, values, std::make_index_sequence<Signature<F>::arity>{});
+    } catch (...) {
+      Convert::error(context);
+    }
+  }
+
+  template <class F>
+  static void destroy(void* callable) {
+    delete static_cast<F*>(callable);
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Function() = delete;
+
+    /**
+     * @brief Register callable as SQL scalar function.
+     * @param db connection.
+     * @param name SQL function name.
+     * @param callable function, function pointer or lambda.
+     * @param flags SQLITE_DETERMINISTIC, SQLITE_INNOCUOUS, SQLITE_DIRECTONLY.
+     * @return int SQLite status code.
+     */
+    template <class F>
+    static int create(
+        sqlite3* db, const std::string& name, F callable, int flags = SQLITECXX_FUNCTION_FLAGS
+    ) {
+      using Callable = std::decay_t<F>;
+      static_assert(!std::is_void_v<typename Signature<Callable>::result>,
+          "SQL function must return value");
+      return sqlite3_create_function_v2(
+          db, name.c_str(), Signature<Callable>::arity, SQLITE_UTF8 | flags,
+          new Callable(std::move(callable)), &call<Callable>, nullptr, nullptr,
+          &destroy<Callable>
+      );
+    }
+};
+
+#endif
@@ -0,0 +1,512 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * gorilla.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GORILLA_H
+#define GORILLA_H
+
+#include <bit>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "bitstream.h"
+#include "column.h"
+#include "integer.h"
+#include "real.h"
+
+/**
+ * @brief Default number of values in one independently decodable block.
+ */
+#define SQLITECXX_GORILLA_BLOCK 1024
+
+/**
+ * @brief GorillaBlocks. Word aligned blocks shared by Gorilla encodings,
+ *        every block starts with raw value so blocks decode independently.
+ */
+class GorillaBlocks {
+
+  protected:
+    /**
+     * @brief Number of values per block.
+     */
+    size_t block_size;
+
+    /**
+     * @brief Number of encoded values.
+     */
+    size_t count{0};
+
+    /**
+     * @brief Encoded bit stream.
+     */
+    BitWriter stream;
+
+    /**
+     * @brief Bit position of every block start.
+     */
+    std::vector<size_t> block_offsets;
+
+    /**
+     * @brief Start new block if current one is full.
+     * @return bool true if value is first in block else false.
+     */
+    bool next_value() {
+      if (this->count % this->block_size == 0) {
+        this->stream.align();
+        this->block_offsets.push_back(this->stream.size());
+        ++(this->count);
+        return true;
+      }
+      ++(this->count);
+      return false;
+    }
+
+    /**
+     * @brief Decode all blocks into out using decode_block per block.
+     * @param out destination with size() values.
+     * @param threads number of worker threads (0 for hardware default).
+     * @param decode_block callable(size_t block, V* destination).
+     */
+    template <class V, class F>
+    void decode_blocks(std::vector<V>& out, unsigned threads, F decode_block) const {
+      out.resize(this->count);
+      size_t blocks = this->block_offsets.size();
+      if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+      threads = static_cast<unsigned>(std::min<size_t>(threads, blocks));
+      if (threads <= 1) {
+        for (size_t block = 0; block < blocks; ++block) {
+          decode_block(block, out.data() + block * this->block_size);
+        }
+        return;
+      }
+      std::vector<std::thread> workers;
+      size_t per_thread = (blocks + threads - 1) / threads;
+      for (unsigned worker = 0; worker < threads; ++worker) {
+        size_t first = worker * per_thread;
+        size_t last = std::min(blocks, first + per_thread);
+        workers.emplace_back([&, first, last]() {
+          for (size_t block = first; block < last; ++block) {
+            decode_block(block, out.data() + block * this->block_size);
+          }
+        });
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    }
+
+  public:
+    /**
+     * @brief Construct a new GorillaBlocks object.
+     * @param block_size number of values per block.
+     */
+    explicit GorillaBlocks(size_t block_size)
+    : block_size{std::max<size_t>(block_size, 1)} {
+    }
+
+    /**
+     * @brief Getter for number of encoded values.
+     * @return size_t number of values.
+     */
+    size_t size() const {
+      return this->count;
+    }
+
+    /**
+     * @brief Getter for number of blocks.
+     * @return size_t number of blocks.
+     */
+    size_t block_count() const {
+      return this->block_offsets.size();
+    }
+
+    /**
+     * @brief Getter for number of values in block.
+     * @param block index of block.
+     * @return size_t number of values in block.
+     */
+    size_t block_length(size_t block) const {
+      return std::min(
+          this->block_size, this->count - block * this->block_size
+      );
+    }
+
+    /**
+     * @brief Getter for memory used by encoded stream.
+     * @return size_t number of bytes.
+     */
+    size_t size_in_bytes() const {
+      return this->stream.get_words().size() * sizeof(uint64_t) +
+          this->block_offsets.size() * sizeof(size_t);
+    }
+};
+
+/**
+ * @brief GorillaReal<T>. XOR encoding of Real<T> time series, neighbour
+ *        values are XOR-ed and only meaningful bits are stored.
+ * @tparam T - float | double.
+ */
+template <class T>
+class GorillaReal final : public GorillaBlocks {
+
+  uint64_t previous{0};
+  unsigned leading{0};
+  unsigned trailing{0};
+  bool window{false};
+
+  static uint64_t to_bits(T value) {
+    return std::bit_cast<uint64_t>(static_cast<double>(value));
+  }
+
+  static T from_bits(uint64_t bits) {
+    return static_cast<T>(std::bit_cast<double>(bits));
+  }
+
+  public:
+    /**
+     * @brief Construct a new GorillaReal<T> object.
+     * @param block_size number of values per block.
+     */
+    explicit GorillaReal(size_t block_size = SQLITECXX_GORILLA_BLOCK)
+    : GorillaBlocks(block_size) {
+    }
+
+    /**
+     * @brief Encode all values of column (in list order).
+     * @param column reference to Column<Real<T>> object.
+     */
+    void encode(Column<Real<T>>& column) {
+      for (const auto& real : column.get_data()) {
+        this->append(real.get());
+      }
+    }
+
+    /**
+     * @brief Append value to encoded stream.
+     * @param value floating data.
+     */
+    void append(T value) {
+      uint64_t bits = to_bits(value);
+      if (this->next_value()) {
+        this->stream.write(bits, 64);
+        this->previous = bits;
+        this->window = false;
+        return;
+      }
+      uint64_t delta = bits ^ this->previous;
+      this->previous = bits;
+      if (delta == 0) {
+        this->stream.write_bit(false);
+        return;
+      }
+      this->stream.write_bit(true);
+      unsigned lead = std::min(std::countl_zero(delta), 31);
+      unsigned trail = std::countr_zero(delta);
+      if (this->window && lead >= this->leading && trail >= this->trailing) {
+        this->stream.write_bit(false);
+        this->stream.write(
+            delta >> this->trailing, 64 - this->leading - this->trailing
+        );
+        return;
+      }
+      unsigned meaningful = 64 - lead - trail;
+      this->stream.write_bit(true);
+      this->stream.write(lead, 5);
+      this->stream.write(meaningful & 63, 6);
+      this->stream.write(delta >> trail, meaningful);
+      this->leading = lead;
+      this->trailing = trail;
+      this->window = true;
+    }
+
+    /**
+     * @brief Cursor. Streaming decoder over consecutive blocks.
+     */
+    class Cursor final {
+
+      const GorillaReal<T>& source;
+      size_t block;
+      size_t index{0};
+      BitReader reader;
+      uint64_t previous{0};
+      unsigned leading{0};
+      unsigned trailing{0};
+
+      public:
+        /**
+         * @brief Construct a new Cursor object.
+         * @param source reference to encoded data.
+         * @param block index of first block to decode.
+         */
+        explicit Cursor(const GorillaReal<T>& source, size_t block = 0)
+        : source{source}, block{block},
+          reader{source.stream.get_words().data(),
+              block < source.block_count() ? source.block_offsets[block] : 0} {
+        }
+
+        /**
+         * @brief Decode next value.
+         * @param value destination for decoded value.
+         * @return bool true if value is decoded, false at end of data.
+         */
+        bool next(T& value) {
+          if (this->block >= this->source.block_count()) {
+            return false;
+          }
+          if (this->index == 0) {
+            this->reader = BitReader(
+                this->source.stream.get_words().data(),
+                this->source.block_offsets[this->block]
+            );
+            this->previous = this->reader.read(64);
+          } else if (this->reader.read_bit()) {
+            if (this->reader.read_bit()) {
+              this->leading = this->reader.read(5);
+              unsigned meaningful = this->reader.read(6);
+              if (meaningful == 0) {
+                meaningful = 64;
+              }
+              this->trailing = 64 - this->leading - meaningful;
+            }
+            unsigned meaningful = 64 - this->leading - this->trailing;
+            this->previous ^= this->reader.read(meaningful) << this->trailing;
+          }
+          value = from_bits(this->previous);
+          if (++(this->index) == this->source.block_length(this->block)) {
+            this->index = 0;
+            ++(this->block);
+          }
+          return true;
+        }
+    };
+
+    /**
+     * @brief Decode one block.
+     * @param block index of block.
+     * @param destination buffer for block_length(block) values.
+     */
+    void decode_block(size_t block, T* destination) const {
+      Cursor cursor{*this, block};
+      size_t length = this->block_length(block);
+      for (size_t index = 0; index < length; ++index) {
+        cursor.next(destination[index]);
+      }
+    }
+
+    /**
+     * @brief Decode all values, blocks are decoded in parallel.
+     * @param out destination vector.
+     * @param threads number of worker threads (0 for hardware default).
+     */
+    void decode(std::vector<T>& out, unsigned threads = 0) const {
+      this->decode_blocks(out, threads, [this](size_t block, T* destination) {
+        this->decode_block(block, destination);
+      });
+    }
+
+    /**
+     * @brief Decode all values and append them to column.
+     * @param column reference to Column<Real<T>> object.
+     * @param threads number of worker threads (0 for hardware default).
+     */
+    void decode(Column<Real<T>>& column, unsigned threads = 0) const {
+      std::vector<T> values;
+      this->decode(values, threads);
+      for (const T& value : values) {
+        column.get_data().push_back(Real<T>{value});
+      }
+    }
+};
+
+/**
+ * @brief GorillaInteger<T>. Delta-of-delta encoding of Integer<T> time
+ *        stamps, regular intervals encode into a single bit per value.
+ * @tparam T - int8_t | int16_t | int32_t | int64_t | short | int | long.
+ */
+template <class T>
+class GorillaInteger final : public GorillaBlocks {
+
+  uint64_t previous{0};
+  uint64_t delta{0};
+
+  static uint64_t zigzag(uint64_t value) {
+    return (value << 1) ^ (0 - (value >> 63));
+  }
+
+  static uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+  }
+
+  public:
+    /**
+     * @brief Construct a new GorillaInteger<T> object.
+     * @param block_size number of values per block.
+     */
+    explicit GorillaInteger(size_t block_size = SQLITECXX_GORILLA_BLOCK)
+    : GorillaBlocks(block_size) {
+    }
+
+    /**
+     * @brief Encode all values of column (in list order).
+     * @param column reference to Column<Integer<T>> object.
+     */
+    void encode(Column<Integer<T>>& column) {
+      for (const auto& integer : column.get_data()) {
+        this->append(integer.get());
+      }
+    }
+
+    /**
+     * @brief Append value to encoded stream.
+     * @param value integral data.
+     */
+    void append(T value) {
+      uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+      if (this->next_value()) {
+        this->stream.write(bits, 64);
+        this->previous = bits;
+        this->delta = 0;
+        return;
+      }
+      uint64_t current = bits - this->previous;
+      uint64_t encoded = zigzag(current - this->delta);
+      this->previous = bits;
+      this->delta = current;
+      if (encoded == 0) {
+        this->stream.write_bit(false);
+      } else if (encoded < (uint64_t{1} << 7)) {
+        this->stream.write(0b10, 2);
+        this->stream.write(encoded, 7);
+      } else if (encoded < (uint64_t{1} << 9)) {
+        this->stream.write(0b110, 3);
+        this->stream.write(encoded, 9);
+      } else if (encoded < (uint64_t{1} << 12)) {
+        this->stream.write(0b1110, 4);
+        this->stream.write(encoded, 12);
+      } else {
+        this->stream.write(0b1111, 4);
+        this->stream.write(encoded, 64);
+      }
+    }
+
+    /**
+     * @brief Cursor. Streaming decoder over consecutive blocks.
+     */
+    class Cursor final {
+
+      const GorillaInteger<T>& source;
+      size_t block;
+      size_t index{0};
+      BitReader reader;
+      uint64_t previous{0};
+      uint64_t delta{0};
+
+      public:
+        /**
+         * @brief Construct a new Cursor object.
+         * @param source reference to encoded data.
+         * @param block index of first block to decode.
+         */
+        explicit Cursor(const GorillaInteger<T>& source, size_t block = 0)
+        : source{source}, block{block},
+          reader{source.stream.get_words().data(),
+              block < source.block_count() ? source.block_offsets[block] : 0} {
+        }
+
+        /**
+         * @brief Decode next value.
+         * @param value destination for decoded value.
+         * @return bool true if value is decoded, false at end of data.
+         */
+        bool next(T& value) {
+          if (this->block >= this->source.block_count()) {
+            return false;
+          }
+          if (this->index == 0) {
+            this->reader = BitReader(
+                this->source.stream.get_words().data(),
+                this->source.block_offsets[this->block]
+            );
+            this->previous = this->reader.read(64);
+            this->delta = 0;
+          } else {
+            unsigned width{0};
+            if (this->reader.read_bit()) {
+              if (!this->reader.read_bit()) {
+                width = 7;
+              } else if (!this->reader.read_bit()) {
+                width = 9;
+              } else if (!this->reader.read_bit()) {
+                width = 12;
+              } else {
+                width = 64;
+              }
+            }
+            this->delta += unzigzag(this->reader.read(width));
+            this->previous += this->delta;
+          }
+          value = static_cast<T>(static_cast<int64_t>(this->previous));
+          if (++(this->index) == this->source.block_length(this->block)) {
+            this->index = 0;
+            ++(this->block);
+          }
+          return true;
+        }
+    };
+
+    /**
+     * @brief Decode one block.
+     * @param block index of block.
+     * @param destination buffer for block_length(block) values.
+     */
+    void decode_block(size_t block, T* destination) const {
+      Cursor cursor{*this, block};
+      size_t length = this->block_length(block);
+      for (size_t index = 0; index < length; ++index) {
+        cursor.next(destination[index]);
+      }
+    }
+
+    /**
+     * @brief Decode all values, blocks are decoded in parallel.
+     * @param out destination vector.
+     * @param threads number of worker threads (0 for hardware default).
+     */
+    void decode(std::vector<T>& out, unsigned threads = 0) const {
+      this->decode_blocks(out, threads, [this](size_t block, T* destination) {
+        this->decode_block(block, destination);
+      });
+    }
+
+    /**
+     * @brief Decode all values and append them to column.
+     * @param column reference to Column<Integer<T>> object.
+     * @param threads number of worker threads (0 for hardware default).
+     */
+    void decode(Column<Integer<T>>& column, unsigned threads = 0) const {
+      std::vector<T> values;
+      this->decode(values, threads);
+      for (const T& value : values) {
+        column.get_data().push_back(Integer<T>{value});
+      }
+    }
+};
+
+#endif
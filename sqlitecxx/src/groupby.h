@@ -0,0 +1,435 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * groupby.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <tuple>
+#include <limits>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "column.h"
+#include "hash.h"
+#include "parallel.h"
+
+/**
+ * @brief Number of radix partitions used to merge thread-local groups.
+ */
+#define SQLITECXX_GROUPBY_PARTITIONS 64
+
+/**
+ * @brief Aggregate functions supported by GroupBy<K...>.
+ */
+enum class Aggregate {
+  count,
+  sum,
+  min,
+  max,
+  avg
+};
+
+/**
+ * @brief GroupByResult. Groups in order of first appearance, row is
+ *        index (in list order) of first row of group in key columns.
+ *        Integers hold exact count, sum, min and max of integral value
+ *        columns (empty for real value columns and avg), values hold
+ *        all results as double. An integral sum that overflows int64_t
+ *        continues as double, its integer result saturates at the
+ *        int64_t limit of its sign.
+ */
+struct GroupByResult {
+  std::vector<size_t> rows;
+  std::vector<uint64_t> counts;
+  std::vector<std::vector<double>> values;
+  std::vector<std::vector<int64_t>> integers;
+};
+
+/**
+ * @brief GroupBy<K...>. Hash group-by over one or more key columns, every
+ *        worker pre-aggregates its chunk of rows in a thread-local table
+ *        and partitions of local tables are merged in parallel.
+ * @tparam K - Integer<T> | Real<T> | Text<T> | Blob<T> key data types.
+ */
+template <class... K>
+class GroupBy final {
+
+  static constexpr uint32_t empty{std::numeric_limits<uint32_t>::max()};
+
+  /**
+   * @brief Running state of one aggregate for one group.
+   */
+  struct Accumulator {
+    uint64_t count{0};
+    int64_t integer_sum{0};
+    double real_sum{0.0};
+    bool overflow{false};
+    double min{std::numeric_limits<double>::infinity()};
+    double max{-std::numeric_limits<double>::infinity()};
+    int64_t integer_min{std::numeric_limits<int64_t>::max()};
+    int64_t integer_max{std::numeric_limits<int64_t>::min()};
+  };
+
+  /**
+   * @brief Value column, integral sums are kept exact until finalization.
+   */
+  struct Measure {
+    Aggregate aggregate;
+    bool integral;
+    std::vector<int64_t> integers;
+    std::vector<double> reals;
+  };
+
+  /**
+   * @brief Open addressing table of groups, parts lists groups of local
+   *        table by radix partition for merge.
+   */
+  struct Table {
+    std::vector<uint32_t> slots;
+    std::vector<std::vector<uint32_t>> parts;
+    std::vector<uint64_t> hashes;
+    std::vector<size_t> rows;
+    std::vector<uint64_t> counts;
+    std::vector<Accumulator> accumulators;
+
+    size_t size() const {
+      return this->hashes.size();
+    }
+  };
+
+  unsigned threads;
+  size_t row_count;
+  std::tuple<std::vector<const K*>...> keys;
+  std::vector<uint64_t> hashes;
+  std::vector<Measure> measures;
+
+  template <size_t... I>
+  bool equal(size_t first, size_t second, std::index_sequence<I...>) const {
+    return ((*std::get<I>(this->keys)[first] == *std::get<I>(this->keys)[second]) && ...);
+  }
+
+  bool equal(size_t first, size_t second) const {
+    return this->equal(first, second, std::index_sequence_for<K...>{});
+  }
+
+  template <class V>
+  static void collect(Column<V>& column, std::vector<const V*>& out) {
+    out.reserve(column.get_data().size());
+    for (const auto& value : column.get_data()) {
+      out.push_back(&value);
+    }
+  }
+
+  template <class C, size_t... I>
+  void collect_keys(C columns, std::index_sequence<I...>) {
+    (collect(std::get<I>(columns), std::get<I>(this->keys)), ...);
+    this->row_count = std::get<0>(this->keys).size();
+    if (!((std::get<I>(this->keys).size() == this->row_count) && ...)) {
+      throw std::invalid_argument("key columns differ in length");
+    }
+  }
+
+  static size_t partition(uint64_t hash) {
+    return static_cast<size_t>(hash >> 58) % SQLITECXX_GROUPBY_PARTITIONS;
+  }
+
+  /**
+   * @brief Find group with hash and key equal to row, insert if missing.
+   * @return size_t index of group in table.
+   */
+  size_t find_or_insert(Table& table, uint64_t hash, size_t row) const {
+    if ((table.size() + 1) * 2 > table.slots.size()) {
+      size_t capacity = std::max<size_t>(16, table.slots.size() * 2);
+      table.slots.assign(capacity, empty);
+      for (size_t group = 0; group < table.size(); ++group) {
+        size_t slot = table.hashes[group] & (capacity - 1);
+        while (table.slots[slot] != empty) {
+          slot = (slot + 1) & (capacity - 1);
+        }
+        table.slots[slot] = static_cast<uint32_t>(group);
+      }
+    }
+    size_t mask = table.slots.size() - 1;
+    size_t slot = hash & mask;
+    while (table.slots[slot] != empty) {
+      uint32_t group = table.slots[slot];
+      if (table.hashes[group] == hash && this->equal(table.rows[group], row)) {
+        return group;
+      }
+      slot = (slot + 1) & mask;
+    }
+    table.slots[slot] = static_cast<uint32_t>(table.size());
+    table.hashes.push_back(hash);
+    table.rows.push_back(row);
+    table.counts.push_back(0);
+    table.accumulators.resize(table.accumulators.size() + this->measures.size());
+    return table.size() - 1;
+  }
+
+  void update(Accumulator& accumulator, const Measure& measure, size_t row) const {
+    if (measure.integral) {
+      int64_t value = measure.integers[row];
+      int64_t integer_sum{0};
+      if (!accumulator.overflow &&
+          !__builtin_add_overflow(accumulator.integer_sum, value, &integer_sum)) {
+        accumulator.integer_sum = integer_sum;
+      } else {
+        accumulator.real_sum = sum(accumulator) + static_cast<double>(value);
+        accumulator.overflow = true;
+      }
+      accumulator.integer_min = std::min(accumulator.integer_min, value);
+      accumulator.integer_max = std::max(accumulator.integer_max, value);
+    } else {
+      double value = measure.reals[row];
+      accumulator.real_sum += value;
+      accumulator.min = std::min(accumulator.min, value);
+      accumulator.max = std::max(accumulator.max, value);
+    }
+    ++accumulator.count;
+  }
+
+  static void combine(Accumulator& into, const Accumulator& from) {
+    into.count += from.count;
+    int64_t integer_sum{0};
+    if (!into.overflow && !from.overflow &&
+        !__builtin_add_overflow(into.integer_sum, from.integer_sum, &integer_sum)) {
+      into.integer_sum = integer_sum;
+      into.real_sum += from.real_sum;
+    } else {
+      into.real_sum = sum(into) + sum(from);
+      into.overflow = true;
+    }
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+    into.integer_min = std::min(into.integer_min, from.integer_min);
+    into.integer_max = std::max(into.integer_max, from.integer_max);
+  }
+
+  /**
+   * @brief Sum of integral measure, double once int64_t overflowed.
+   */
+  static double sum(const Accumulator& accumulator) {
+    return accumulator.overflow ?
+        accumulator.real_sum : static_cast<double>(accumulator.integer_sum);
+  }
+
+  /**
+   * @brief Exact result of integral measure (not avg).
+   */
+  static int64_t finalize_integer(const Accumulator& accumulator, const Measure& measure) {
+    switch (measure.aggregate) {
+      case Aggregate::count:
+        return static_cast<int64_t>(accumulator.count);
+      case Aggregate::sum:
+        if (accumulator.overflow) {
+          return accumulator.real_sum < 0 ?
+              std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+        }
+        return accumulator.integer_sum;
+      case Aggregate::min:
+        return accumulator.integer_min;
+      case Aggregate::max:
+        return accumulator.integer_max;
+      default:
+        return 0;
+    }
+  }
+
+  static double finalize(const Accumulator& accumulator, const Measure& measure) {
+    double sum = measure.integral ? GroupBy::sum(accumulator) : accumulator.real_sum;
+    switch (measure.aggregate) {
+      case Aggregate::count:
+        return static_cast<double>(accumulator.count);
+      case Aggregate::sum:
+        return sum;
+      case Aggregate::min:
+        return measure.integral ? static_cast<double>(accumulator.integer_min) : accumulator.min;
+      case Aggregate::max:
+        return measure.integral ? static_cast<double>(accumulator.integer_max) : accumulator.max;
+      case Aggregate::avg:
+        return accumulator.count ? sum / accumulator.count : 0.0;
+    }
+    return 0.0;
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    GroupBy() = delete;
+
+    /**
+     * @brief Construct a new GroupBy<K...> object.
+     * @param key_columns references to key columns of equal length.
+     */
+    explicit GroupBy(Column<K>&... key_columns)
+    : threads{0}, row_count{0} {
+      this->collect_keys(
+          std::forward_as_tuple(key_columns...), std::index_sequence_for<K...>{}
+      );
+    }
+
+    /**
+     * @brief Setter for number of worker threads.
+     * @param threads number of worker threads (0 for hardware default).
+     * @return GroupBy<K...>& represent reference to GroupBy<K...>.
+     */
+    GroupBy<K...>& set_threads(unsigned threads) {
+      this->threads = threads;
+      return *this;
+    }
+
+    /**
+     * @brief Add aggregate over value column.
+     * @param aggregate count | sum | min | max | avg.
+     * @param column reference to Integer<T> or Real<T> value column.
+     * @return GroupBy<K...>& represent reference to GroupBy<K...>.
+     */
+    template <class V>
+    GroupBy<K...>& aggregate(Aggregate aggregate, Column<V>& column) {
+      if (column.get_data().size() != this->row_count) {
+        throw std::invalid_argument("value column differs in length");
+      }
+      using P = std::decay_t<decltype(column.get_data().front().get())>;
+      Measure measure{aggregate, std::is_integral_v<P>, {}, {}};
+      for (const auto& value : column.get_data()) {
+        if constexpr (std::is_integral_v<P>) {
+          measure.integers.push_back(static_cast<int64_t>(value.get()));
+        } else {
+          measure.reals.push_back(static_cast<double>(value.get()));
+        }
+      }
+      this->measures.push_back(std::move(measure));
+      return *this;
+    }
+
+    /**
+     * @brief Getter for key of row in key column I.
+     * @param row index of row (see GroupByResult::rows).
+     * @return const auto& represent key data type object.
+     */
+    template <size_t I>
+    const auto& key(size_t row) const {
+      return *std::get<I>(this->keys)[row];
+    }
+
+    /**
+     * @brief Run aggregation.
+     * @return GroupByResult represent aggregated groups.
+     */
+    GroupByResult run() {
+      size_t rows = this->row_count;
+      size_t measure_count = this->measures.size();
+      unsigned workers = Parallel::workers(this->threads, rows);
+
+      // Row hashes over all key columns.
+      this->hashes.assign(rows, 0);
+      Parallel::for_chunks(rows, workers, [&](unsigned, size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+          uint64_t hash{0};
+          std::apply([&](const auto&... columns) {
+            ((hash = Hash::combine(hash, Hash::value(*columns[row]))), ...);
+          }, this->keys);
+          this->hashes[row] = hash;
+        }
+      });
+
+      // Thread-local pre-aggregation over contiguous chunks.
+      std::vector<Table> locals(workers);
+      Parallel::for_chunks(rows, workers, [&](unsigned worker, size_t begin, size_t end) {
+        Table& table = locals[worker];
+        for (size_t row = begin; row < end; ++row) {
+          size_t group = this->find_or_insert(table, this->hashes[row], row);
+          ++table.counts[group];
+          for (size_t measure = 0; measure < measure_count; ++measure) {
+            this->update(
+                table.accumulators[group * measure_count + measure],
+                this->measures[measure], row
+            );
+          }
+        }
+        table.parts.assign(SQLITECXX_GROUPBY_PARTITIONS, {});
+        for (size_t group = 0; group < table.size(); ++group) {
+          table.parts[partition(table.hashes[group])].push_back(static_cast<uint32_t>(group));
+        }
+      });
+
+      // Merge thread-local tables, one radix partition per task touches
+      // only groups of its partition.
+      std::vector<Table> merged(SQLITECXX_GROUPBY_PARTITIONS);
+      Parallel::for_each(SQLITECXX_GROUPBY_PARTITIONS,
+          Parallel::workers(this->threads, SQLITECXX_GROUPBY_PARTITIONS),
+          [&](unsigned, size_t part) {
+            Table& table = merged[part];
+            for (const Table& local : locals) {
+              for (uint32_t group : local.parts[part]) {
+                size_t target = this->find_or_insert(
+                    table, local.hashes[group], local.rows[group]
+                );
+                table.rows[target] = std::min(table.rows[target], local.rows[group]);
+                table.counts[target] += local.counts[group];
+                for (size_t measure = 0; measure < measure_count; ++measure) {
+                  combine(
+                      table.accumulators[target * measure_count + measure],
+                      local.accumulators[group * measure_count + measure]
+                  );
+                }
+              }
+            }
+          });
+
+      // Order groups by first appearance.
+      std::vector<std::pair<size_t, size_t>> order;
+      for (size_t part = 0; part < merged.size(); ++part) {
+        for (size_t group = 0; group < merged[part].size(); ++group) {
+          order.emplace_back(part, group);
+        }
+      }
+      std::sort(order.begin(), order.end(), [&](const auto& first, const auto& second) {
+        return merged[first.first].rows[first.second] <
+            merged[second.first].rows[second.second];
+      });
+      GroupByResult result;
+      result.values.assign(measure_count, std::vector<double>(order.size()));
+      result.integers.resize(measure_count);
+      for (size_t measure = 0; measure < measure_count; ++measure) {
+        if (this->measures[measure].integral && this->measures[measure].aggregate != Aggregate::avg) {
+          result.integers[measure].resize(order.size());
+        }
+      }
+      for (size_t index = 0; index < order.size(); ++index) {
+        const Table& table = merged[order[index].first];
+        size_t group = order[index].second;
+        result.rows.push_back(table.rows[group]);
+        result.counts.push_back(table.counts[group]);
+        for (size_t measure = 0; measure < measure_count; ++measure) {
+          const Accumulator& accumulator = table.accumulators[group * measure_count + measure];
+          result.values[measure][index] = finalize(accumulator, this->measures[measure]);
+          if (!result.integers[measure].empty()) {
+            result.integers[measure][index] = finalize_integer(accumulator, this->measures[measure]);
+          }
+        }
+      }
+      return result;
+    }
+};
+
+#endif
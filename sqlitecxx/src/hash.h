@@ -0,0 +1,240 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * hash.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include "column.h"
+#include "datatypes.h"
+
+/**
+ * @brief Hash. Fast hashing of sqlitecxx values, wyhash for bytes and
+ *        its 128-bit multiply mix for integral data.
+ */
+class Hash final {
+
+  static constexpr uint64_t secret0{0xa0761d6478bd642full};
+  static constexpr uint64_t secret1{0xe7037ed1a0b428dbull};
+  static constexpr uint64_t secret2{0x8ebc6af09c88c6e3ull};
+  static constexpr uint64_t secret3{0x589965cc75374cc3ull};
+
+  static void multiply(uint64_t& low, uint64_t& high) {
+    __uint128_t product = static_cast<__uint128_t>(low) * high;
+    low = static_cast<uint64_t>(product);
+    high = static_cast<uint64_t>(product >> 64);
+  }
+
+  static uint64_t mix(uint64_t low, uint64_t high) {
+    multiply(low, high);
+    return low ^ high;
+  }
+
+  static uint64_t read8(const uint8_t* bytes) {
+    uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+
+  static uint64_t read4(const uint8_t* bytes) {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Hash() = delete;
+
+    /**
+     * @brief Hash raw bytes (wyhash).
+     * @param data pointer to first byte.
+     * @param length number of bytes.
+     * @param seed hash seed.
+     * @return uint64_t represent hash value.
+     */
+    static uint64_t bytes(const void* data, size_t length, uint64_t seed = 0) {
+      const uint8_t* bytes = static_cast<const uint8_t*>(data);
+      uint64_t first{0};
+      uint64_t second{0};
+      seed ^= mix(seed ^ secret0, secret1);
+      if (length <= 16) {
+        if (length >= 4) {
+          size_t middle = (length >> 3) << 2;
+          first = (read4(bytes) << 32) | read4(bytes + middle);
+          second = (read4(bytes + length - 4) << 32) |
+              read4(bytes + length - 4 - middle);
+        } else if (length > 0) {
+          first = (static_cast<uint64_t>(bytes[0]) << 16) |
+              (static_cast<uint64_t>(bytes[length >> 1]) << 8) |
+              bytes[length - 1];
+        }
+      } else {
+        size_t remaining = length;
+        if (remaining > 48) {
+          uint64_t lane1 = seed;
+          uint64_t lane2 = seed;
+          do {
+            seed = mix(read8(bytes) ^ secret1, read8(bytes + 8) ^ seed);
+            lane1 = mix(read8(bytes + 16) ^ secret2, read8(bytes + 24) ^ lane1);
+            lane2 = mix(read8(bytes + 32) ^ secret3, read8(bytes + 40) ^ lane2);
+            bytes += 48;
+            remaining -= 48;
+          } while (remaining > 48);
+          seed ^= lane1 ^ lane2;
+        }
+        while (remaining > 16) {
+          seed = mix(read8(bytes) ^ secret1, read8(bytes + 8) ^ seed);
+          bytes += 16;
+          remaining -= 16;
+        }
+        first = read8(bytes + remaining - 16);
+        second = read8(bytes + remaining - 8);
+      }
+      first ^= secret1;
+      second ^= seed;
+      multiply(first, second);
+      return mix(first ^ secret0 ^ length, second ^ secret1);
+    }
+
+    /**
+     * @brief Hash integral data (128-bit multiply with high and low half
+     *        folded, as wyhash), every input bit reaches both high and low
+     *        bits, so values with many trailing zero bits (multiples of
+     *        powers of two, doubles) still spread across buckets.
+     * @param value integral data.
+     * @return uint64_t represent hash value.
+     */
+    static uint64_t integer(uint64_t value) {
+      return mix(value ^ secret0, secret1);
+    }
+
+    /**
+     * @brief Hash floating data, -0.0 and 0.0 compare equal so they hash
+     *        to the same value. NaN never compares equal (not even to
+     *        itself), all NaN payloads are only folded to one hash so
+     *        they land in one bucket.
+     * @param value floating data.
+     * @return uint64_t represent hash value.
+     */
+    static uint64_t real(double value) {
+      if (value == 0.0) {
+        value = 0.0;
+      } else if (std::isnan(value)) {
+        value = std::numeric_limits<double>::quiet_NaN();
+      }
+      return integer(std::bit_cast<uint64_t>(value));
+    }
+
+    /**
+     * @brief Hash fundamental, floating or contiguous (string like) payload.
+     * @param payload value stored in sqlitecxx data type.
+     * @return uint64_t represent hash value.
+     */
+    template <class P>
+    static uint64_t payload(const P& payload) {
+      if constexpr (std::is_integral_v<P>) {
+        return integer(static_cast<uint64_t>(static_cast<int64_t>(payload)));
+      } else if constexpr (std::is_floating_point_v<P>) {
+        return real(payload);
+      } else {
+        return bytes(
+            std::data(payload),
+            std::size(payload) * sizeof(*std::data(payload))
+        );
+      }
+    }
+
+    /**
+     * @brief Hash sqlitecxx data type (Integer, Real, Text or Blob).
+     * @param value const reference to sqlitecxx data type object.
+     * @return uint64_t represent hash value.
+     */
+    template <class V>
+    static uint64_t value(const V& value) {
+      return payload(value.get());
+    }
+
+    /**
+     * @brief Batch hash of all values of column (in list order).
+     * @param column reference to Column<V> object.
+     * @param out destination, resized to number of values.
+     */
+    template <class V>
+    static void column(Column<V>& column, std::vector<uint64_t>& out) {
+      out.resize(column.get_data().size());
+      uint64_t* hash = out.data();
+      for (const auto& value : column.get_data()) {
+        *hash++ = Hash::value(value);
+      }
+    }
+
+    /**
+     * @brief Combine hash of next key column into running row hash.
+     * @param seed running row hash.
+     * @param hash hash of next key.
+     * @return uint64_t represent combined hash value.
+     */
+    static uint64_t combine(uint64_t seed, uint64_t hash) {
+      return mix(seed ^ secret2, hash ^ secret3);
+    }
+};
+
+/**
+ * @brief std::hash specializations, sqlitecxx data types can be used as
+ *        keys in unordered containers.
+ */
+template <class T>
+struct std::hash<Integer<T>> {
+  size_t operator()(const Integer<T>& value) const {
+    return Hash::value(value);
+  }
+};
+
+template <class T>
+struct std::hash<Real<T>> {
+  size_t operator()(const Real<T>& value) const {
+    return Hash::value(value);
+  }
+};
+
+template <class T>
+struct std::hash<Text<T>> {
+  size_t operator()(const Text<T>& value) const {
+    return Hash::value(value);
+  }
+};
+
+template <class T>
+struct std::hash<Blob<T>> {
+  size_t operator()(const Blob<T>& value) const {
+    return Hash::value(value);
+  }
+};
+
+#endif
@@ -0,0 +1,176 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * histogram.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <bit>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * @brief Sub-bucket bits, every power of two above 2^SUB_BITS is split
+ *        into 2^(SUB_BITS - 1) linear buckets, 6 bits (32 buckets) keep
+ *        reported bucket tops within 1/32 (~3.1%) of recorded values.
+ */
+#define SQLITECXX_HISTOGRAM_SUB_BITS 6
+
+/**
+ * @brief Highest power of two tracked, 2^40 ns is ~18 minutes.
+ */
+#define SQLITECXX_HISTOGRAM_MAX_BITS 40
+
+/**
+ * @brief Histogram. HDR style log-linear histogram of uint64_t values
+ *        (latencies in nanoseconds), fixed size and allocation free.
+ */
+class Histogram final {
+
+  static constexpr uint64_t sub_buckets{uint64_t{1} << SQLITECXX_HISTOGRAM_SUB_BITS};
+  static constexpr uint64_t half{sub_buckets / 2};
+  static constexpr size_t bucket_count{
+      sub_buckets + (SQLITECXX_HISTOGRAM_MAX_BITS - SQLITECXX_HISTOGRAM_SUB_BITS) * half
+  };
+
+  std::array<uint64_t, bucket_count> buckets{};
+  uint64_t count{0};
+  uint64_t sum{0};
+  uint64_t min{std::numeric_limits<uint64_t>::max()};
+  uint64_t max{0};
+
+  static size_t index(uint64_t value) {
+    if (value < sub_buckets) {
+      return static_cast<size_t>(value);
+    }
+    unsigned shift = std::bit_width(value) - SQLITECXX_HISTOGRAM_SUB_BITS;
+    size_t result = sub_buckets + (shift - 1) * half + ((value >> shift) - half);
+    return std::min(result, bucket_count - 1);
+  }
+
+  static uint64_t upper_bound(size_t index) {
+    if (index < sub_buckets) {
+      return index;
+    }
+    size_t shift = (index - sub_buckets) / half + 1;
+    uint64_t sub = (index - sub_buckets) % half + half;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  public:
+    /**
+     * @brief Record value.
+     * @param value recorded value (nanoseconds).
+     */
+    void record(uint64_t value) {
+      ++(this->buckets[index(value)]);
+      ++(this->count);
+      this->sum += value;
+      this->min = std::min(this->min, value);
+      this->max = std::max(this->max, value);
+    }
+
+    /**
+     * @brief Add all values of other histogram.
+     * @param other const reference to Histogram object.
+     */
+    void merge(const Histogram& other) {
+      for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        this->buckets[bucket] += other.buckets[bucket];
+      }
+      this->count += other.count;
+      this->sum += other.sum;
+      this->min = std::min(this->min, other.min);
+      this->max = std::max(this->max, other.max);
+    }
+
+    /**
+     * @brief Forget all recorded values.
+     */
+    void reset() {
+      *this = Histogram{};
+    }
+
+    /**
+     * @brief Value at percentile (upper bound of its bucket, clamped to
+     *        recorded min and max).
+     * @param percentile in range 0.0 - 100.0.
+     * @return uint64_t represent value at percentile.
+     */
+    uint64_t percentile(double percentile) const {
+      if (this->count == 0) {
+        return 0;
+      }
+      uint64_t rank = static_cast<uint64_t>(
+          std::clamp(percentile, 0.0, 100.0) / 100.0 * this->count + 0.5
+      );
+      rank = std::clamp<uint64_t>(rank, 1, this->count);
+      uint64_t seen{0};
+      for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        seen += this->buckets[bucket];
+        if (seen >= rank) {
+          return std::clamp(upper_bound(bucket), this->min, this->max);
+        }
+      }
+      return this->max;
+    }
+
+    /**
+     * @brief Getter for number of recorded values.
+     * @return uint64_t number of values.
+     */
+    uint64_t get_count() const {
+      return this->count;
+    }
+
+    /**
+     * @brief Getter for sum of recorded values.
+     * @return uint64_t sum of values.
+     */
+    uint64_t get_sum() const {
+      return this->sum;
+    }
+
+    /**
+     * @brief Getter for smallest recorded value.
+     * @return uint64_t minimum or 0 if empty.
+     */
+    uint64_t get_min() const {
+      return this->count ? this->min : 0;
+    }
+
+    /**
+     * @brief Getter for largest recorded value.
+     * @return uint64_t maximum.
+     */
+    uint64_t get_max() const {
+      return this->max;
+    }
+
+    /**
+     * @brief Getter for mean of recorded values.
+     * @return double mean or 0.0 if empty.
+     */
+    double get_mean() const {
+      return this->count ? static_cast<double>(this->sum) / this->count : 0.0;
+    }
+};
+
+#endif
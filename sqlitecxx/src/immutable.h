@@ -0,0 +1,231 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * immutable.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMMUTABLE_H
+#define IMMUTABLE_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <sys/stat.h>
+#include <sqlite3.h>
+#include "bind.h"
+
+/**
+ * @brief ImmutableOptions. Behaviour of immutable read-only connections.
+ */
+struct ImmutableOptions {
+  int64_t mmap_size{-1};       /* bytes mapped, -1 for whole file */
+};
+
+/**
+ * @brief Immutable. Read-only serving of database files which never
+ *        change (shipped artifacts): URI immutable=1 (no file locks, no
+ *        change detection, no journal or WAL lookups), SQLITE_OPEN_READONLY
+ *        | SQLITE_OPEN_NOMUTEX (no connection mutex, connection is used by
+ *        one thread at a time) and memory mapping of whole file, so pages
+ *        are read from shared page cache of kernel without read() calls.
+ *        File must not be modified while it is open.
+ */
+class Immutable final {
+
+  static std::string uri(const std::string& path) {
+    static const char digits[] = "0123456789abcdef";
+    std::string encoded{"file:"};
+    for (char character : path) {
+      if (character == '?' || character == '#' || character == '%') {
+        encoded += '%';
+        encoded += digits[static_cast<unsigned char>(character) >> 4];
+        encoded += digits[static_cast<unsigned char>(character) & 15];
+      } else {
+        encoded += character;
+      }
+    }
+    return encoded + "?immutable=1";
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Immutable() = delete;
+
+    /**
+     * @brief Open immutable read-only connection.
+     * @param path database file.
+     * @param db destination of connection handle (close with sqlite3_close()).
+     * @param options mmap size.
+     * @return int SQLite status code.
+     */
+    static int open(const std::string& path, sqlite3** db, ImmutableOptions options = {}) {
+      int status = sqlite3_open_v2(
+          uri(path).c_str(), db,
+          SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_URI, nullptr
+      );
+      if (status != SQLITE_OK) {
+        return status;
+      }
+      int64_t size = options.mmap_size;
+      if (size < 0) {
+        struct stat info;
+        size = ::stat(path.c_str(), &info) == 0 ? static_cast<int64_t>(info.st_size) : 0;
+      }
+      std::string pragma = "PRAGMA mmap_size = " + std::to_string(size);
+      return sqlite3_exec(*db, pragma.c_str(), nullptr, nullptr, nullptr);
+    }
+};
+
+/**
+ * @brief ImmutablePool. Statements shared by threads over immutable
+ *        database: statements are given once, every thread gets own
+ *        immutable connection with all statements prepared on first use
+ *        (sqlite3_stmt can't be stepped by two threads at once), later
+ *        calls of same thread take no locks. Connections live as long
+ *        as pool, one per thread which used it.
+ */
+class ImmutablePool final {
+
+  struct Reader {
+    sqlite3* db{nullptr};
+    std::vector<sqlite3_stmt*> statements;
+
+    ~Reader() {
+      for (sqlite3_stmt* statement : this->statements) {
+        sqlite3_finalize(statement);
+      }
+      sqlite3_close(this->db);
+    }
+  };
+
+  std::string path;
+  std::vector<std::string> sql;
+  ImmutableOptions options;
+  uint64_t id;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Reader>> readers;
+
+  static uint64_t next_id() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+
+  /**
+   * @brief Reader of calling thread, pool id is never reused so entries
+   *        of destroyed pools are never matched.
+   */
+  Reader* reader() {
+    static thread_local std::unordered_map<uint64_t, Reader*> local;
+    auto found = local.find(this->id);
+    if (found != local.end()) {
+      return found->second;
+    }
+    auto created = std::make_unique<Reader>();
+    if (Immutable::open(this->path, &created->db, this->options) != SQLITE_OK) {
+      return nullptr;
+    }
+    for (const auto& text : this->sql) {
+      sqlite3_stmt* statement{nullptr};
+      if (sqlite3_prepare_v3(created->db, text.c_str(), -1, SQLITE_PREPARE_PERSISTENT,
+          &statement, nullptr) != SQLITE_OK) {
+        return nullptr;
+      }
+      created->statements.push_back(statement);
+    }
+    Reader* result = created.get();
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->readers.push_back(std::move(created));
+    }
+    local.emplace(this->id, result);
+    return result;
+  }
+
+  public:
+    /**
+     * @brief Construct a new ImmutablePool object.
+     * @param path database file.
+     * @param statements SQL of statements, index in vector is statement id.
+     * @param options mmap size.
+     */
+    ImmutablePool(std::string path, std::vector<std::string> statements, ImmutableOptions options = {})
+    : path{std::move(path)}, sql{std::move(statements)}, options{options}, id{next_id()} {}
+
+    ImmutablePool(const ImmutablePool&) = delete;
+    ImmutablePool& operator=(const ImmutablePool&) = delete;
+
+    /**
+     * @brief Prepared statement of calling thread, reset and without
+     *        bindings, valid in calling thread only.
+     * @param index statement id.
+     * @return sqlite3_stmt* represent statement (nullptr when database
+     *         can't be opened or SQL can't be prepared).
+     */
+    sqlite3_stmt* statement(size_t index) {
+      Reader* current = this->reader();
+      if (!current || index >= current->statements.size()) {
+        return nullptr;
+      }
+      sqlite3_stmt* statement = current->statements[index];
+      sqlite3_reset(statement);
+      sqlite3_clear_bindings(statement);
+      return statement;
+    }
+
+    /**
+     * @brief Run statement in calling thread.
+     * @param index statement id.
+     * @param row callable(sqlite3_stmt*) called for every row.
+     * @param values sqlitecxx data types bound to parameters 1..N.
+     * @return int SQLite status code.
+     */
+    template <class F, class... V>
+    int query(size_t index, F row, const V&... values) {
+      sqlite3_stmt* statement = this->statement(index);
+      if (!statement) {
+        return SQLITE_ERROR;
+      }
+      if constexpr (sizeof...(V) > 0) {
+        int status = Bind::row(statement, values...);
+        if (status != SQLITE_OK) {
+          return status;
+        }
+      }
+      int status{SQLITE_ROW};
+      while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+        row(statement);
+      }
+      sqlite3_reset(statement);
+      return status == SQLITE_DONE ? SQLITE_OK : status;
+    }
+
+    /**
+     * @brief Getter for number of connections (threads which used pool).
+     * @return size_t represent number of connections.
+     */
+    size_t get_readers() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      return this->readers.size();
+    }
+};
+
+#endif
@@ -20,11 +20,11 @@
 #ifndef INTEGER_H
 #define INTEGER_H
 
+#include <string>
 #include <cstdint>
+#include <ostream>
 #include <base.h>
 
-#define SQLITECXX_INTEGER "sqlitecxx::integer::"
-
 /**
  * @brief Integer<T>. Signed integer, stored in: 1, 2, 3, 4, 6, or 8 bytes
  *        depending on the magnitude of the value.
@@ -44,10 +44,7 @@ class Integer final : Base<T> {
      * @param payload value for integral data.
      */
     explicit Integer(T payload) : Base<T>(payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " user defined cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, constructor, this, payload);
     }
 
     /**
@@ -55,10 +52,7 @@ class Integer final : Base<T> {
      * @param source reference to Integer <T> object for copy. 
      */
     Integer(Integer<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " Integer<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, copy_constructor, this);
     }
 
     /**
@@ -66,20 +60,14 @@ class Integer final : Base<T> {
      * @param source const reference to Integer<T> object for copy. 
      */
     Integer(const Integer<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " const Integer<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, copy_constructor, this);
     }
 
     /**
      * @brief Destructor for Integer<T> object.
      */
     ~Integer() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " default dstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, destructor, this);
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -96,6 +84,11 @@ class Integer final : Base<T> {
       return "Integer";
     }
 
+    /**
+     * @brief Getters for payload of Integer<T> integral data.
+     */
+    using Base<T>::get;
+
     ///////////////////////////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////
     // Assignment operators
@@ -107,11 +100,7 @@ class Integer final : Base<T> {
      * @param payload payload for integral data.
      */
     void operator=(T payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " integral";
-      std::cout << " arg : " << payload;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, assign, this, payload);
       this->payload = payload;
     }
 
@@ -120,12 +109,7 @@ class Integer final : Base<T> {
      * @param source reference to Integer<T> object.
      */
     void operator=(Integer<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " Integer<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -134,12 +118,7 @@ class Integer final : Base<T> {
      * @param source const reference to Integer<T> object.
      */
     void operator=(const Integer<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " const Integer<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -154,10 +133,7 @@ class Integer final : Base<T> {
      * @return Integer<T> & represent reference to Integer<T>.
      */
     Integer<T>& operator++() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " prefix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, pre_increment, this);
       ++(this->payload);
       return *this;
     }
@@ -167,10 +143,7 @@ class Integer final : Base<T> {
      * @return Integer<T> & represent reference to Integer<T>.
      */
     Integer<T>& operator--() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " prefix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, pre_decrement, this);
       --(this->payload);
       return *this;
     }
@@ -186,10 +159,7 @@ class Integer final : Base<T> {
      * @return Integer<T> represent dummy Integer<T> object with old value.
      */
     Integer<T> operator++(int) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " postfix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, post_increment, this);
       Integer<T> temp{*this};
       ++*this; /* Invoke prefix operator */
       return temp;
@@ -200,10 +170,7 @@ class Integer final : Base<T> {
      * @return Integer<T> represent dummy Integer<T> object with old value.
      */
     Integer<T> operator--(int) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__ << " postfix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, post_decrement, this);
       Integer<T> temp{*this};
       --*this; /* Invoke prefix operator */
       return temp;
@@ -221,10 +188,7 @@ class Integer final : Base<T> {
      * @return Integer<T> represent result Integer<T> object.
      */
     Integer<T> operator+(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, add, this);
       Integer<T> temp{0};
       temp.payload = (
           (this->payload) + (other.payload)
@@ -238,10 +202,7 @@ class Integer final : Base<T> {
      * @return Integer<T> represent result Integer<T> object.
      */
     Integer<T> operator-(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, subtract, this);
       Integer<T> temp{0};
       temp.payload = (
           (this->payload) - (other.payload)
@@ -255,10 +216,7 @@ class Integer final : Base<T> {
      * @return Integer<T> represent result Integer<T> object.
      */
     Integer<T> operator*(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, multiply, this);
       Integer<T> temp{0};
       temp.payload = (
           (this->payload) * (other.payload)
@@ -272,10 +230,7 @@ class Integer final : Base<T> {
      * @return Integer<T> represent result Integer<T> object.
      */
     Integer<T> operator/(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(integer, divide, this);
       Integer<T> temp{0};
       temp.payload = (
           (this->payload) / (other.payload)
@@ -288,11 +243,8 @@ class Integer final : Base<T> {
      * @param source const reference to right operand Integer<T> object.
      * @return bool true for not equal else false.
      */
-    bool operator!=(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator!=(const Integer<T>& other) const {
+      SQLITECXX_TRACE(integer, not_equal, this);
       return (this->payload) != (other.payload);
     }
 
@@ -301,11 +253,8 @@ class Integer final : Base<T> {
      * @param source const reference to right operand Integer<T> object.
      * @return bool true for equal else false.
      */
-    bool operator==(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator==(const Integer<T>& other) const {
+      SQLITECXX_TRACE(integer, equal, this);
       return (this->payload) == (other.payload);
     }
 
@@ -314,11 +263,8 @@ class Integer final : Base<T> {
      * @param source const reference to right operand Integer<T> object.
      * @return bool true for greater or equal else false.
      */
-    bool operator>=(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>=(const Integer<T>& other) const {
+      SQLITECXX_TRACE(integer, greater_equal, this);
       return (this->payload) >= (other.payload);
     }
 
@@ -327,11 +273,8 @@ class Integer final : Base<T> {
      * @param source const reference to right operand Integer<T> object.
      * @return bool true for less or equal else false.
      */
-    bool operator<=(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<=(const Integer<T>& other) const {
+      SQLITECXX_TRACE(integer, less_equal, this);
       return (this->payload) <= (other.payload);
     }
 
@@ -340,11 +283,8 @@ class Integer final : Base<T> {
      * @param source const reference to right operand Integer<T> object.
      * @return bool true for greater else false.
      */
-    bool operator>(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>(const Integer<T>& other) const {
+      SQLITECXX_TRACE(integer, greater, this);
       return (this->payload) > (other.payload);
     }
 
@@ -353,11 +293,8 @@ class Integer final : Base<T> {
      * @param source const reference to right operand Integer<T> object.
      * @return bool true for less else false.
      */
-    bool operator<(const Integer<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_INTEGER << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<(const Integer<T>& other) const {
+      SQLITECXX_TRACE(integer, less, this);
       return (this->payload) < (other.payload);
     }
 
@@ -0,0 +1,272 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * join.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOIN_H
+#define JOIN_H
+
+#include <bit>
+#include <limits>
+#include <vector>
+#include "column.h"
+#include "hash.h"
+#include "parallel.h"
+
+/**
+ * @brief Target number of build rows per partition, keeps partition
+ *        hash table within L2 cache.
+ */
+#define SQLITECXX_JOIN_PARTITION_ROWS 4096
+
+/**
+ * @brief Maximal number of radix bits used for partitioning.
+ */
+#define SQLITECXX_JOIN_MAX_RADIX_BITS 10
+
+/**
+ * @brief Join types supported by HashJoin<T>.
+ */
+enum class JoinType {
+  inner, /* matching pairs only */
+  left,  /* every probe row, unmatched with JoinMatch::none */
+  semi   /* probe rows with at least one match, once */
+};
+
+/**
+ * @brief JoinMatch. Pair of matched row indices (positions in list order).
+ */
+struct JoinMatch {
+  /**
+   * @brief Row index for missing right side of left join.
+   */
+  static constexpr size_t none{std::numeric_limits<size_t>::max()};
+
+  size_t left;
+  size_t right;
+
+  bool operator==(const JoinMatch& other) const = default;
+};
+
+/**
+ * @brief HashJoin<T>. In-memory hash join between two Column<T> objects,
+ *        right (build) side is radix partitioned by hash into cache sized
+ *        tables, left (probe) side is probed in parallel.
+ * @tparam T - Integer<T> | Real<T> | Text<T> | Blob<T>.
+ */
+template <class T>
+class HashJoin final {
+
+  /**
+   * @brief Build side entry, key points into column storage (no copy).
+   */
+  struct Entry {
+    uint64_t hash;
+    size_t row;
+    const T* key;
+  };
+
+  static constexpr uint32_t empty{std::numeric_limits<uint32_t>::max()};
+
+  unsigned threads;
+  unsigned radix_bits{0};
+  std::vector<Entry> entries;
+  std::vector<size_t> partition_offsets;
+  std::vector<uint32_t> buckets;
+  std::vector<size_t> bucket_offsets;
+  std::vector<uint64_t> bucket_masks;
+  std::vector<uint32_t> next;
+
+  size_t partition(uint64_t hash) const {
+    return this->radix_bits ? static_cast<size_t>(hash >> (64 - this->radix_bits)) : 0;
+  }
+
+  /**
+   * @brief Collect key pointers and hashes of column in parallel.
+   */
+  void collect(Column<T>& column, std::vector<const T*>& keys,
+      std::vector<uint64_t>& hashes) const {
+    keys.clear();
+    keys.reserve(column.get_data().size());
+    for (const auto& key : column.get_data()) {
+      keys.push_back(&key);
+    }
+    hashes.resize(keys.size());
+    Parallel::for_chunks(keys.size(), Parallel::workers(this->threads, keys.size()),
+        [&](unsigned, size_t begin, size_t end) {
+          for (size_t row = begin; row < end; ++row) {
+            hashes[row] = Hash::value(*keys[row]);
+          }
+        });
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    HashJoin() = delete;
+
+    /**
+     * @brief Construct a new HashJoin<T> object and build hash table.
+     * @param build reference to right (build) side key column.
+     * @param threads number of worker threads (0 for hardware default).
+     */
+    explicit HashJoin(Column<T>& build, unsigned threads = 0)
+    : threads{threads} {
+      std::vector<const T*> keys;
+      std::vector<uint64_t> hashes;
+      this->collect(build, keys, hashes);
+      size_t rows = keys.size();
+      size_t wanted = rows / SQLITECXX_JOIN_PARTITION_ROWS;
+      this->radix_bits = std::min<unsigned>(
+          SQLITECXX_JOIN_MAX_RADIX_BITS, wanted ? std::bit_width(wanted) : 0
+      );
+      size_t partitions = size_t{1} << this->radix_bits;
+
+      // Pass 1: per worker histograms of partition sizes.
+      unsigned workers = Parallel::workers(threads, rows);
+      std::vector<std::vector<size_t>> histograms(
+          workers, std::vector<size_t>(partitions, 0)
+      );
+      Parallel::for_chunks(rows, workers,
+          [&](unsigned worker, size_t begin, size_t end) {
+            for (size_t row = begin; row < end; ++row) {
+              ++histograms[worker][this->partition(hashes[row])];
+            }
+          });
+
+      // Pass 2: scatter into partitions, worker ranges keep row order.
+      this->partition_offsets.assign(partitions + 1, 0);
+      size_t offset{0};
+      for (size_t part = 0; part < partitions; ++part) {
+        this->partition_offsets[part] = offset;
+        for (unsigned worker = 0; worker < workers; ++worker) {
+          size_t count = histograms[worker][part];
+          histograms[worker][part] = offset;
+          offset += count;
+        }
+      }
+      this->partition_offsets[partitions] = offset;
+      this->entries.resize(rows);
+      Parallel::for_chunks(rows, workers,
+          [&](unsigned worker, size_t begin, size_t end) {
+            for (size_t row = begin; row < end; ++row) {
+              size_t part = this->partition(hashes[row]);
+              this->entries[histograms[worker][part]++] =
+                  Entry{hashes[row], row, keys[row]};
+            }
+          });
+
+      // Pass 3: chained hash table per partition, built in parallel.
+      this->bucket_offsets.assign(partitions + 1, 0);
+      this->bucket_masks.assign(partitions, 0);
+      for (size_t part = 0; part < partitions; ++part) {
+        size_t count = this->partition_offsets[part + 1] - this->partition_offsets[part];
+        size_t size = std::bit_ceil(std::max<size_t>(2 * count, 1));
+        this->bucket_masks[part] = size - 1;
+        this->bucket_offsets[part + 1] = this->bucket_offsets[part] + size;
+      }
+      this->buckets.assign(this->bucket_offsets[partitions], empty);
+      this->next.assign(rows, empty);
+      Parallel::for_each(partitions, Parallel::workers(threads, partitions),
+          [&](unsigned, size_t part) {
+            size_t first = this->partition_offsets[part];
+            size_t last = this->partition_offsets[part + 1];
+            uint32_t* heads = this->buckets.data() + this->bucket_offsets[part];
+            for (size_t index = last; index-- > first;) {
+              uint64_t bucket = this->entries[index].hash & this->bucket_masks[part];
+              this->next[index] = heads[bucket];
+              heads[bucket] = static_cast<uint32_t>(index - first);
+            }
+          });
+    }
+
+    /**
+     * @brief Getter for number of partitions of build side.
+     * @return size_t number of partitions.
+     */
+    size_t partition_count() const {
+      return this->partition_offsets.empty() ? 0 : this->partition_offsets.size() - 1;
+    }
+
+    /**
+     * @brief Probe build side with left key column.
+     * @param probe reference to left (probe) side key column.
+     * @param type inner, left or semi join.
+     * @return std::vector<JoinMatch> represent matches ordered by left row.
+     */
+    std::vector<JoinMatch> probe(Column<T>& probe, JoinType type) const {
+      std::vector<const T*> keys;
+      std::vector<uint64_t> hashes;
+      this->collect(probe, keys, hashes);
+      unsigned workers = Parallel::workers(this->threads, keys.size());
+      std::vector<std::vector<JoinMatch>> partial(workers);
+      Parallel::for_chunks(keys.size(), workers,
+          [&](unsigned worker, size_t begin, size_t end) {
+            std::vector<JoinMatch>& out = partial[worker];
+            for (size_t row = begin; row < end; ++row) {
+              uint64_t hash = hashes[row];
+              size_t part = this->partition(hash);
+              size_t first = this->partition_offsets[part];
+              uint32_t index = this->buckets[
+                  this->bucket_offsets[part] + (hash & this->bucket_masks[part])
+              ];
+              bool matched{false};
+              while (index != empty) {
+                const Entry& entry = this->entries[first + index];
+                if (entry.hash == hash && *entry.key == *keys[row]) {
+                  matched = true;
+                  out.push_back(JoinMatch{row, entry.row});
+                  if (type == JoinType::semi) {
+                    break;
+                  }
+                }
+                index = this->next[first + index];
+              }
+              if (!matched && type == JoinType::left) {
+                out.push_back(JoinMatch{row, JoinMatch::none});
+              }
+            }
+          });
+      size_t total{0};
+      for (const auto& matches : partial) {
+        total += matches.size();
+      }
+      std::vector<JoinMatch> result;
+      result.reserve(total);
+      for (const auto& matches : partial) {
+        result.insert(result.end(), matches.begin(), matches.end());
+      }
+      return result;
+    }
+
+    /**
+     * @brief Join two key columns.
+     * @param left reference to left (probe) side key column.
+     * @param right reference to right (build) side key column.
+     * @param type inner, left or semi join.
+     * @param threads number of worker threads (0 for hardware default).
+     * @return std::vector<JoinMatch> represent matches ordered by left row.
+     */
+    static std::vector<JoinMatch> join(Column<T>& left, Column<T>& right,
+        JoinType type, unsigned threads = 0) {
+      HashJoin<T> table{right, threads};
+      return table.probe(left, type);
+    }
+};
+
+#endif
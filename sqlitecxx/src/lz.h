@@ -0,0 +1,195 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * lz.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LZ_H
+#define LZ_H
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Number of hash bits of match finder (4K entries fit L1 cache).
+ */
+#define SQLITECXX_LZ_HASH_BITS 12
+
+/**
+ * @brief Lz. Fast LZ77 block codec with LZ4 style sequences: token
+ *        (literal length and match length nibbles), 255-run length
+ *        extensions, literals, 16-bit little-endian offset. Last sequence
+ *        has literals only. Greedy single probe hash match finder.
+ */
+class Lz final {
+
+  static constexpr size_t min_match{4};
+  static constexpr size_t max_offset{65535};
+
+  static uint32_t read4(const uint8_t* bytes) {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+
+  static uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - SQLITECXX_LZ_HASH_BITS);
+  }
+
+  static void length(std::vector<uint8_t>& out, size_t rest) {
+    for (; rest >= 255; rest -= 255) {
+      out.push_back(255);
+    }
+    out.push_back(static_cast<uint8_t>(rest));
+  }
+
+  static void sequence(
+      std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_length,
+      size_t offset, size_t match_length
+  ) {
+    size_t match = match_length ? match_length - min_match : 0;
+    out.push_back(static_cast<uint8_t>(
+        (std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match, 15)
+    ));
+    if (literal_length >= 15) {
+      length(out, literal_length - 15);
+    }
+    out.insert(out.end(), literals, literals + literal_length);
+    if (!match_length) {
+      return;
+    }
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (match >= 15) {
+      length(out, match - 15);
+    }
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Lz() = delete;
+
+    /**
+     * @brief Compress block.
+     * @param data input bytes.
+     * @param size number of input bytes.
+     * @param out compressed bytes (replaced).
+     */
+    static void compress(const void* data, size_t size, std::vector<uint8_t>& out) {
+      const uint8_t* input = static_cast<const uint8_t*>(data);
+      uint32_t table[size_t{1} << SQLITECXX_LZ_HASH_BITS]{};
+      out.clear();
+      out.reserve(size + size / 255 + 16);
+      size_t anchor{0};
+      size_t position{0};
+      while (position + min_match <= size) {
+        uint32_t current = read4(input + position);
+        uint32_t& slot = table[hash(current)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(position + 1);
+        if (candidate && position + 1 - candidate <= max_offset &&
+            read4(input + candidate - 1) == current) {
+          --candidate;
+          size_t match{min_match};
+          while (position + match < size && input[candidate + match] == input[position + match]) {
+            ++match;
+          }
+          sequence(out, input + anchor, position - anchor, position - candidate, match);
+          position += match;
+          anchor = position;
+          continue;
+        }
+        position += 1 + ((position - anchor) >> 6);
+      }
+      sequence(out, input + anchor, size - anchor, 0, 0);
+    }
+
+    /**
+     * @brief Decompress block, malformed input is detected, never read or
+     *        written out of bounds.
+     * @param data compressed bytes.
+     * @param size number of compressed bytes.
+     * @param out output buffer.
+     * @param capacity size of output buffer.
+     * @return size_t decompressed size or SIZE_MAX for malformed input.
+     */
+    static size_t decompress(const void* data, size_t size, void* out, size_t capacity) {
+      const uint8_t* input = static_cast<const uint8_t*>(data);
+      uint8_t* output = static_cast<uint8_t*>(out);
+      constexpr size_t invalid{std::numeric_limits<size_t>::max()};
+      size_t in{0};
+      size_t written{0};
+      while (in < size) {
+        uint8_t token = input[in++];
+        size_t literals = token >> 4;
+        if (literals == 15) {
+          uint8_t extension;
+          do {
+            if (in >= size) {
+              return invalid;
+            }
+            extension = input[in++];
+            literals += extension;
+          } while (extension == 255);
+        }
+        if (literals > size - in || literals > capacity - written) {
+          return invalid;
+        }
+        std::memcpy(output + written, input + in, literals);
+        in += literals;
+        written += literals;
+        if (in == size) {
+          break;
+        }
+        if (size - in < 2) {
+          return invalid;
+        }
+        size_t offset = input[in] | (static_cast<size_t>(input[in + 1]) << 8);
+        in += 2;
+        size_t match = (token & 15) + min_match;
+        if ((token & 15) == 15) {
+          uint8_t extension;
+          do {
+            if (in >= size) {
+              return invalid;
+            }
+            extension = input[in++];
+            match += extension;
+          } while (extension == 255);
+        }
+        if (offset == 0 || offset > written || match > capacity - written) {
+          return invalid;
+        }
+        uint8_t* target = output + written;
+        const uint8_t* source = target - offset;
+        if (offset >= match) {
+          std::memcpy(target, source, match);
+        } else {
+          for (size_t index = 0; index < match; ++index) {
+            target[index] = source[index];
+          }
+        }
+        written += match;
+      }
+      return written;
+    }
+};
+
+#endif
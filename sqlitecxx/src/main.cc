@@ -17,7 +17,112 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-int main(void) {
+#include <getopt.h>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+#include "workload.h"
 
-  return (0);
-}
\ No newline at end of file
+/**
+ * @brief Print usage of load generator.
+ * 
+ * @param defaults default options shown in help
+ */
+static void usage(const WorkloadOptions& defaults) {
+    std::cerr << "Usage : sqlitecxx [options]\n"
+        << "  -d, --database PATH    database file (" << defaults.database << ")\n"
+        << "  -t, --threads N        worker threads, one connection each ("
+        << defaults.threads << ")\n"
+        << "  -s, --duration SEC     run time (" << defaults.duration << ")\n"
+        << "  -i, --interval SEC     report interval (" << defaults.interval << ")\n"
+        << "  -r, --rows N           rows in load table (" << defaults.rows << ")\n"
+        << "  -m, --mix R:W:S        read, write, scan weights ("
+        << defaults.mix[0] << ":" << defaults.mix[1] << ":" << defaults.mix[2] << ")\n"
+        << "  -n, --scan-rows N      rows per range scan (" << defaults.scan_rows << ")\n"
+        << "  -p, --payload BYTES    payload per row (" << defaults.payload << ")\n"
+        << "  -j, --journal MODE     journal_mode (" << defaults.journal_mode << ")\n"
+        << "  -y, --synchronous MODE synchronous (" << defaults.synchronous << ")\n"
+        << "  -c, --cache-size N     cache_size (" << defaults.cache_size << ")\n"
+        << "  -b, --busy-timeout MS  maximal busy wait (" << defaults.busy_timeout << ")\n"
+        << "  -f, --fair             queue-fair busy handler\n"
+        << "  -e, --seed N           random seed (" << defaults.seed << ")\n";
+}
+
+/**
+ * @brief Parse read:write:scan weights.
+ * 
+ * @param text weights separated by colons
+ * @param mix parsed weights
+ * @return bool true when text has three weights which are not all 0
+ */
+static bool parse_mix(const std::string& text, std::array<unsigned, 3>& mix) {
+    std::istringstream stream{text};
+    char separator[2]{};
+    if (!(stream >> mix[0] >> separator[0] >> mix[1] >> separator[1] >> mix[2]) ||
+        separator[0] != ':' || separator[1] != ':') {
+        return false;
+    }
+    return mix[0] + mix[1] + mix[2] > 0;
+}
+
+/**
+ * @brief Multi-threaded load generator, runs mixed read/write/scan
+ *        workload against database file and reports throughput, latency
+ *        percentiles and SQLite status counters at fixed intervals.
+ * 
+ * @param argc number of arguments
+ * @param argv options, see usage()
+ * @return int 0 on success
+ */
+int main(int argc, char* argv[]) {
+    WorkloadOptions options;
+    const option long_options[] = {
+        {"database", required_argument, nullptr, 'd'},
+        {"threads", required_argument, nullptr, 't'},
+        {"duration", required_argument, nullptr, 's'},
+        {"interval", required_argument, nullptr, 'i'},
+        {"rows", required_argument, nullptr, 'r'},
+        {"mix", required_argument, nullptr, 'm'},
+        {"scan-rows", required_argument, nullptr, 'n'},
+        {"payload", required_argument, nullptr, 'p'},
+        {"journal", required_argument, nullptr, 'j'},
+        {"synchronous", required_argument, nullptr, 'y'},
+        {"cache-size", required_argument, nullptr, 'c'},
+        {"busy-timeout", required_argument, nullptr, 'b'},
+        {"seed", required_argument, nullptr, 'e'},
+        {"fair", no_argument, nullptr, 'f'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    while ((option = getopt_long(
+        argc, argv, "d:t:s:i:r:m:n:p:j:y:c:b:e:fh", long_options, nullptr
+    )) != -1) {
+        switch (option) {
+            case 'd': options.database = optarg; break;
+            case 't': options.threads = std::strtoul(optarg, nullptr, 10); break;
+            case 's': options.duration = std::strtoul(optarg, nullptr, 10); break;
+            case 'i': options.interval = std::strtoul(optarg, nullptr, 10); break;
+            case 'r': options.rows = std::strtoll(optarg, nullptr, 10); break;
+            case 'n': options.scan_rows = std::strtoll(optarg, nullptr, 10); break;
+            case 'p': options.payload = std::strtoul(optarg, nullptr, 10); break;
+            case 'j': options.journal_mode = optarg; break;
+            case 'y': options.synchronous = optarg; break;
+            case 'c': options.cache_size = std::atoi(optarg); break;
+            case 'b': options.busy_timeout = std::strtoul(optarg, nullptr, 10); break;
+            case 'e': options.seed = std::strtoull(optarg, nullptr, 10); break;
+            case 'f': options.fair = true; break;
+            case 'm':
+                if (parse_mix(optarg, options.mix)) {
+                    break;
+                }
+                std::cerr << "Error Options : bad mix " << optarg << std::endl;
+                return (1);
+            default:
+                usage(WorkloadOptions{});
+                return (option == 'h' ? 0 : 1);
+        }
+    }
+    Workload workload{options};
+    return (workload.run(std::cout));
+}
@@ -0,0 +1,114 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * mapped.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <string>
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief MappedFile. Read-only memory mapping of whole file, empty file
+ *        is not mapped (get_data() is nullptr).
+ */
+class MappedFile final {
+
+  int descriptor{-1};
+  const char* data{nullptr};
+  size_t size{0};
+
+  [[noreturn]] static void fail(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    MappedFile() = delete;
+
+    /**
+     * @brief Construct a new MappedFile object, maps file read-only.
+     * @param path file to map.
+     * @param advice madvise() access pattern for mapping.
+     */
+    explicit MappedFile(const std::string& path, int advice = MADV_SEQUENTIAL) {
+      this->descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (this->descriptor < 0) {
+        fail("open " + path);
+      }
+      struct stat status;
+      if (::fstat(this->descriptor, &status) != 0) {
+        ::close(this->descriptor);
+        fail("stat " + path);
+      }
+      this->size = static_cast<size_t>(status.st_size);
+      if (this->size == 0) {
+        return;
+      }
+      void* mapping = ::mmap(
+          nullptr, this->size, PROT_READ, MAP_PRIVATE, this->descriptor, 0
+      );
+      if (mapping == MAP_FAILED) {
+        ::close(this->descriptor);
+        fail("mmap " + path);
+      }
+      ::madvise(mapping, this->size, advice);
+      this->data = static_cast<const char*>(mapping);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Destructor for MappedFile object, unmaps file.
+     */
+    ~MappedFile() {
+      if (this->data) {
+        ::munmap(const_cast<char*>(this->data), this->size);
+      }
+      if (this->descriptor >= 0) {
+        ::close(this->descriptor);
+      }
+    }
+
+    /**
+     * @brief Getter for first byte of mapping.
+     * @return const char* represent file content.
+     */
+    const char* get_data() const {
+      return this->data;
+    }
+
+    /**
+     * @brief Getter for size of file.
+     * @return size_t number of mapped bytes.
+     */
+    size_t get_size() const {
+      return this->size;
+    }
+};
+
+#endif
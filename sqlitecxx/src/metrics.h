@@ -0,0 +1,211 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * metrics.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdint>
+#include <unordered_map>
+#include <sqlite3.h>
+#include "histogram.h"
+
+/**
+ * @brief Maximal number of cached raw SQL to normalized SQL mappings.
+ */
+#define SQLITECXX_METRICS_SQL_CACHE 4096
+
+/**
+ * @brief StatementMetrics. Metrics of one normalized SQL statement.
+ */
+struct StatementMetrics {
+  std::string sql;
+  uint64_t calls{0};
+  uint64_t rows{0};
+  uint64_t fullscan_steps{0};
+  uint64_t sorts{0};
+  uint64_t autoindexes{0};
+  uint64_t vm_steps{0};
+  uint64_t reprepares{0};
+  Histogram latency;
+};
+
+/**
+ * @brief StatementProfiler. Aggregates sqlite3_trace_v2 row and profile
+ *        events per normalized SQL, sqlite3_stmt_status counters are
+ *        read and reset after every statement run.
+ */
+class StatementProfiler final {
+
+  std::mutex mutex;
+  std::unordered_map<std::string, StatementMetrics> metrics;
+  std::unordered_map<std::string, std::string> normalized;
+  std::unordered_map<sqlite3_stmt*, uint64_t> pending_rows;
+
+  static bool is_identifier(char character) {
+    return std::isalnum(static_cast<unsigned char>(character)) ||
+        character == '_' || character == '$';
+  }
+
+  static uint64_t status(sqlite3_stmt* statement, int counter) {
+    return static_cast<uint64_t>(sqlite3_stmt_status(statement, counter, 1));
+  }
+
+  const std::string& lookup(const char* sql) {
+    auto found = this->normalized.find(sql);
+    if (found != this->normalized.end()) {
+      return found->second;
+    }
+    if (this->normalized.size() >= SQLITECXX_METRICS_SQL_CACHE) {
+      this->normalized.clear();
+    }
+    return this->normalized.emplace(sql, normalize(sql)).first->second;
+  }
+
+  public:
+    /**
+     * @brief Normalize SQL, literals become ?, whitespace is collapsed
+     *        and lists of placeholders (IN lists, VALUES) become one ?.
+     * @param sql SQL text.
+     * @return std::string represent normalized SQL.
+     */
+    static std::string normalize(const std::string& sql) {
+      std::string result;
+      result.reserve(sql.size());
+      size_t position{0};
+      auto placeholder = [&result]() {
+        size_t size = result.size();
+        if (size >= 3 && result.compare(size - 3, 3, "?, ") == 0) {
+          result.resize(size - 2);
+        } else if (size >= 2 && result.compare(size - 2, 2, "?,") == 0) {
+          result.pop_back();
+        } else {
+          result += '?';
+        }
+      };
+      while (position < sql.size()) {
+        char character = sql[position];
+        bool after_identifier = !result.empty() && is_identifier(result.back());
+        if (std::isspace(static_cast<unsigned char>(character))) {
+          while (position < sql.size() &&
+              std::isspace(static_cast<unsigned char>(sql[position]))) {
+            ++position;
+          }
+          if (!result.empty() && position < sql.size()) {
+            result += ' ';
+          }
+        } else if (character == '\'' ||
+            ((character == 'x' || character == 'X') && !after_identifier &&
+            position + 1 < sql.size() && sql[position + 1] == '\'')) {
+          position += (character == '\'') ? 1 : 2;
+          while (position < sql.size()) {
+            if (sql[position] == '\'' &&
+                !(position + 1 < sql.size() && sql[position + 1] == '\'')) {
+              break;
+            }
+            position += (sql[position] == '\'') ? 2 : 1;
+          }
+          ++position;
+          placeholder();
+        } else if (std::isdigit(static_cast<unsigned char>(character)) &&
+            !after_identifier) {
+          while (position < sql.size() &&
+              (is_identifier(sql[position]) || sql[position] == '.')) {
+            ++position;
+          }
+          placeholder();
+        } else if (character == '?' || character == ':' || character == '@' ||
+            (character == '$' && !after_identifier)) {
+          ++position;
+          while (position < sql.size() && is_identifier(sql[position])) {
+            ++position;
+          }
+          placeholder();
+        } else {
+          result += character;
+          ++position;
+        }
+      }
+      return result;
+    }
+
+    /**
+     * @brief Handle SQLITE_TRACE_ROW event.
+     * @param statement statement which produced row.
+     */
+    void on_row(sqlite3_stmt* statement) {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      ++(this->pending_rows[statement]);
+    }
+
+    /**
+     * @brief Handle SQLITE_TRACE_PROFILE event.
+     * @param statement finished statement.
+     * @param nanoseconds run time of statement.
+     */
+    void on_profile(sqlite3_stmt* statement, uint64_t nanoseconds) {
+      const char* sql = sqlite3_sql(statement);
+      std::lock_guard<std::mutex> lock{this->mutex};
+      const std::string& key = this->lookup(sql ? sql : "");
+      StatementMetrics& entry = this->metrics[key];
+      if (entry.calls == 0) {
+        entry.sql = key;
+      }
+      ++entry.calls;
+      entry.latency.record(nanoseconds);
+      auto rows = this->pending_rows.find(statement);
+      if (rows != this->pending_rows.end()) {
+        entry.rows += rows->second;
+        this->pending_rows.erase(rows);
+      }
+      entry.fullscan_steps += status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP);
+      entry.sorts += status(statement, SQLITE_STMTSTATUS_SORT);
+      entry.autoindexes += status(statement, SQLITE_STMTSTATUS_AUTOINDEX);
+      entry.vm_steps += status(statement, SQLITE_STMTSTATUS_VM_STEP);
+      entry.reprepares += status(statement, SQLITE_STMTSTATUS_REPREPARE);
+    }
+
+    /**
+     * @brief Copy of all collected metrics.
+     * @return std::vector<StatementMetrics> represent metrics snapshot.
+     */
+    std::vector<StatementMetrics> snapshot() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      std::vector<StatementMetrics> result;
+      result.reserve(this->metrics.size());
+      for (const auto& entry : this->metrics) {
+        result.push_back(entry.second);
+      }
+      return result;
+    }
+
+    /**
+     * @brief Forget all collected metrics.
+     */
+    void reset() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->metrics.clear();
+      this->pending_rows.clear();
+    }
+};
+
+#endif
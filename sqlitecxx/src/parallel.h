@@ -0,0 +1,107 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * parallel.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Parallel. Minimal fork/join helpers for column operators.
+ */
+class Parallel final {
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Parallel() = delete;
+
+    /**
+     * @brief Resolve number of worker threads.
+     * @param requested requested number of threads (0 for hardware default).
+     * @param work number of work items, no more workers than items.
+     * @return unsigned represent number of workers (at least 1).
+     */
+    static unsigned workers(unsigned requested, size_t work) {
+      if (requested == 0) {
+        requested = std::max(1u, std::thread::hardware_concurrency());
+      }
+      return static_cast<unsigned>(
+          std::max<size_t>(1, std::min<size_t>(requested, work))
+      );
+    }
+
+    /**
+     * @brief Split range [0, count) into contiguous chunks, one per worker.
+     * @param count number of items.
+     * @param workers number of workers (see workers()).
+     * @param function callable(unsigned worker, size_t begin, size_t end).
+     */
+    template <class F>
+    static void for_chunks(size_t count, unsigned workers, F function) {
+      size_t chunk = (count + workers - 1) / std::max(1u, workers);
+      if (workers <= 1) {
+        function(0u, size_t{0}, count);
+        return;
+      }
+      std::vector<std::thread> threads;
+      for (unsigned worker = 0; worker < workers; ++worker) {
+        size_t begin = std::min(count, worker * chunk);
+        size_t end = std::min(count, begin + chunk);
+        threads.emplace_back(function, worker, begin, end);
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+
+    /**
+     * @brief Run function for every item in [0, count), items are handed
+     *        out dynamically so uneven items balance across workers.
+     * @param count number of items.
+     * @param workers number of workers (see workers()).
+     * @param function callable(unsigned worker, size_t item).
+     */
+    template <class F>
+    static void for_each(size_t count, unsigned workers, F function) {
+      std::atomic<size_t> next{0};
+      auto worker_loop = [&](unsigned worker) {
+        for (size_t item = next++; item < count; item = next++) {
+          function(worker, item);
+        }
+      };
+      if (workers <= 1) {
+        worker_loop(0);
+        return;
+      }
+      std::vector<std::thread> threads;
+      for (unsigned worker = 0; worker < workers; ++worker) {
+        threads.emplace_back(worker_loop, worker);
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+};
+
+#endif
@@ -20,10 +20,10 @@
 #ifndef REAL_H
 #define REAL_H
 
+#include <string>
+#include <ostream>
 #include <base.h>
 
-#define SQLITECXX_REAL "sqlitecxx::real::"
-
 /**
  * @brief Real<T>. Floating point value, stored as an 8-byte IEEE
  *        floating point number.
@@ -43,10 +43,7 @@ class Real final : Base<T> {
      * @param payload value for floating data.
      */
     explicit Real(T payload) : Base<T>(payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " user defined cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, constructor, this, payload);
     }
 
     /**
@@ -54,10 +51,7 @@ class Real final : Base<T> {
      * @param source reference to Real<T> object for copy. 
      */
     Real(Real<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " Real<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, copy_constructor, this);
     }
 
     /**
@@ -65,20 +59,14 @@ class Real final : Base<T> {
      * @param source const reference to Real<T> object for copy. 
      */
     Real(const Real<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " const Real<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, copy_constructor, this);
     }
 
     /**
      * @brief Destructor for Real<T> object.
      */
     ~Real() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " default dstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, destructor, this);
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -95,6 +83,11 @@ class Real final : Base<T> {
       return "Real";
     }
 
+    /**
+     * @brief Getters for payload of Real<T> floating data.
+     */
+    using Base<T>::get;
+
     ///////////////////////////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////
     // Assignment operators
@@ -106,11 +99,7 @@ class Real final : Base<T> {
      * @param payload payload for floating data.
      */
     void operator=(T payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " floating";
-      std::cout << " arg : " << payload;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, assign, this, payload);
       this->payload = payload;
     }
 
@@ -119,12 +108,7 @@ class Real final : Base<T> {
      * @param source reference to Real<T> object.
      */
     void operator=(Real<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " Real<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -133,12 +117,7 @@ class Real final : Base<T> {
      * @param source const reference to Real<T> object.
      */
     void operator=(const Real<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " const Real<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -153,10 +132,7 @@ class Real final : Base<T> {
      * @return Real<T> & represent reference to Real<T>.
      */
     Real<T>& operator++() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " prefix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, pre_increment, this);
       ++(this->payload);
       return *this;
     }
@@ -166,10 +142,7 @@ class Real final : Base<T> {
      * @return Real<T> & represent reference to Real<T>.
      */
     Real<T>& operator--() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " prefix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, pre_decrement, this);
       --(this->payload);
       return *this;
     }
@@ -185,10 +158,7 @@ class Real final : Base<T> {
      * @return Real<T> represent dummy Real<T> object with old value.
      */
     Real<T> operator++(int) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " postfix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, post_increment, this);
       Real<T> temp{*this};
       ++*this; /* Invoke prefix operator */
       return temp;
@@ -199,10 +169,7 @@ class Real final : Base<T> {
      * @return Real<T> represent dummy Real<T> object with old value.
      */
     Real<T> operator--(int) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__ << " postfix";
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, post_decrement, this);
       Real<T> temp{*this};
       --*this; /* Invoke prefix operator */
       return temp;
@@ -220,10 +187,7 @@ class Real final : Base<T> {
      * @return Real<T> represent result Real<T> object.
      */
     Real<T> operator+(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, add, this);
       Real<T> temp{0};
       temp.payload = (
           (this->payload) + (other.payload)
@@ -237,10 +201,7 @@ class Real final : Base<T> {
      * @return Real<T> represent result Real<T> object.
      */
     Real<T> operator-(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, subtract, this);
       Real<T> temp{0};
       temp.payload = (
           (this->payload) - (other.payload)
@@ -254,10 +215,7 @@ class Real final : Base<T> {
      * @return Real<T> represent result Real<T> object.
      */
     Real<T> operator*(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, multiply, this);
       Real<T> temp{0};
       temp.payload = (
           (this->payload) * (other.payload)
@@ -271,10 +229,7 @@ class Real final : Base<T> {
      * @return Real<T> represent result Real<T> object.
      */
     Real<T> operator/(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(real, divide, this);
       Real<T> temp{0};
       temp.payload = (
           (this->payload) / (other.payload)
@@ -287,11 +242,8 @@ class Real final : Base<T> {
      * @param source const reference to right operand Real<T> object.
      * @return bool true for not equal else false.
      */
-    bool operator!=(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator!=(const Real<T>& other) const {
+      SQLITECXX_TRACE(real, not_equal, this);
       return (this->payload) != (other.payload);
     }
 
@@ -300,11 +252,8 @@ class Real final : Base<T> {
      * @param source const reference to right operand Real<T> object.
      * @return bool true for equal else false.
      */
-    bool operator==(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator==(const Real<T>& other) const {
+      SQLITECXX_TRACE(real, equal, this);
       return (this->payload) == (other.payload);
     }
 
@@ -313,11 +262,8 @@ class Real final : Base<T> {
      * @param source const reference to right operand Real<T> object.
      * @return bool true for greater or equal else false.
      */
-    bool operator>=(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>=(const Real<T>& other) const {
+      SQLITECXX_TRACE(real, greater_equal, this);
       return (this->payload) >= (other.payload);
     }
 
@@ -326,11 +272,8 @@ class Real final : Base<T> {
      * @param source const reference to right operand Real<T> object.
      * @return bool true for less or equal else false.
      */
-    bool operator<=(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<=(const Real<T>& other) const {
+      SQLITECXX_TRACE(real, less_equal, this);
       return (this->payload) <= (other.payload);
     }
 
@@ -339,11 +282,8 @@ class Real final : Base<T> {
      * @param source const reference to right operand Real<T> object.
      * @return bool true for greater else false.
      */
-    bool operator>(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>(const Real<T>& other) const {
+      SQLITECXX_TRACE(real, greater, this);
       return (this->payload) > (other.payload);
     }
 
@@ -352,11 +292,8 @@ class Real final : Base<T> {
      * @param source const reference to right operand Real<T> object.
      * @return bool true for less else false.
      */
-    bool operator<(const Real<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_REAL << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<(const Real<T>& other) const {
+      SQLITECXX_TRACE(real, less, this);
       return (this->payload) < (other.payload);
     }
 
@@ -0,0 +1,615 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * shard.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <map>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <variant>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <sqlite3.h>
+#include "sqlitecxx.h"
+#include "datatypes.h"
+#include "parallel.h"
+#include "bind.h"
+#include "hash.h"
+
+/**
+ * @brief ShardOptions. Behaviour of shard router.
+ */
+struct ShardOptions {
+  unsigned threads{0};         /* scatter-gather workers, 0 for one per shard */
+  bool wal{true};              /* WAL journal with synchronous=NORMAL on shards */
+};
+
+/**
+ * @brief Value of merged row (NULL, integer, real, text or blob bytes).
+ */
+using ShardValue = std::variant<std::nullptr_t, int64_t, double, std::string>;
+
+/**
+ * @brief Row of merged result.
+ */
+using ShardRow = std::vector<ShardValue>;
+
+/**
+ * @brief Combination of result column of all shards.
+ */
+enum class ShardCombine {
+  key,                         /* group by column */
+  sum,                         /* SUM() or TOTAL() partials */
+  count,                       /* COUNT() partials */
+  min,
+  max,
+  first                        /* first non-NULL value */
+};
+
+/**
+ * @brief ShardOrder. Sort column of merged result.
+ */
+struct ShardOrder {
+  size_t column;
+  bool descending{false};
+};
+
+/**
+ * @brief ShardMerge. Merge of per shard results of query_all().
+ *        Without combine rows are concatenated in shard order, or merged
+ *        in order when every shard returns rows sorted by order (same
+ *        ORDER BY in SQL). With combine rows of shards are partial
+ *        aggregates grouped by key columns and combined per column (AVG
+ *        is SUM and COUNT columns divided by caller), groups are sorted
+ *        by key columns unless order is given. Limit applies to merged
+ *        result (shards should use same LIMIT).
+ */
+struct ShardMerge {
+  std::vector<ShardCombine> combine{};
+  std::vector<ShardOrder> order{};
+  size_t limit{SIZE_MAX};
+};
+
+/**
+ * @brief ShardRouter. Logical table spread over N database files by hash
+ *        or range of key column. Point operations run on shard of key,
+ *        query_all() runs same SQL on every shard in parallel threads and
+ *        merges results, ingest() writes partitioned rows to all shards in
+ *        parallel (one transaction and write lock per shard, not atomic
+ *        across shards). Every shard
+ *        has own connection and statement cache guarded by mutex, so
+ *        router may be used from many threads.
+ */
+class ShardRouter final {
+
+  struct Shard {
+    std::unique_ptr<SQLiteCXX> db;
+    std::mutex mutex;
+    std::unordered_map<std::string, sqlite3_stmt*> statements;
+
+    ~Shard() {
+      for (auto& statement : this->statements) {
+        sqlite3_finalize(statement.second);
+      }
+    }
+
+    /**
+     * @brief Cached prepared statement, reset and without bindings.
+     */
+    sqlite3_stmt* prepare(const std::string& sql) {
+      auto found = this->statements.find(sql);
+      if (found != this->statements.end()) {
+        sqlite3_reset(found->second);
+        sqlite3_clear_bindings(found->second);
+        return found->second;
+      }
+      sqlite3_stmt* statement{nullptr};
+      if (sqlite3_prepare_v3(this->db->get_db(), sql.c_str(), -1,
+          SQLITE_PREPARE_PERSISTENT, &statement, nullptr) != SQLITE_OK) {
+        return nullptr;
+      }
+      this->statements.emplace(sql, statement);
+      return statement;
+    }
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards;
+  std::vector<int64_t> bounds;
+  ShardOptions options;
+
+  void open(const std::vector<std::string>& paths) {
+    if (paths.empty()) {
+      throw std::invalid_argument("shard router needs at least one shard");
+    }
+    for (const auto& path : paths) {
+      this->shards.push_back(std::make_unique<Shard>());
+      this->shards.back()->db = std::make_unique<SQLiteCXX>(path);
+      if (this->options.wal) {
+        this->shards.back()->db->execute("PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL");
+      }
+    }
+  }
+
+  unsigned workers() const {
+    return Parallel::workers(
+        this->options.threads ? this->options.threads : static_cast<unsigned>(this->shards.size()),
+        this->shards.size()
+    );
+  }
+
+  static ShardValue read(sqlite3_stmt* statement, int column) {
+    switch (sqlite3_column_type(statement, column)) {
+      case SQLITE_INTEGER:
+        return static_cast<int64_t>(sqlite3_column_int64(statement, column));
+      case SQLITE_FLOAT:
+        return sqlite3_column_double(statement, column);
+      case SQLITE_TEXT:
+      case SQLITE_BLOB: {
+        const void* bytes = sqlite3_column_blob(statement, column);
+        return std::string(
+            static_cast<const char*>(bytes), static_cast<size_t>(sqlite3_column_bytes(statement, column))
+        );
+      }
+      default:
+        return nullptr;
+    }
+  }
+
+  /**
+   * @brief Step statement to end, rows are appended when rows is set.
+   */
+  static int run(sqlite3_stmt* statement, std::vector<ShardRow>* rows) {
+    int status{SQLITE_ROW};
+    int columns = sqlite3_column_count(statement);
+    while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+      if (rows) {
+        ShardRow row;
+        row.reserve(static_cast<size_t>(columns));
+        for (int column = 0; column < columns; ++column) {
+          row.push_back(read(statement, column));
+        }
+        rows->push_back(std::move(row));
+      }
+    }
+    sqlite3_reset(statement);
+    return status == SQLITE_DONE ? SQLITE_OK : status;
+  }
+
+  template <class... V>
+  int run(size_t shard, const std::string& sql, std::vector<ShardRow>* rows, const V&... values) {
+    Shard& target = *this->shards[shard];
+    std::lock_guard<std::mutex> lock{target.mutex};
+    sqlite3_stmt* statement = target.prepare(sql);
+    if (!statement) {
+      return sqlite3_errcode(target.db->get_db());
+    }
+    if constexpr (sizeof...(V) > 0) {
+      int status = Bind::row(statement, values...);
+      if (status != SQLITE_OK) {
+        return status;
+      }
+    }
+    return run(statement, rows);
+  }
+
+  static double real(const ShardValue& value) {
+    if (const int64_t* integer = std::get_if<int64_t>(&value)) {
+      return static_cast<double>(*integer);
+    }
+    const double* real = std::get_if<double>(&value);
+    return real ? *real : 0.0;
+  }
+
+  /**
+   * @brief Order of values as in SQLite: NULL < numbers < text and blobs.
+   */
+  static int compare(const ShardValue& first, const ShardValue& second) {
+    auto rank = [](const ShardValue& value) {
+      return value.index() == 0 ? 0 : value.index() == 3 ? 2 : 1;
+    };
+    if (rank(first) != rank(second)) {
+      return rank(first) < rank(second) ? -1 : 1;
+    }
+    if (first.index() == 3) {
+      int order = std::get<std::string>(first).compare(std::get<std::string>(second));
+      return (order > 0) - (order < 0);
+    }
+    if (first.index() == 1 && second.index() == 1) {
+      int64_t left = std::get<int64_t>(first);
+      int64_t right = std::get<int64_t>(second);
+      return (left > right) - (left < right);
+    }
+    double left = real(first);
+    double right = real(second);
+    return (left > right) - (left < right);
+  }
+
+  static int compare(const ShardRow& first, const ShardRow& second, const std::vector<ShardOrder>& order) {
+    for (const auto& column : order) {
+      int result = compare(first[column.column], second[column.column]);
+      if (result) {
+        return column.descending ? -result : result;
+      }
+    }
+    return 0;
+  }
+
+  static void add(ShardValue& into, const ShardValue& value) {
+    if (value.index() == 0) {
+      return;
+    }
+    if (into.index() == 0) {
+      into = value;
+      return;
+    }
+    int64_t sum{0};
+    if (into.index() == 1 && value.index() == 1 &&
+        !__builtin_add_overflow(std::get<int64_t>(into), std::get<int64_t>(value), &sum)) {
+      into = sum;
+    } else {
+      into = real(into) + real(value);
+    }
+  }
+
+  static void combine(ShardRow& into, const ShardRow& row, const std::vector<ShardCombine>& combine) {
+    for (size_t column = 0; column < combine.size() && column < row.size(); ++column) {
+      ShardValue& target = into[column];
+      const ShardValue& value = row[column];
+      switch (combine[column]) {
+        case ShardCombine::sum:
+        case ShardCombine::count:
+          add(target, value);
+          break;
+        case ShardCombine::min:
+          if (value.index() != 0 && (target.index() == 0 || compare(value, target) < 0)) {
+            target = value;
+          }
+          break;
+        case ShardCombine::max:
+          if (value.index() != 0 && (target.index() == 0 || compare(value, target) > 0)) {
+            target = value;
+          }
+          break;
+        case ShardCombine::first:
+          if (target.index() == 0) {
+            target = value;
+          }
+          break;
+        case ShardCombine::key:
+          break;
+      }
+    }
+  }
+
+  /**
+   * @brief Combine rows of equal key columns, map is keyed by values of
+   *        key columns only.
+   */
+  static std::vector<ShardRow> group(std::vector<std::vector<ShardRow>>& parts, const ShardMerge& merge) {
+    std::vector<size_t> keys;
+    for (size_t column = 0; column < merge.combine.size(); ++column) {
+      if (merge.combine[column] == ShardCombine::key) {
+        keys.push_back(column);
+      }
+    }
+    auto less = [](const ShardRow& first, const ShardRow& second) {
+      return std::lexicographical_compare(first.begin(), first.end(), second.begin(), second.end(),
+          [](const ShardValue& left, const ShardValue& right) { return compare(left, right) < 0; });
+    };
+    std::map<ShardRow, size_t, decltype(less)> index{less};
+    std::vector<ShardRow> groups;
+    ShardRow key;
+    for (auto& part : parts) {
+      for (auto& row : part) {
+        key.clear();
+        for (size_t column : keys) {
+          key.push_back(column < row.size() ? row[column] : ShardValue{});
+        }
+        auto found = index.find(key);
+        if (found == index.end()) {
+          index.emplace(std::move(key), groups.size());
+          groups.push_back(std::move(row));
+        } else {
+          combine(groups[found->second], row, merge.combine);
+        }
+      }
+    }
+    std::vector<ShardRow> rows;
+    rows.reserve(groups.size());
+    for (auto& entry : index) {
+      rows.push_back(std::move(groups[entry.second]));
+    }
+    if (!merge.order.empty()) {
+      std::stable_sort(rows.begin(), rows.end(), [&merge](const ShardRow& first, const ShardRow& second) {
+        return compare(first, second, merge.order) < 0;
+      });
+    }
+    if (rows.size() > merge.limit) {
+      rows.resize(merge.limit);
+    }
+    return rows;
+  }
+
+  /**
+   * @brief K-way merge of sorted shard results, ties keep shard order.
+   */
+  static std::vector<ShardRow> ordered(std::vector<std::vector<ShardRow>>& parts, const ShardMerge& merge) {
+    using Head = std::pair<size_t, size_t>;
+    auto later = [&parts, &merge](const Head& first, const Head& second) {
+      int order = compare(parts[first.first][first.second], parts[second.first][second.second], merge.order);
+      return order ? order > 0 : first.first > second.first;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads{later};
+    for (size_t part = 0; part < parts.size(); ++part) {
+      if (!parts[part].empty()) {
+        heads.push({part, 0});
+      }
+    }
+    std::vector<ShardRow> rows;
+    while (!heads.empty() && rows.size() < merge.limit) {
+      Head head = heads.top();
+      heads.pop();
+      rows.push_back(std::move(parts[head.first][head.second]));
+      if (++head.second < parts[head.first].size()) {
+        heads.push(head);
+      }
+    }
+    return rows;
+  }
+
+  public:
+    /**
+     * @brief Construct a new ShardRouter object, hash sharding.
+     * @param paths database files, one per shard.
+     * @param options router options.
+     */
+    explicit ShardRouter(const std::vector<std::string>& paths, ShardOptions options = {})
+    : options{options} {
+      this->open(paths);
+    }
+
+    /**
+     * @brief Construct a new ShardRouter object, range sharding of integer
+     *        key, shard i holds keys in [bounds[i - 1], bounds[i]).
+     * @param paths database files, one per shard.
+     * @param bounds ascending split keys, one less than paths.
+     * @param options router options.
+     */
+    ShardRouter(const std::vector<std::string>& paths, std::vector<int64_t> bounds, ShardOptions options = {})
+    : bounds{std::move(bounds)}, options{options} {
+      if (this->bounds.size() + 1 != paths.size() ||
+          !std::is_sorted(this->bounds.begin(), this->bounds.end())) {
+        throw std::invalid_argument("range shards need ascending bounds, one less than paths");
+      }
+      this->open(paths);
+    }
+
+    ShardRouter(const ShardRouter&) = delete;
+    ShardRouter& operator=(const ShardRouter&) = delete;
+
+    /**
+     * @brief Getter for number of shards.
+     * @return size_t represent number of shards.
+     */
+    size_t get_shards() const {
+      return this->shards.size();
+    }
+
+    /**
+     * @brief Getter for connection of shard, use only while router isn't
+     *        used by other threads.
+     * @param shard index of shard.
+     * @return SQLiteCXX& represent connection.
+     */
+    SQLiteCXX& get_shard(size_t shard) {
+      return *this->shards.at(shard)->db;
+    }
+
+    /**
+     * @brief Shard of integer key.
+     * @param key integer key.
+     * @return size_t represent index of shard.
+     */
+    size_t route(int64_t key) const {
+      if (!this->bounds.empty()) {
+        return static_cast<size_t>(
+            std::upper_bound(this->bounds.begin(), this->bounds.end(), key) - this->bounds.begin()
+        );
+      }
+      return Hash::integer(static_cast<uint64_t>(key)) % this->shards.size();
+    }
+
+    /**
+     * @brief Shard of text key, hash sharding only.
+     * @param key text key.
+     * @return size_t represent index of shard.
+     */
+    size_t route(std::string_view key) const {
+      if (!this->bounds.empty()) {
+        throw std::invalid_argument("range shards need integer key");
+      }
+      return Hash::bytes(key.data(), key.size()) % this->shards.size();
+    }
+
+    template <class T>
+    size_t route(const Integer<T>& key) const {
+      return this->route(static_cast<int64_t>(key.get()));
+    }
+
+    template <class T>
+    size_t route(const Text<T>& key) const {
+      return this->route(std::string_view{key.get()});
+    }
+
+    /**
+     * @brief Run SQL statement(s) on every shard in parallel (schema).
+     * @param sql SQL statement(s) separated by semicolons.
+     * @return int SQLite status code of first failed shard or SQLITE_OK.
+     */
+    int execute_all(const std::string& sql) {
+      std::vector<int> status(this->shards.size(), SQLITE_OK);
+      Parallel::for_each(this->shards.size(), this->workers(), [&](unsigned, size_t shard) {
+        std::lock_guard<std::mutex> lock{this->shards[shard]->mutex};
+        status[shard] = this->shards[shard]->db->execute(sql);
+      });
+      for (int code : status) {
+        if (code != SQLITE_OK) {
+          return code;
+        }
+      }
+      return SQLITE_OK;
+    }
+
+    /**
+     * @brief Run statement on shard of key (point insert, update, delete).
+     * @param key routing key.
+     * @param sql one SQL statement, prepared once per shard.
+     * @param values sqlitecxx data types bound to parameters 1..N.
+     * @return int SQLite status code.
+     */
+    template <class K, class... V>
+    int execute(const K& key, const std::string& sql, const V&... values) {
+      return this->run(this->route(key), sql, nullptr, values...);
+    }
+
+    /**
+     * @brief Run query on shard of key (point read).
+     * @param key routing key.
+     * @param rows destination, rows are appended.
+     * @param sql one SQL statement, prepared once per shard.
+     * @param values sqlitecxx data types bound to parameters 1..N.
+     * @return int SQLite status code.
+     */
+    template <class K, class... V>
+    int query(const K& key, std::vector<ShardRow>& rows, const std::string& sql, const V&... values) {
+      return this->run(this->route(key), sql, &rows, values...);
+    }
+
+    /**
+     * @brief Run query on every shard in parallel and merge results.
+     * @param rows destination, replaced by merged rows.
+     * @param sql one SQL statement, prepared once per shard.
+     * @param merge merge of per shard results.
+     * @param values sqlitecxx data types bound to parameters 1..N.
+     * @return int SQLite status code of first failed shard or SQLITE_OK.
+     */
+    template <class... V>
+    int query_all(std::vector<ShardRow>& rows, const std::string& sql, const ShardMerge& merge = {},
+        const V&... values) {
+      std::vector<std::vector<ShardRow>> parts(this->shards.size());
+      std::vector<int> status(this->shards.size(), SQLITE_OK);
+      Parallel::for_each(this->shards.size(), this->workers(), [&](unsigned, size_t shard) {
+        status[shard] = this->run(shard, sql, &parts[shard], values...);
+      });
+      rows.clear();
+      for (int code : status) {
+        if (code != SQLITE_OK) {
+          return code;
+        }
+      }
+      if (!merge.combine.empty()) {
+        rows = group(parts, merge);
+      } else if (!merge.order.empty()) {
+        rows = ordered(parts, merge);
+      } else {
+        for (auto& part : parts) {
+          for (auto& row : part) {
+            if (rows.size() >= merge.limit) {
+              break;
+            }
+            rows.push_back(std::move(row));
+          }
+        }
+      }
+      return SQLITE_OK;
+    }
+
+    /**
+     * @brief Write rows to their shards in parallel, one transaction per
+     *        shard, first element of row is routing key and all elements
+     *        are bound to parameters 1..N of sql. Ingest is not atomic
+     *        across shards: failed shard rolls back its rows while other
+     *        shards keep theirs committed.
+     * @param sql one SQL statement (INSERT), prepared once per shard.
+     * @param rows tuples of sqlitecxx data types.
+     * @param committed when set, receives ascending shards which committed
+     *        their rows (shards without rows are not listed).
+     * @return int SQLite status code of first failed shard or SQLITE_OK.
+     */
+    template <class K, class... V>
+    int ingest(
+        const std::string& sql, const std::vector<std::tuple<K, V...>>& rows,
+        std::vector<size_t>* committed = nullptr
+    ) {
+      std::vector<std::vector<const std::tuple<K, V...>*>> parts(this->shards.size());
+      for (const auto& row : rows) {
+        parts[this->route(std::get<0>(row))].push_back(&row);
+      }
+      std::vector<int> status(this->shards.size(), SQLITE_OK);
+      Parallel::for_each(this->shards.size(), this->workers(), [&](unsigned, size_t shard) {
+        if (parts[shard].empty()) {
+          return;
+        }
+        Shard& target = *this->shards[shard];
+        std::lock_guard<std::mutex> lock{target.mutex};
+        sqlite3* db = target.db->get_db();
+        sqlite3_stmt* statement = target.prepare(sql);
+        int code = statement ? sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr) :
+            sqlite3_errcode(db);
+        for (size_t row = 0; code == SQLITE_OK && row < parts[shard].size(); ++row) {
+          code = std::apply([statement](const auto&... values) {
+            return Bind::row(statement, values...);
+          }, *parts[shard][row]);
+          if (code == SQLITE_OK) {
+            code = run(statement, nullptr);
+          }
+        }
+        if (statement) {
+          int end = sqlite3_exec(db, code == SQLITE_OK ? "COMMIT" : "ROLLBACK", nullptr, nullptr, nullptr);
+          code = code == SQLITE_OK ? end : code;
+        }
+        status[shard] = code;
+      });
+      if (committed) {
+        committed->clear();
+        for (size_t shard = 0; shard < status.size(); ++shard) {
+          if (!parts[shard].empty() && status[shard] == SQLITE_OK) {
+            committed->push_back(shard);
+          }
+        }
+      }
+      for (int code : status) {
+        if (code != SQLITE_OK) {
+          return code;
+        }
+      }
+      return SQLITE_OK;
+    }
+};
+
+#endif
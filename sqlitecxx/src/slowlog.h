@@ -0,0 +1,517 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * slowlog.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOWLOG_H
+#define SLOWLOG_H
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <sqlite3.h>
+
+/**
+ * @brief Default run time (ns) above which statement is logged, 100 ms.
+ */
+#define SQLITECXX_SLOWLOG_THRESHOLD 100000000
+
+/**
+ * @brief Default maximal number of entries kept in memory.
+ */
+#define SQLITECXX_SLOWLOG_CAPACITY 256
+
+/**
+ * @brief Estimated number of rows from which full scan of table is flagged.
+ */
+#define SQLITECXX_SLOWLOG_LARGE_TABLE 10000
+
+/**
+ * @brief SlowQuery. One slow statement run.
+ */
+struct SlowQuery {
+  int64_t timestamp{0};                     /* unix time in milliseconds */
+  uint64_t nanoseconds{0};                  /* run time of statement */
+  std::string sql;                          /* SQL with placeholders */
+  std::vector<std::string> parameters;      /* name and type of each parameter */
+  std::string plan;                         /* EXPLAIN QUERY PLAN tree */
+  std::vector<std::string> large_scans;     /* large tables in SCAN steps */
+  bool resolved{false};                     /* plan has been captured */
+};
+
+/**
+ * @brief SlowQueryLog. Bounded log of statements slower than threshold.
+ *        Statement, run time and parameter shapes (types and sizes, not
+ *        values) are captured in trace callback, EXPLAIN QUERY PLAN can't
+ *        run there and is captured later by resolve() together with
+ *        optional copy of entries into side table.
+ */
+class SlowQueryLog final {
+
+  std::mutex mutex;
+  std::deque<SlowQuery> entries;
+  uint64_t threshold;
+  size_t capacity;
+  std::string table;
+  bool table_ready{false};
+  uint64_t dropped{0};
+
+  static bool is_identifier(char character) {
+    return std::isalnum(static_cast<unsigned char>(character)) ||
+        character == '_' || character == '$';
+  }
+
+  /**
+   * @brief End of quoted token or comment starting at position, position
+   *        itself when there is no such token.
+   */
+  static size_t skip_quoted(const std::string& sql, size_t position) {
+    char character = sql[position];
+    char closing{0};
+    if (character == '\'' || character == '"' || character == '`') {
+      closing = character;
+    } else if (character == '[') {
+      closing = ']';
+    } else if (sql.compare(position, 2, "--") == 0) {
+      size_t end = sql.find('\n', position);
+      return end == std::string::npos ? sql.size() : end;
+    } else if (sql.compare(position, 2, "/*") == 0) {
+      size_t end = sql.find("*/", position + 2);
+      return end == std::string::npos ? sql.size() : end + 2;
+    } else {
+      return position;
+    }
+    ++position;
+    while (position < sql.size()) {
+      if (sql[position] == closing) {
+        if (closing != ']' && position + 1 < sql.size() &&
+            sql[position + 1] == closing) {
+          position += 2;
+          continue;
+        }
+        return position + 1;
+      }
+      ++position;
+    }
+    return sql.size();
+  }
+
+  /**
+   * @brief Type and size of value which sqlite3_expanded_sql() wrote in
+   *        place of parameter, advances position behind the value.
+   */
+  static std::string shape(const std::string& expanded, size_t& position) {
+    if (expanded.compare(position, 4, "NULL") == 0) {
+      position += 4;
+      return "NULL";
+    }
+    if (expanded[position] == '\'') {
+      size_t end = skip_quoted(expanded, position);
+      size_t size{0};
+      for (size_t index = position + 1; index + 1 < end; ++index) {
+        if (expanded[index] == '\'') {
+          ++index;
+        }
+        ++size;
+      }
+      position = end;
+      return "TEXT(" + std::to_string(size) + ")";
+    }
+    if (expanded.compare(position, 2, "x'") == 0) {
+      size_t end = skip_quoted(expanded, position + 1);
+      size_t size = end > position + 3 ? (end - position - 3) / 2 : 0;
+      position = end;
+      return "BLOB(" + std::to_string(size) + ")";
+    }
+    if (expanded.compare(position, 9, "zeroblob(") == 0) {
+      size_t end = expanded.find(')', position);
+      std::string size = expanded.substr(position + 9, end - position - 9);
+      position = end == std::string::npos ? expanded.size() : end + 1;
+      return "BLOB(" + size + ")";
+    }
+    bool real{false};
+    size_t start{position};
+    while (position < expanded.size() &&
+        (is_identifier(expanded[position]) || expanded[position] == '.' ||
+        ((expanded[position] == '-' || expanded[position] == '+') &&
+        (position == start || expanded[position - 1] == 'e')))) {
+      real = real || !std::isdigit(static_cast<unsigned char>(expanded[position]));
+      ++position;
+    }
+    real = real && !(expanded[start] == '-' &&
+        expanded.find_first_not_of("0123456789", start + 1) >= position);
+    return real ? "REAL" : "INTEGER";
+  }
+
+  /**
+   * @brief Name and shape of every bound parameter, original and expanded
+   *        SQL are identical outside of parameters so they are walked in
+   *        lock step.
+   */
+  static std::vector<std::string> parameters(sqlite3_stmt* statement) {
+    int count = sqlite3_bind_parameter_count(statement);
+    std::vector<std::string> result(static_cast<size_t>(count));
+    if (count == 0) {
+      return result;
+    }
+    for (int index = 1; index <= count; ++index) {
+      const char* name = sqlite3_bind_parameter_name(statement, index);
+      result[index - 1] = name ? name : "?" + std::to_string(index);
+    }
+    char* text = sqlite3_expanded_sql(statement);
+    if (!text) {
+      return result;
+    }
+    std::string sql{sqlite3_sql(statement)};
+    std::string expanded{text};
+    sqlite3_free(text);
+    std::vector<bool> seen(result.size(), false);
+    size_t original{0};
+    size_t position{0};
+    int next{1};
+    while (original < sql.size() && position < expanded.size()) {
+      size_t end = skip_quoted(sql, original);
+      if (end != original) {
+        position += end - original;
+        original = end;
+        continue;
+      }
+      char character = sql[original];
+      bool parameter = character == '?' || character == ':' ||
+          character == '@' || (character == '$' &&
+          (original == 0 || !is_identifier(sql[original - 1])));
+      if (!parameter) {
+        if (is_identifier(character)) {
+          while (original < sql.size() && is_identifier(sql[original])) {
+            ++original;
+            ++position;
+          }
+        } else {
+          ++original;
+          ++position;
+        }
+        continue;
+      }
+      end = original + 1;
+      while (end < sql.size() && is_identifier(sql[end])) {
+        ++end;
+      }
+      int index = sqlite3_bind_parameter_index(
+          statement, sql.substr(original, end - original).c_str()
+      );
+      if (index == 0 && character == '?') {
+        index = end - original > 1 ? std::atoi(sql.c_str() + original + 1) : next;
+      }
+      original = end;
+      std::string value = shape(expanded, position);
+      if (index > 0 && index <= count) {
+        next = index + 1;
+        if (!seen[index - 1]) {
+          seen[index - 1] = true;
+          result[index - 1] += " " + value;
+        }
+      }
+    }
+    return result;
+  }
+
+  /**
+   * @brief Run single row query with optional text parameter.
+   */
+  static bool query(
+      sqlite3* db, const std::string& sql, const std::string& parameter,
+      std::string& result
+  ) {
+    sqlite3_stmt* statement{nullptr};
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+      return false;
+    }
+    if (!parameter.empty()) {
+      sqlite3_bind_text(
+          statement, 1, parameter.c_str(), static_cast<int>(parameter.size()),
+          SQLITE_STATIC
+      );
+    }
+    bool found = sqlite3_step(statement) == SQLITE_ROW &&
+        sqlite3_column_type(statement, 0) != SQLITE_NULL;
+    if (found) {
+      result = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    }
+    sqlite3_finalize(statement);
+    return found;
+  }
+
+  static std::string quote(const std::string& name) {
+    std::string result{"\""};
+    for (char character : name) {
+      result += character;
+      if (character == '"') {
+        result += '"';
+      }
+    }
+    return result + "\"";
+  }
+
+  /**
+   * @brief Estimated number of rows of table, from sqlite_stat1 when
+   *        ANALYZE has been run, otherwise from largest rowid, -1 when
+   *        name is not table or estimate is not possible.
+   */
+  static int64_t table_rows(sqlite3* db, const std::string& name) {
+    std::string value;
+    if (!query(db, "SELECT name FROM sqlite_schema WHERE type = 'table' "
+        "AND name = ?1 COLLATE NOCASE", name, value)) {
+      return -1;
+    }
+    if (query(db, "SELECT stat FROM sqlite_stat1 WHERE tbl = ?1 LIMIT 1", value, value)) {
+      return std::atoll(value.c_str());
+    }
+    if (query(db, "SELECT max(_rowid_) FROM " + quote(value), "", value)) {
+      return std::atoll(value.c_str());
+    }
+    return -1;
+  }
+
+  /**
+   * @brief Resolve alias used by plan to table name, alias is identifier
+   *        following table name (optionally after AS) in statement.
+   */
+  static std::string alias_table(
+      sqlite3* db, const std::string& sql, const std::string& alias
+  ) {
+    std::vector<std::string> tokens;
+    size_t position{0};
+    while (position < sql.size()) {
+      size_t end = skip_quoted(sql, position);
+      if (end != position) {
+        if (sql[position] == '"' || sql[position] == '`' || sql[position] == '[') {
+          tokens.push_back(sql.substr(position + 1, end - position - 2));
+        }
+        position = end;
+      } else if (is_identifier(sql[position])) {
+        end = position;
+        while (end < sql.size() && is_identifier(sql[end])) {
+          ++end;
+        }
+        tokens.push_back(sql.substr(position, end - position));
+        position = end;
+      } else {
+        if (!std::isspace(static_cast<unsigned char>(sql[position]))) {
+          tokens.push_back(std::string(1, sql[position]));
+        }
+        ++position;
+      }
+    }
+    auto equal = [](const std::string& left, const std::string& right) {
+      return sqlite3_stricmp(left.c_str(), right.c_str()) == 0;
+    };
+    for (size_t index = 1; index < tokens.size(); ++index) {
+      if (!equal(tokens[index], alias)) {
+        continue;
+      }
+      size_t candidate = index - 1;
+      if (candidate > 0 && equal(tokens[candidate], "AS")) {
+        --candidate;
+      }
+      if (table_rows(db, tokens[candidate]) >= 0) {
+        return tokens[candidate];
+      }
+    }
+    return alias;
+  }
+
+  /**
+   * @brief Capture EXPLAIN QUERY PLAN of entry and flag large scans.
+   */
+  static void explain(
+      sqlite3* db, SlowQuery& entry,
+      std::unordered_map<std::string, int64_t>& sizes
+  ) {
+    sqlite3_stmt* statement{nullptr};
+    std::string sql = "EXPLAIN QUERY PLAN " + entry.sql;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+      entry.plan = std::string{"error: "} + sqlite3_errmsg(db);
+      return;
+    }
+    std::unordered_map<int, size_t> depths;
+    while (sqlite3_step(statement) == SQLITE_ROW) {
+      int id = sqlite3_column_int(statement, 0);
+      int parent = sqlite3_column_int(statement, 1);
+      std::string detail{
+          reinterpret_cast<const char*>(sqlite3_column_text(statement, 3))
+      };
+      size_t depth = depths.count(parent) ? depths[parent] + 1 : 0;
+      depths[id] = depth;
+      entry.plan += std::string(depth * 2, ' ') + detail + "\n";
+      if (detail.compare(0, 5, "SCAN ") != 0) {
+        continue;
+      }
+      size_t begin = detail.compare(5, 6, "TABLE ") == 0 ? 11 : 5;
+      std::string name = detail.substr(begin, detail.find(' ', begin) - begin);
+      auto found = sizes.find(name);
+      if (found == sizes.end()) {
+        std::string target = table_rows(db, name) >= 0 ?
+            name : alias_table(db, entry.sql, name);
+        found = sizes.emplace(name, table_rows(db, target)).first;
+      }
+      if (found->second >= SQLITECXX_SLOWLOG_LARGE_TABLE) {
+        entry.large_scans.push_back(name);
+      }
+    }
+    sqlite3_finalize(statement);
+  }
+
+  /**
+   * @brief Append entry into side table, created on first use.
+   */
+  bool store(sqlite3* db, const SlowQuery& entry) {
+    if (!this->table_ready) {
+      std::string sql = "CREATE TABLE IF NOT EXISTS " + quote(this->table) +
+          "(timestamp INTEGER, nanoseconds INTEGER, sql TEXT, "
+          "parameters TEXT, plan TEXT, large_scans TEXT)";
+      if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return false;
+      }
+      this->table_ready = true;
+    }
+    std::string sql = "INSERT INTO " + quote(this->table) +
+        " VALUES (?1, ?2, ?3, ?4, ?5, ?6)";
+    sqlite3_stmt* statement{nullptr};
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+      return false;
+    }
+    auto join = [](const std::vector<std::string>& values) {
+      std::string result;
+      for (const auto& value : values) {
+        result += (result.empty() ? "" : ", ") + value;
+      }
+      return result;
+    };
+    std::string parameters = join(entry.parameters);
+    std::string scans = join(entry.large_scans);
+    sqlite3_bind_int64(statement, 1, entry.timestamp);
+    sqlite3_bind_int64(statement, 2, static_cast<sqlite3_int64>(entry.nanoseconds));
+    sqlite3_bind_text(statement, 3, entry.sql.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(statement, 4, parameters.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(statement, 5, entry.plan.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(statement, 6, scans.c_str(), -1, SQLITE_STATIC);
+    int status = sqlite3_step(statement);
+    sqlite3_finalize(statement);
+    return status == SQLITE_DONE;
+  }
+
+  public:
+    /**
+     * @brief Construct a new SlowQueryLog object.
+     * @param threshold run time (ns) from which statement is logged.
+     * @param capacity maximal number of entries, oldest are dropped.
+     * @param table name of side table, empty for in-memory log only.
+     */
+    SlowQueryLog(uint64_t threshold, size_t capacity, std::string table)
+    : threshold{threshold}, capacity{capacity ? capacity : 1}, table{table} {}
+
+    /**
+     * @brief Handle SQLITE_TRACE_PROFILE event.
+     * @param statement finished statement.
+     * @param nanoseconds run time of statement.
+     */
+    void on_profile(sqlite3_stmt* statement, uint64_t nanoseconds) {
+      if (nanoseconds < this->threshold) {
+        return;
+      }
+      SlowQuery entry;
+      entry.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch()
+      ).count();
+      entry.nanoseconds = nanoseconds;
+      const char* sql = sqlite3_sql(statement);
+      entry.sql = sql ? sql : "";
+      entry.parameters = parameters(statement);
+      std::lock_guard<std::mutex> lock{this->mutex};
+      if (this->entries.size() >= this->capacity) {
+        this->entries.pop_front();
+        ++(this->dropped);
+      }
+      this->entries.push_back(std::move(entry));
+    }
+
+    /**
+     * @brief Capture plans of new entries and copy them into side table,
+     *        must not be called from trace callback, statements it runs
+     *        should not be traced.
+     * @param db connection on which statements were run.
+     */
+    void resolve(sqlite3* db) {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      std::unordered_map<std::string, int64_t> sizes;
+      bool transaction{false};
+      for (auto& entry : this->entries) {
+        if (entry.resolved) {
+          continue;
+        }
+        explain(db, entry, sizes);
+        entry.resolved = true;
+        if (this->table.empty()) {
+          continue;
+        }
+        if (!transaction && sqlite3_get_autocommit(db)) {
+          transaction = sqlite3_exec(
+              db, "BEGIN", nullptr, nullptr, nullptr
+          ) == SQLITE_OK;
+        }
+        this->store(db, entry);
+      }
+      if (transaction) {
+        sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+      }
+    }
+
+    /**
+     * @brief Copy of logged entries, oldest first.
+     * @return std::vector<SlowQuery> represent log snapshot.
+     */
+    std::vector<SlowQuery> snapshot() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      return {this->entries.begin(), this->entries.end()};
+    }
+
+    /**
+     * @brief Getter for number of entries dropped because log was full.
+     * @return uint64_t number of dropped entries.
+     */
+    uint64_t get_dropped() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      return this->dropped;
+    }
+
+    /**
+     * @brief Forget all logged entries.
+     */
+    void reset() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->entries.clear();
+      this->dropped = 0;
+    }
+};
+
+#endif
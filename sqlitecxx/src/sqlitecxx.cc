@@ -18,6 +18,7 @@
  */
 
 #include <iostream>
+#include "trace.h"
 #include "sqlitecxx.h"
 
 /**
@@ -28,7 +29,23 @@
 SQLiteCXX::SQLiteCXX(std::string database_name)
 : db_name{database_name} {
     this->db_status = sqlite3_open(this->db_name.c_str(), &(this->db));
-    std::cout << "Opened Database Successfully!" << std::endl;
+    SQLITECXX_TRACE(database, open, this, this->db_status);
+}
+
+/**
+ * @brief Construct a new SQLiteCXX::SQLiteCXX object in immutable
+ *        read-only serving mode (immutable=1, SQLITE_OPEN_READONLY |
+ *        SQLITE_OPEN_NOMUTEX, whole file memory mapped), file must never
+ *        change and connection must be used by one thread at a time,
+ *        use ImmutablePool to share statements between threads
+ * 
+ * @param database_name path of database file
+ * @param options mmap size
+ */
+SQLiteCXX::SQLiteCXX(std::string database_name, ImmutableOptions options)
+: db_name{database_name} {
+    this->db_status = Immutable::open(this->db_name, &(this->db), options);
+    SQLITECXX_TRACE(database, open, this, this->db_status);
 }
 
 /**
@@ -36,8 +53,9 @@ SQLiteCXX::SQLiteCXX(std::string database_name)
  * 
  */
 SQLiteCXX::~SQLiteCXX() {
-    sqlite3_close(this->db);
-    std::cout << "Closed Database Successfully!" << std::endl;
+    this->flush_slow_queries();
+    int status = sqlite3_close(this->db);
+    SQLITECXX_TRACE(database, close, this, status);
 }
 
 int SQLiteCXX::create_table(std::string sql_create_table) {
@@ -52,3 +70,284 @@ int SQLiteCXX::create_table(std::string sql_create_table) {
     }
     return status;
 }
+
+/**
+ * @brief Execute SQL statement(s) which don't return rows.
+ * 
+ * @param sql SQL statement(s) separated by semicolons
+ * @return int SQLite status code
+ */
+int SQLiteCXX::execute(std::string sql) {
+    int status{0};
+    char* messaggeError{nullptr};
+    status = sqlite3_exec(this->db, sql.c_str(), nullptr, 0, &messaggeError);
+    if (status != SQLITE_OK) {
+        std::cerr << "Error Execute : ";
+        std::cerr << (messaggeError ? messaggeError : sqlite3_errstr(status));
+        std::cerr << std::endl;
+        sqlite3_free(messaggeError);
+    }
+    this->flush_slow_queries();
+    return status;
+}
+
+/**
+ * @brief Getter for SQLite database connection handle
+ * 
+ * @return sqlite3* connection handle for prepared statements
+ */
+sqlite3* SQLiteCXX::get_db() {
+    return this->db;
+}
+
+/**
+ * @brief Dispatch sqlite3_trace_v2 events to enabled collectors, run
+ *        time is measured with steady clock between stmt and profile
+ *        events because profile event time has only millisecond
+ *        resolution on unix, trigger stmt events ("--" comments) are
+ *        ignored, statement end also finishes pending busy conflict
+ * 
+ * @param type SQLITE_TRACE_STMT, SQLITE_TRACE_PROFILE or SQLITE_TRACE_ROW
+ * @param context pointer to SQLiteCXX object
+ * @param pointer prepared statement
+ * @param extra SQL text (stmt) or pointer to run time in ns (profile)
+ * @return int always 0
+ */
+int SQLiteCXX::trace_callback(
+    unsigned type, void* context, void* pointer, void* extra
+) {
+    SQLiteCXX* database = static_cast<SQLiteCXX*>(context);
+    sqlite3_stmt* statement = static_cast<sqlite3_stmt*>(pointer);
+    if (type == SQLITE_TRACE_PROFILE && database->busy_handler) {
+        database->busy_handler->on_statement_end();
+    }
+    if (database->trace_suspended) {
+        return 0;
+    }
+    if (type == SQLITE_TRACE_STMT) {
+        const char* sql = static_cast<const char*>(extra);
+        if (!(sql && sql[0] == '-' && sql[1] == '-')) {
+            database->statement_started[statement] =
+                std::chrono::steady_clock::now();
+        }
+    } else if (type == SQLITE_TRACE_ROW) {
+        if (database->statement_metrics) {
+            database->profiler->on_row(statement);
+        }
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        uint64_t nanoseconds = *static_cast<sqlite3_int64*>(extra);
+        auto started = database->statement_started.find(statement);
+        if (started != database->statement_started.end()) {
+            nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started->second
+            ).count();
+            database->statement_started.erase(started);
+        }
+        if (database->statement_metrics) {
+            database->profiler->on_profile(statement, nanoseconds);
+        }
+        if (database->slow_query_log) {
+            database->slow_log->on_profile(statement, nanoseconds);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Install trace callback with mask of events needed by collectors
+ * 
+ */
+void SQLiteCXX::update_trace() {
+    unsigned mask{0};
+    if (this->statement_metrics) {
+        mask |= SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW;
+    }
+    if (this->slow_query_log) {
+        mask |= SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE;
+    }
+    if (this->busy_handler) {
+        mask |= SQLITE_TRACE_PROFILE;
+    }
+    if (!(mask & SQLITE_TRACE_STMT)) {
+        this->statement_started.clear();
+    }
+    sqlite3_trace_v2(
+        this->db, mask, mask ? &SQLiteCXX::trace_callback : nullptr, this
+    );
+}
+
+/**
+ * @brief Enable or disable per statement metrics
+ * 
+ * @param enable true to collect metrics, collected data is kept on disable
+ */
+void SQLiteCXX::enable_statement_metrics(bool enable) {
+    if (enable && !this->profiler) {
+        this->profiler = std::make_unique<StatementProfiler>();
+    }
+    this->statement_metrics = enable;
+    this->update_trace();
+}
+
+/**
+ * @brief Snapshot of per statement metrics keyed by normalized SQL
+ * 
+ * @return std::vector<StatementMetrics> copy of collected metrics
+ */
+std::vector<StatementMetrics> SQLiteCXX::get_statement_metrics() {
+    if (!this->profiler) {
+        return {};
+    }
+    return this->profiler->snapshot();
+}
+
+/**
+ * @brief Forget collected per statement metrics
+ * 
+ */
+void SQLiteCXX::reset_statement_metrics() {
+    if (this->profiler) {
+        this->profiler->reset();
+    }
+}
+
+/**
+ * @brief Enable or disable slow query log
+ * 
+ * @param enable true to log statements slower than threshold
+ * @param threshold run time in nanoseconds from which statement is logged
+ * @param capacity maximal number of entries kept in memory
+ * @param table name of side table for entries, empty for memory only
+ */
+void SQLiteCXX::enable_slow_query_log(
+    bool enable, uint64_t threshold, size_t capacity, std::string table
+) {
+    if (enable) {
+        this->flush_slow_queries();
+        this->slow_log = std::make_unique<SlowQueryLog>(
+            threshold, capacity, table
+        );
+    }
+    this->slow_query_log = enable;
+    this->update_trace();
+}
+
+/**
+ * @brief Capture EXPLAIN QUERY PLAN of new slow queries and store them
+ *        into side table, called after execute() and on close
+ * 
+ */
+void SQLiteCXX::flush_slow_queries() {
+    if (!this->slow_log || this->trace_suspended) {
+        return;
+    }
+    this->trace_suspended = true;
+    this->slow_log->resolve(this->db);
+    this->trace_suspended = false;
+}
+
+/**
+ * @brief Snapshot of slow query log with captured query plans
+ * 
+ * @return std::vector<SlowQuery> copy of logged entries, oldest first
+ */
+std::vector<SlowQuery> SQLiteCXX::get_slow_queries() {
+    if (!this->slow_log) {
+        return {};
+    }
+    this->flush_slow_queries();
+    return this->slow_log->snapshot();
+}
+
+/**
+ * @brief Forget logged slow queries
+ * 
+ */
+void SQLiteCXX::reset_slow_queries() {
+    if (this->slow_log) {
+        this->slow_log->reset();
+    }
+}
+
+/**
+ * @brief Sample connection memory, cache and global status counters
+ * 
+ * @param reset reset highwater marks and cumulative counters
+ * @return StatusSnapshot use Status::delta() to compare two snapshots
+ */
+StatusSnapshot SQLiteCXX::get_status(bool reset) {
+    return Status::snapshot(this->db, reset);
+}
+
+/**
+ * @brief Install busy handler with exponential backoff and jitter, or
+ *        remove it (SQLITE_BUSY is returned immediately), contention
+ *        counters are kept until reset_busy_metrics()
+ * 
+ * @param enable true to install busy handler
+ * @param options backoff, maximal wait and fair mode
+ */
+void SQLiteCXX::enable_busy_handler(bool enable, BusyOptions options) {
+    sqlite3_busy_handler(this->db, nullptr, nullptr);
+    this->busy_metrics = this->get_busy_metrics();
+    this->busy_handler.reset();
+    if (enable) {
+        const char* path = sqlite3_db_filename(this->db, "main");
+        this->busy_handler = std::make_unique<BusyHandler>(
+            options, path && path[0] ? path : this->db_name, this->busy_metrics
+        );
+        sqlite3_busy_handler(
+            this->db, &BusyHandler::callback, this->busy_handler.get()
+        );
+    }
+    this->update_trace();
+}
+
+/**
+ * @brief Snapshot of busy events, wait time and lock acquisition latency
+ * 
+ * @return BusyMetrics copy of contention counters
+ */
+BusyMetrics SQLiteCXX::get_busy_metrics() {
+    if (!this->busy_handler) {
+        return this->busy_metrics;
+    }
+    return this->busy_handler->snapshot();
+}
+
+/**
+ * @brief Forget busy handler contention counters
+ * 
+ */
+void SQLiteCXX::reset_busy_metrics() {
+    this->busy_metrics = BusyMetrics{};
+    if (this->busy_handler) {
+        this->busy_handler->reset();
+    }
+}
+
+/**
+ * @brief Make io_uring VFS default for connections opened afterwards
+ * 
+ * @param enable true to register io_uring VFS, false for unix VFS
+ * @param options batching, read-ahead and O_DIRECT of io_uring VFS
+ * @return bool true when io_uring VFS is in use (false when kernel
+ *         doesn't provide io_uring and unix VFS stays in use)
+ */
+bool SQLiteCXX::enable_uring_vfs(bool enable, UringOptions options) {
+    if (!enable) {
+        UringVfs::uninstall();
+        return false;
+    }
+    return UringVfs::install(options, true);
+}
+
+/**
+ * @brief Register sqlitecxx_array() table-valued function, key sets are
+ *        bound by ArrayTable::bind() as one parameter of IN or JOIN
+ * 
+ * @return int SQLite status code
+ */
+int SQLiteCXX::enable_array_binding() {
+    return ArrayTable::create(this->db);
+}
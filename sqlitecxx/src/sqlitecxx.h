@@ -22,7 +22,19 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
 #include <sqlite3.h>
+#include "metrics.h"
+#include "slowlog.h"
+#include "status.h"
+#include "busy.h"
+#include "uring.h"
+#include "array.h"
+#include "function.h"
+#include "aggregate.h"
+#include "immutable.h"
 
 /**
  * @brief 
@@ -33,11 +45,81 @@ class SQLiteCXX {
 std::string db_name{nullptr};
 sqlite3* db{nullptr};
 int db_status{0};
+std::unique_ptr<StatementProfiler> profiler{};
+bool statement_metrics{false};
+std::unique_ptr<SlowQueryLog> slow_log{};
+bool slow_query_log{false};
+bool trace_suspended{false};
+std::unique_ptr<BusyHandler> busy_handler{};
+BusyMetrics busy_metrics{};
+std::unordered_map<
+    sqlite3_stmt*, std::chrono::steady_clock::time_point
+> statement_started{};
+
+static int trace_callback(
+    unsigned type, void* context, void* pointer, void* extra
+);
+void update_trace();
 
 public:
     SQLiteCXX(std::string database_name);
+    SQLiteCXX(std::string database_name, ImmutableOptions options);
     ~SQLiteCXX();
     int create_table(std::string sql_create_table);
+    int execute(std::string sql);
+    sqlite3* get_db();
+    void enable_statement_metrics(bool enable);
+    std::vector<StatementMetrics> get_statement_metrics();
+    void reset_statement_metrics();
+    void enable_slow_query_log(
+        bool enable,
+        uint64_t threshold = SQLITECXX_SLOWLOG_THRESHOLD,
+        size_t capacity = SQLITECXX_SLOWLOG_CAPACITY,
+        std::string table = ""
+    );
+    void flush_slow_queries();
+    std::vector<SlowQuery> get_slow_queries();
+    void reset_slow_queries();
+    StatusSnapshot get_status(bool reset = false);
+    void enable_busy_handler(bool enable, BusyOptions options = {});
+    BusyMetrics get_busy_metrics();
+    void reset_busy_metrics();
+    static bool enable_uring_vfs(bool enable, UringOptions options = {});
+    int enable_array_binding();
+    template <class F>
+    int create_function(
+        const std::string& name, F function, int flags = SQLITECXX_FUNCTION_FLAGS
+    );
+    template <class S>
+    int create_aggregate(const std::string& name, int flags = SQLITECXX_FUNCTION_FLAGS);
 };
 
+/**
+ * @brief Register C++ callable as SQL scalar function, arity and
+ *        argument/result conversions are derived from its signature
+ * 
+ * @param name SQL function name
+ * @param function function, function pointer or lambda (owned by connection)
+ * @param flags SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS by default, pass
+ *        0 for functions with side effects or random results
+ * @return int SQLite status code
+ */
+template <class F>
+int SQLiteCXX::create_function(const std::string& name, F function, int flags) {
+    return Function::create(this->db, name, std::move(function), flags);
+}
+
+/**
+ * @brief Register C++ state type as SQL aggregate and window function,
+ *        sliding frames need inverse() (see AggregateFunction)
+ * 
+ * @param name SQL function name
+ * @param flags SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS by default
+ * @return int SQLite status code
+ */
+template <class S>
+int SQLiteCXX::create_aggregate(const std::string& name, int flags) {
+    return AggregateFunction::create<S>(this->db, name, flags);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,330 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * status.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATUS_H
+#define STATUS_H
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <condition_variable>
+#include <sqlite3.h>
+
+/**
+ * @brief Default maximal number of snapshots kept by StatusSampler.
+ */
+#define SQLITECXX_STATUS_SAMPLES 1024
+
+/**
+ * @brief StatusCounter. Current value and highwater mark of one counter.
+ */
+struct StatusCounter {
+  int64_t current{0};
+  int64_t highwater{0};
+};
+
+/**
+ * @brief DatabaseStatus. Structured sqlite3_db_status() of connection,
+ *        counters are gauges, hits/misses/writes/spills are cumulative.
+ */
+struct DatabaseStatus {
+  StatusCounter lookaside_used;      /* lookaside slots in use */
+  int64_t lookaside_hit{0};          /* allocations served by lookaside */
+  int64_t lookaside_miss_size{0};    /* misses, request larger than slot */
+  int64_t lookaside_miss_full{0};    /* misses, all slots in use */
+  int64_t cache_used{0};             /* page cache heap bytes */
+  int64_t cache_used_shared{0};      /* page cache bytes, shared caches split */
+  int64_t cache_hit{0};              /* page cache hits */
+  int64_t cache_miss{0};             /* page cache misses */
+  int64_t cache_write{0};            /* dirty pages written to disk */
+  int64_t cache_spill{0};            /* dirty pages spilled mid-transaction */
+  int64_t schema_used{0};            /* schema heap bytes */
+  int64_t statement_used{0};         /* prepared statements heap bytes */
+  int64_t deferred_foreign_keys{0};  /* unresolved deferred constraints */
+
+  /**
+   * @brief Ratio of page cache hits to all page cache lookups.
+   * @return double in range 0.0 - 1.0, 0.0 without lookups.
+   */
+  double cache_hit_ratio() const {
+    int64_t lookups = this->cache_hit + this->cache_miss;
+    return lookups ? static_cast<double>(this->cache_hit) / lookups : 0.0;
+  }
+};
+
+/**
+ * @brief GlobalStatus. Structured sqlite3_status64() of the process.
+ */
+struct GlobalStatus {
+  StatusCounter memory_used;         /* bytes allocated by sqlite3_malloc */
+  StatusCounter malloc_count;        /* outstanding allocations */
+  StatusCounter malloc_size;         /* largest allocation request */
+  StatusCounter pagecache_used;      /* pages used from SQLITE_CONFIG_PAGECACHE */
+  StatusCounter pagecache_overflow;  /* page cache bytes taken from heap */
+  StatusCounter pagecache_size;      /* largest page cache request */
+  StatusCounter parser_stack;        /* deepest parser stack */
+};
+
+/**
+ * @brief StatusSnapshot. Connection and process status at one moment.
+ */
+struct StatusSnapshot {
+  std::chrono::steady_clock::time_point time{};
+  DatabaseStatus database;
+  GlobalStatus global;
+};
+
+/**
+ * @brief Status. Sampling and deltas of SQLite status counters.
+ */
+class Status final {
+
+  static StatusCounter database_counter(sqlite3* db, int operation, bool reset) {
+    int current{0};
+    int highwater{0};
+    sqlite3_db_status(db, operation, &current, &highwater, reset);
+    return {current, highwater};
+  }
+
+  static StatusCounter global_counter(int operation, bool reset) {
+    sqlite3_int64 current{0};
+    sqlite3_int64 highwater{0};
+    sqlite3_status64(operation, &current, &highwater, reset);
+    return {current, highwater};
+  }
+
+  static StatusCounter delta(const StatusCounter& later, const StatusCounter& earlier) {
+    return {later.current - earlier.current, later.highwater};
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Status() = delete;
+
+    /**
+     * @brief Sample sqlite3_db_status() of connection.
+     * @param db connection handle.
+     * @param reset reset highwater marks and cumulative counters.
+     * @return DatabaseStatus represent connection status.
+     */
+    static DatabaseStatus database(sqlite3* db, bool reset = false) {
+      DatabaseStatus status;
+      status.lookaside_used = database_counter(db, SQLITE_DBSTATUS_LOOKASIDE_USED, reset);
+      status.lookaside_hit = database_counter(
+          db, SQLITE_DBSTATUS_LOOKASIDE_HIT, reset
+      ).highwater;
+      status.lookaside_miss_size = database_counter(
+          db, SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE, reset
+      ).highwater;
+      status.lookaside_miss_full = database_counter(
+          db, SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL, reset
+      ).highwater;
+      status.cache_used = database_counter(db, SQLITE_DBSTATUS_CACHE_USED, reset).current;
+      status.cache_used_shared = database_counter(
+          db, SQLITE_DBSTATUS_CACHE_USED_SHARED, reset
+      ).current;
+      status.cache_hit = database_counter(db, SQLITE_DBSTATUS_CACHE_HIT, reset).current;
+      status.cache_miss = database_counter(db, SQLITE_DBSTATUS_CACHE_MISS, reset).current;
+      status.cache_write = database_counter(db, SQLITE_DBSTATUS_CACHE_WRITE, reset).current;
+      status.cache_spill = database_counter(db, SQLITE_DBSTATUS_CACHE_SPILL, reset).current;
+      status.schema_used = database_counter(db, SQLITE_DBSTATUS_SCHEMA_USED, reset).current;
+      status.statement_used = database_counter(db, SQLITE_DBSTATUS_STMT_USED, reset).current;
+      status.deferred_foreign_keys = database_counter(
+          db, SQLITE_DBSTATUS_DEFERRED_FKS, reset
+      ).current;
+      return status;
+    }
+
+    /**
+     * @brief Sample process wide sqlite3_status64().
+     * @param reset reset highwater marks.
+     * @return GlobalStatus represent process status.
+     */
+    static GlobalStatus global(bool reset = false) {
+      GlobalStatus status;
+      status.memory_used = global_counter(SQLITE_STATUS_MEMORY_USED, reset);
+      status.malloc_count = global_counter(SQLITE_STATUS_MALLOC_COUNT, reset);
+      status.malloc_size = global_counter(SQLITE_STATUS_MALLOC_SIZE, reset);
+      status.pagecache_used = global_counter(SQLITE_STATUS_PAGECACHE_USED, reset);
+      status.pagecache_overflow = global_counter(SQLITE_STATUS_PAGECACHE_OVERFLOW, reset);
+      status.pagecache_size = global_counter(SQLITE_STATUS_PAGECACHE_SIZE, reset);
+      status.parser_stack = global_counter(SQLITE_STATUS_PARSER_STACK, reset);
+      return status;
+    }
+
+    /**
+     * @brief Sample connection and process status.
+     * @param db connection handle.
+     * @param reset reset highwater marks and cumulative counters.
+     * @return StatusSnapshot represent status at this moment.
+     */
+    static StatusSnapshot snapshot(sqlite3* db, bool reset = false) {
+      StatusSnapshot snapshot;
+      snapshot.time = std::chrono::steady_clock::now();
+      snapshot.database = database(db, reset);
+      snapshot.global = global(reset);
+      return snapshot;
+    }
+
+    /**
+     * @brief Change between two snapshots, cumulative counters and gauges
+     *        are subtracted, highwater marks are taken from later one.
+     * @param later const reference to later snapshot.
+     * @param earlier const reference to earlier snapshot.
+     * @return StatusSnapshot with time of later and counters as deltas.
+     */
+    static StatusSnapshot delta(const StatusSnapshot& later, const StatusSnapshot& earlier) {
+      StatusSnapshot result{later};
+      const DatabaseStatus& from = earlier.database;
+      DatabaseStatus& to = result.database;
+      to.lookaside_used = delta(later.database.lookaside_used, from.lookaside_used);
+      to.lookaside_hit -= from.lookaside_hit;
+      to.lookaside_miss_size -= from.lookaside_miss_size;
+      to.lookaside_miss_full -= from.lookaside_miss_full;
+      to.cache_used -= from.cache_used;
+      to.cache_used_shared -= from.cache_used_shared;
+      to.cache_hit -= from.cache_hit;
+      to.cache_miss -= from.cache_miss;
+      to.cache_write -= from.cache_write;
+      to.cache_spill -= from.cache_spill;
+      to.schema_used -= from.schema_used;
+      to.statement_used -= from.statement_used;
+      to.deferred_foreign_keys -= from.deferred_foreign_keys;
+      const GlobalStatus& before = earlier.global;
+      GlobalStatus& after = result.global;
+      after.memory_used = delta(later.global.memory_used, before.memory_used);
+      after.malloc_count = delta(later.global.malloc_count, before.malloc_count);
+      after.malloc_size = delta(later.global.malloc_size, before.malloc_size);
+      after.pagecache_used = delta(later.global.pagecache_used, before.pagecache_used);
+      after.pagecache_overflow = delta(
+          later.global.pagecache_overflow, before.pagecache_overflow
+      );
+      after.pagecache_size = delta(later.global.pagecache_size, before.pagecache_size);
+      after.parser_stack = delta(later.global.parser_stack, before.parser_stack);
+      return result;
+    }
+};
+
+/**
+ * @brief StatusSampler. Takes StatusSnapshot of connection at fixed
+ *        interval on background thread, keeps bounded history. Sampling
+ *        runs concurrently with owner of connection, so connection must
+ *        be serialized (sqlite3_db_mutex() not null), connections opened
+ *        with SQLITE_OPEN_NOMUTEX (e.g. Immutable) are rejected.
+ */
+class StatusSampler final {
+
+  sqlite3* db;
+  std::chrono::nanoseconds interval;
+  size_t capacity;
+  std::deque<StatusSnapshot> history;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool running{true};
+  std::thread worker;
+
+  static sqlite3* serialized(sqlite3* db) {
+    if (db == nullptr || sqlite3_db_mutex(db) == nullptr) {
+      throw std::invalid_argument("status sampler needs serialized connection");
+    }
+    return db;
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock{this->mutex};
+    while (this->running) {
+      lock.unlock();
+      StatusSnapshot snapshot = Status::snapshot(this->db);
+      lock.lock();
+      if (this->history.size() >= this->capacity) {
+        this->history.pop_front();
+      }
+      this->history.push_back(snapshot);
+      this->wakeup.wait_for(lock, this->interval, [this] { return !this->running; });
+    }
+  }
+
+  public:
+    /**
+     * @brief Construct a new StatusSampler object and start sampling.
+     * @param db serialized connection handle (std::invalid_argument if
+     *        it has no mutex), must outlive sampler.
+     * @param interval time between samples.
+     * @param capacity maximal number of kept snapshots, oldest are dropped.
+     */
+    StatusSampler(
+        sqlite3* db, std::chrono::nanoseconds interval,
+        size_t capacity = SQLITECXX_STATUS_SAMPLES
+    ) : db{serialized(db)}, interval{interval}, capacity{capacity ? capacity : 1},
+        worker{&StatusSampler::run, this} {}
+
+    StatusSampler(const StatusSampler&) = delete;
+    StatusSampler& operator=(const StatusSampler&) = delete;
+
+    /**
+     * @brief Destructor for StatusSampler object, stops sampling.
+     */
+    ~StatusSampler() {
+      this->stop();
+    }
+
+    /**
+     * @brief Stop sampling, history is kept.
+     */
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        this->running = false;
+      }
+      this->wakeup.notify_all();
+      if (this->worker.joinable()) {
+        this->worker.join();
+      }
+    }
+
+    /**
+     * @brief Copy of sampled snapshots, oldest first.
+     * @return std::vector<StatusSnapshot> represent sampled history.
+     */
+    std::vector<StatusSnapshot> samples() {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      return {this->history.begin(), this->history.end()};
+    }
+
+    /**
+     * @brief Deltas between consecutive sampled snapshots.
+     * @return std::vector<StatusSnapshot> represent change per interval.
+     */
+    std::vector<StatusSnapshot> deltas() {
+      std::vector<StatusSnapshot> snapshots = this->samples();
+      std::vector<StatusSnapshot> result;
+      for (size_t index = 1; index < snapshots.size(); ++index) {
+        result.push_back(Status::delta(snapshots[index], snapshots[index - 1]));
+      }
+      return result;
+    }
+};
+
+#endif
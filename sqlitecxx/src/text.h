@@ -20,10 +20,10 @@
 #ifndef TEXT_H
 #define TEXT_H
 
+#include <string>
+#include <ostream>
 #include <base.h>
 
-#define SQLITECXX_TEXT "sqlitecxx::text::"
-
 /**
  * @brief Text<T>. Text string, stored using the database encoding (UTF-8).
  * @tparam T - std::string | std::string_view.
@@ -42,10 +42,7 @@ class Text final : Base<T> {
      * @param payload value for text data.
      */
     explicit Text(T payload) : Base<T>(payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " user defined cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, constructor, this, payload);
     }
 
     /**
@@ -53,10 +50,7 @@ class Text final : Base<T> {
      * @param source reference to Text<T> object for copy. 
      */
     Text(Text<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__ << " Text<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, copy_constructor, this);
     }
 
     /**
@@ -64,20 +58,14 @@ class Text final : Base<T> {
      * @param source const reference to Text<T> object for copy. 
      */
     Text(const Text<T>& source) : Base<T>(source.payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__ << " const Text<T>";
-      std::cout << " copy cstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, copy_constructor, this);
     }
 
     /**
      * @brief Destructor for Text<T> object.
      */
     ~Text() {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " default dstor " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, destructor, this);
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -94,6 +82,11 @@ class Text final : Base<T> {
       return "Text";
     }
 
+    /**
+     * @brief Getters for payload of Text<T> text data.
+     */
+    using Base<T>::get;
+
     ///////////////////////////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////
     // Assignment operators
@@ -105,11 +98,7 @@ class Text final : Base<T> {
      * @param payload payload for text data.
      */
     void operator=(T payload) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__ << " string(s)";
-      std::cout << " arg : " << payload;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, assign, this, payload);
       this->payload = payload;
     }
 
@@ -118,12 +107,7 @@ class Text final : Base<T> {
      * @param source reference to Text<T> object.
      */
     void operator=(Text<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__ << " Text<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -132,12 +116,7 @@ class Text final : Base<T> {
      * @param source Reference to Text<T> object.
      */
     void operator=(const Text<T>& source) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__ << "Text<T>";
-      std::cout << " arg : " << source.payload;
-      std::cout << " at " << &source;
-      std::cout << " to " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, assign, this, source.payload);
       this->payload = source.payload;
     }
 
@@ -153,10 +132,7 @@ class Text final : Base<T> {
      * @return Text<T> result Text<T> object.
      */
     Text<T> operator+(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+      SQLITECXX_TRACE(text, add, this);
       Text<T> temp{"None"};
       temp.payload = (
           (this->payload) + (other.payload)
@@ -169,11 +145,8 @@ class Text final : Base<T> {
      * @param source right operand Text<T> object.
      * @return bool true for not equal else false.
      */
-    bool operator!=(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator!=(const Text<T>& other) const {
+      SQLITECXX_TRACE(text, not_equal, this);
       return (this->payload) != (other.payload);
     }
 
@@ -182,11 +155,8 @@ class Text final : Base<T> {
      * @param source right operand Text<T> object.
      * @return bool true for equal else false.
      */
-    bool operator==(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator==(const Text<T>& other) const {
+      SQLITECXX_TRACE(text, equal, this);
       return (this->payload) == (other.payload);
     }
 
@@ -195,11 +165,8 @@ class Text final : Base<T> {
      * @param source right operand Text<T> object.
      * @return bool true for greater or equal else false.
      */
-    bool operator>=(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>=(const Text<T>& other) const {
+      SQLITECXX_TRACE(text, greater_equal, this);
       return (this->payload) >= (other.payload);
     }
 
@@ -208,11 +175,8 @@ class Text final : Base<T> {
      * @param source right operand Text<T> object.
      * @return bool true for less or equal else false.
      */
-    bool operator<=(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<=(const Text<T>& other) const {
+      SQLITECXX_TRACE(text, less_equal, this);
       return (this->payload) <= (other.payload);
     }
 
@@ -221,11 +185,8 @@ class Text final : Base<T> {
      * @param source right operand Text<T> object.
      * @return bool true for greater else false.
      */
-    bool operator>(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator>(const Text<T>& other) const {
+      SQLITECXX_TRACE(text, greater, this);
       return (this->payload) > (other.payload);
     }
 
@@ -234,11 +195,8 @@ class Text final : Base<T> {
      * @param source right operand Text<T> object.
      * @return bool true for less else false.
      */
-    bool operator<(const Text<T>& other) {
-#if SQLITECXX_VERBOSE == SQLITECXX_VERBOSE_ENABLED
-      std::cout << SQLITECXX_TEXT << __func__;
-      std::cout << " at " << this << std::endl;
-#endif
+    bool operator<(const Text<T>& other) const {
+      SQLITECXX_TRACE(text, less, this);
       return (this->payload) < (other.payload);
     }
 
@@ -0,0 +1,487 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * trace.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <bit>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * @brief MACROS for compiling tracing in/out, set to 0 to remove every
+ *        trace point at compile time.
+ */
+#ifndef SQLITECXX_TRACING
+#define SQLITECXX_TRACING 1
+#endif
+
+/**
+ * @brief Number of records in per-thread ring buffer (power of two).
+ */
+#ifndef SQLITECXX_TRACE_BUFFER
+#define SQLITECXX_TRACE_BUFFER 16384
+#endif
+
+/**
+ * @brief Environment variable with comma separated enabled categories.
+ */
+#define SQLITECXX_TRACE_ENV "SQLITECXX_TRACE"
+
+/**
+ * @brief Trace categories, selectable at runtime as bit mask.
+ */
+enum class TraceCategory : uint8_t {
+  base,
+  integer,
+  real,
+  text,
+  blob,
+  column,
+  database
+};
+
+/**
+ * @brief Trace events, one per traced operation.
+ */
+enum class TraceEvent : uint8_t {
+  constructor,
+  copy_constructor,
+  destructor,
+  get,
+  set,
+  get_name,
+  set_name,
+  get_type,
+  set_type,
+  get_primary_key,
+  set_primary_key,
+  assign,
+  pre_increment,
+  pre_decrement,
+  post_increment,
+  post_decrement,
+  add,
+  subtract,
+  multiply,
+  divide,
+  not_equal,
+  equal,
+  greater_equal,
+  less_equal,
+  greater,
+  less,
+  open,
+  close
+};
+
+/**
+ * @brief Kind of argument stored in TraceRecord.
+ */
+enum class TraceArgument : uint8_t {
+  none,
+  integer,
+  real,
+  size
+};
+
+/**
+ * @brief TraceRecord. Binary trace event, 32 bytes.
+ */
+struct TraceRecord {
+  uint64_t timestamp;
+  uint64_t object;
+  uint64_t argument;
+  uint32_t thread;
+  TraceCategory category;
+  TraceEvent event;
+  TraceArgument kind;
+  uint8_t reserved;
+};
+
+/**
+ * @brief TraceBuffer. Lock-free single producer/single consumer ring of
+ *        TraceRecord objects, owned by one thread, drained by Trace.
+ */
+class TraceBuffer final {
+
+  std::unique_ptr<TraceRecord[]> records;
+  alignas(64) std::atomic<uint64_t> head{0};
+  alignas(64) std::atomic<uint64_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<bool> orphaned{false};
+  uint32_t thread;
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    TraceBuffer() = delete;
+
+    /**
+     * @brief Construct a new TraceBuffer object.
+     * @param thread sequential id of owner thread.
+     */
+    explicit TraceBuffer(uint32_t thread)
+    : records{new TraceRecord[SQLITECXX_TRACE_BUFFER]}, thread{thread} {
+      static_assert(
+          std::has_single_bit(static_cast<unsigned>(SQLITECXX_TRACE_BUFFER)),
+          "SQLITECXX_TRACE_BUFFER must be power of two"
+      );
+    }
+
+    /**
+     * @brief Append record, record is dropped (and counted) if ring is full.
+     * @param record const reference to TraceRecord.
+     */
+    void push(const TraceRecord& record) {
+      uint64_t position = this->head.load(std::memory_order_relaxed);
+      if (position - this->tail.load(std::memory_order_acquire) >=
+          SQLITECXX_TRACE_BUFFER) {
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      this->records[position & (SQLITECXX_TRACE_BUFFER - 1)] = record;
+      this->records[position & (SQLITECXX_TRACE_BUFFER - 1)].thread = this->thread;
+      this->head.store(position + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Move all pending records to out (single consumer only).
+     * @param out destination vector.
+     */
+    void drain(std::vector<TraceRecord>& out) {
+      uint64_t position = this->tail.load(std::memory_order_relaxed);
+      uint64_t end = this->head.load(std::memory_order_acquire);
+      for (; position < end; ++position) {
+        out.push_back(this->records[position & (SQLITECXX_TRACE_BUFFER - 1)]);
+      }
+      this->tail.store(position, std::memory_order_release);
+    }
+
+    /**
+     * @brief Getter for number of dropped records.
+     * @return uint64_t number of records lost because ring was full.
+     */
+    uint64_t get_dropped() const {
+      return this->dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Mark buffer as orphaned (owner thread has exited).
+     */
+    void set_orphaned() {
+      this->orphaned.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Check if buffer can be released.
+     * @return bool true if owner has exited and ring is empty.
+     */
+    bool is_released() const {
+      return this->orphaned.load(std::memory_order_acquire) &&
+          this->head.load(std::memory_order_acquire) ==
+          this->tail.load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * @brief Trace. Process wide tracing front end, trace points cost one
+ *        relaxed atomic load while their category is disabled.
+ */
+class Trace final {
+
+  /**
+   * @brief Registry of per-thread buffers.
+   */
+  struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    uint32_t next_thread{0};
+  };
+
+  /**
+   * @brief Thread local handle, orphans buffer at thread exit.
+   */
+  struct Holder {
+    std::shared_ptr<TraceBuffer> buffer;
+
+    Holder() {
+      Registry& registry = Trace::registry();
+      std::lock_guard<std::mutex> lock{registry.mutex};
+      this->buffer = std::make_shared<TraceBuffer>(registry.next_thread++);
+      registry.buffers.push_back(this->buffer);
+    }
+
+    ~Holder() {
+      this->buffer->set_orphaned();
+    }
+  };
+
+  static std::atomic<uint32_t> mask;
+
+  static Registry& registry() {
+    static Registry registry;
+    return registry;
+  }
+
+  static TraceBuffer& local() {
+    thread_local Holder holder;
+    return *holder.buffer;
+  }
+
+  static uint32_t from_environment() {
+    const char* categories = std::getenv(SQLITECXX_TRACE_ENV);
+    return categories ? Trace::parse(categories) : 0;
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    Trace() = delete;
+
+    /**
+     * @brief Parse comma separated category names (or "all").
+     * @param categories category names, e.g. "integer,column".
+     * @return uint32_t represent category mask.
+     */
+    static uint32_t parse(std::string categories) {
+      static const char* names[] = {
+        "base", "integer", "real", "text", "blob", "column", "database"
+      };
+      uint32_t result{0};
+      std::stringstream stream{categories};
+      std::string name;
+      while (std::getline(stream, name, ',')) {
+        if (name == "all") {
+          result = ~uint32_t{0};
+        }
+        for (uint32_t category = 0; category < std::size(names); ++category) {
+          if (name == names[category]) {
+            result |= uint32_t{1} << category;
+          }
+        }
+      }
+      return result;
+    }
+
+    /**
+     * @brief Enable category at runtime.
+     * @param category trace category.
+     */
+    static void enable(TraceCategory category) {
+      mask.fetch_or(uint32_t{1} << static_cast<unsigned>(category));
+    }
+
+    /**
+     * @brief Disable category at runtime.
+     * @param category trace category.
+     */
+    static void disable(TraceCategory category) {
+      mask.fetch_and(~(uint32_t{1} << static_cast<unsigned>(category)));
+    }
+
+    /**
+     * @brief Setter for category mask.
+     * @param categories mask (see parse()).
+     */
+    static void set_mask(uint32_t categories) {
+      mask.store(categories);
+    }
+
+    /**
+     * @brief Check if category is enabled.
+     * @param category trace category.
+     * @return bool true if enabled else false.
+     */
+    static bool enabled(TraceCategory category) {
+      return mask.load(std::memory_order_relaxed) &
+          (uint32_t{1} << static_cast<unsigned>(category));
+    }
+
+    /**
+     * @brief Convert traced argument into record field.
+     * @param value argument of traced operation.
+     * @param kind destination for kind of argument.
+     * @return uint64_t represent argument bits.
+     */
+    template <class A>
+    static uint64_t argument(const A& value, TraceArgument& kind) {
+      if constexpr (std::is_integral_v<A>) {
+        kind = TraceArgument::integer;
+        return static_cast<uint64_t>(static_cast<int64_t>(value));
+      } else if constexpr (std::is_floating_point_v<A>) {
+        kind = TraceArgument::real;
+        return std::bit_cast<uint64_t>(static_cast<double>(value));
+      } else if constexpr (requires { std::size(value); }) {
+        kind = TraceArgument::size;
+        return std::size(value);
+      } else {
+        kind = TraceArgument::none;
+        return 0;
+      }
+    }
+
+    /**
+     * @brief Record event into calling thread ring buffer.
+     * @param category trace category.
+     * @param event trace event.
+     * @param object address of traced object.
+     * @param value argument of traced operation.
+     */
+    template <class A = std::nullptr_t>
+    static void record(TraceCategory category, TraceEvent event,
+        const void* object, const A& value = nullptr) {
+      TraceRecord record{};
+      record.timestamp = static_cast<uint64_t>(
+          std::chrono::steady_clock::now().time_since_epoch().count()
+      );
+      record.object = reinterpret_cast<uintptr_t>(object);
+      record.argument = argument(value, record.kind);
+      record.category = category;
+      record.event = event;
+      Trace::local().push(record);
+    }
+
+    /**
+     * @brief Drain all buffers into out, ordered by timestamp.
+     * @param out destination vector.
+     * @return uint64_t represent number of dropped records so far.
+     */
+    static uint64_t drain(std::vector<TraceRecord>& out) {
+      Registry& registry = Trace::registry();
+      std::lock_guard<std::mutex> lock{registry.mutex};
+      uint64_t dropped{0};
+      size_t first = out.size();
+      for (auto& buffer : registry.buffers) {
+        buffer->drain(out);
+        dropped += buffer->get_dropped();
+      }
+      std::erase_if(registry.buffers, [](const auto& buffer) {
+        return buffer->is_released();
+      });
+      std::stable_sort(out.begin() + first, out.end(),
+          [](const TraceRecord& left, const TraceRecord& right) {
+            return left.timestamp < right.timestamp;
+          });
+      return dropped;
+    }
+
+    /**
+     * @brief Drain all buffers and append records to binary dump file,
+     *        dump is decoded offline by sqlitecxx-trace.
+     * @param path path of dump file.
+     * @return bool true on success else false.
+     */
+    static bool dump(std::string path) {
+      std::vector<TraceRecord> records;
+      Trace::drain(records);
+      std::ifstream existing{path, std::ios::binary};
+      bool has_header = existing.good() && existing.peek() != EOF;
+      std::ofstream file{path, std::ios::binary | std::ios::app};
+      if (!file) {
+        return false;
+      }
+      if (!has_header) {
+        uint32_t header[2] = {1, sizeof(TraceRecord)};
+        file.write("SQLCXXTR", 8);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+      }
+      file.write(
+          reinterpret_cast<const char*>(records.data()),
+          records.size() * sizeof(TraceRecord)
+      );
+      return file.good();
+    }
+
+    /**
+     * @brief Format record as human readable line.
+     * @param record const reference to TraceRecord.
+     * @return std::string represent formatted record.
+     */
+    static std::string format(const TraceRecord& record) {
+      static const char* categories[] = {
+        "sqlitecxx::base::", "sqlitecxx::integer::", "sqlitecxx::real::",
+        "sqlitecxx::text::", "sqlitecxx::blob::", "sqlitecxx::column::",
+        "sqlitecxx::database::"
+      };
+      static const char* events[] = {
+        "user defined cstor", "copy cstor", "default dstor", "get", "set",
+        "get_name", "set_name", "get_type", "set_type", "get_primary_key",
+        "set_primary_key", "operator=", "operator++ prefix",
+        "operator-- prefix", "operator++ postfix", "operator-- postfix",
+        "operator+", "operator-", "operator*", "operator/", "operator!=",
+        "operator==", "operator>=", "operator<=", "operator>", "operator<",
+        "open", "close"
+      };
+      std::ostringstream line;
+      line << record.timestamp << " [" << record.thread << "] ";
+      size_t category = static_cast<size_t>(record.category);
+      size_t event = static_cast<size_t>(record.event);
+      line << (category < std::size(categories) ? categories[category] : "?::");
+      line << (event < std::size(events) ? events[event] : "?");
+      switch (record.kind) {
+        case TraceArgument::integer:
+          line << " arg : " << static_cast<int64_t>(record.argument);
+          break;
+        case TraceArgument::real:
+          line << " arg : " << std::bit_cast<double>(record.argument);
+          break;
+        case TraceArgument::size:
+          line << " size : " << record.argument;
+          break;
+        case TraceArgument::none:
+          break;
+      }
+      line << " at 0x" << std::hex << record.object;
+      return line.str();
+    }
+};
+
+/**
+ * @brief Enabled categories, initialized from SQLITECXX_TRACE environment.
+ */
+inline std::atomic<uint32_t> Trace::mask{Trace::from_environment()};
+
+/**
+ * @brief Trace point, compiled out when SQLITECXX_TRACING is 0.
+ */
+#if SQLITECXX_TRACING
+#define SQLITECXX_TRACE(category, event, ...) \
+  do { \
+    if (Trace::enabled(TraceCategory::category)) { \
+      Trace::record(TraceCategory::category, TraceEvent::event, __VA_ARGS__); \
+    } \
+  } while (0)
+#else
+#define SQLITECXX_TRACE(category, event, ...) do { } while (0)
+#endif
+
+#endif
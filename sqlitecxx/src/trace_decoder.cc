@@ -0,0 +1,55 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * trace_decoder.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "trace.h"
+
+/**
+ * @brief Decode binary trace dump written by Trace::dump().
+ * 
+ * @param argc number of arguments
+ * @param argv path of dump file
+ * @return int 0 on success
+ */
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage : sqlitecxx-trace <dump file>" << std::endl;
+        return (1);
+    }
+    std::ifstream file{argv[1], std::ios::binary};
+    char magic[8];
+    uint32_t header[2];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || std::memcmp(magic, "SQLCXXTR", sizeof(magic)) != 0) {
+        std::cerr << "Error Trace Dump : bad header" << std::endl;
+        return (1);
+    }
+    if (header[0] != 1 || header[1] != sizeof(TraceRecord)) {
+        std::cerr << "Error Trace Dump : unsupported version" << std::endl;
+        return (1);
+    }
+    TraceRecord record{};
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        std::cout << Trace::format(record) << '\n';
+    }
+    return (0);
+}
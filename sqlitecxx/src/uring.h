@@ -0,0 +1,947 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * uring.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef URING_H
+#define URING_H
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <sqlite3.h>
+
+/**
+ * @brief Name of io_uring VFS.
+ */
+#define SQLITECXX_URING_VFS "sqlitecxx-uring"
+
+/**
+ * @brief Name of VFS wrapped by io_uring VFS.
+ */
+#define SQLITECXX_URING_BASE_VFS "unix"
+
+/**
+ * @brief Alignment of I/O buffers (O_DIRECT friendly).
+ */
+#define SQLITECXX_URING_ALIGNMENT 4096
+
+/**
+ * @brief UringOptions. Behaviour of io_uring VFS.
+ */
+struct UringOptions {
+  unsigned depth{64};        /* ring entries of each thread */
+  unsigned batch{32};        /* database writes queued before submission */
+  unsigned readahead{16};    /* pages read ahead by sequential scans, 0 disables */
+  bool direct{false};        /* O_DIRECT on main database files */
+};
+
+/**
+ * @brief UringStats. Counters of io_uring VFS since install().
+ */
+struct UringStats {
+  uint64_t submissions{0};   /* io_uring_enter() batches */
+  uint64_t reads{0};         /* read operations */
+  uint64_t writes{0};        /* write operations */
+  uint64_t syncs{0};         /* fsync operations */
+  uint64_t readahead_hits{0};/* reads served from read-ahead buffer */
+  uint64_t files{0};         /* opened files driven through io_uring */
+  uint64_t passthrough{0};   /* opened files passed through to unix VFS */
+};
+
+/**
+ * @brief Uring. Minimal io_uring instance on raw system calls, every
+ *        batch of operations is submitted and waited for at once.
+ */
+class Uring final {
+
+  int descriptor{-1};
+  void* sq_mapping{MAP_FAILED};
+  size_t sq_size{0};
+  void* cq_mapping{MAP_FAILED};
+  size_t cq_size{0};
+  io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+  size_t sqes_size{0};
+  unsigned* sq_head{nullptr};
+  unsigned* sq_tail{nullptr};
+  unsigned* sq_array{nullptr};
+  unsigned sq_mask{0};
+  unsigned sq_entries{0};
+  unsigned* cq_head{nullptr};
+  unsigned* cq_tail{nullptr};
+  io_uring_cqe* cqes{nullptr};
+  unsigned cq_mask{0};
+  unsigned cq_entries{0};
+
+  void release() {
+    if (this->sqes != MAP_FAILED) {
+      ::munmap(this->sqes, this->sqes_size);
+    }
+    if (this->cq_mapping != MAP_FAILED && this->cq_mapping != this->sq_mapping) {
+      ::munmap(this->cq_mapping, this->cq_size);
+    }
+    if (this->sq_mapping != MAP_FAILED) {
+      ::munmap(this->sq_mapping, this->sq_size);
+    }
+    if (this->descriptor >= 0) {
+      ::close(this->descriptor);
+    }
+    this->descriptor = -1;
+  }
+
+  void* map(size_t size, off_t offset) {
+    return ::mmap(
+        nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        this->descriptor, offset
+    );
+  }
+
+  public:
+    /**
+     * @brief Operation. One read, write or fsync of batch.
+     */
+    struct Operation {
+      uint8_t opcode;          /* IORING_OP_READV | IORING_OP_WRITEV | IORING_OP_FSYNC */
+      int descriptor;
+      iovec vector;
+      uint64_t offset;
+      uint32_t flags;          /* fsync flags */
+      int result;              /* bytes or -errno */
+    };
+
+    /**
+     * @brief Construct a new Uring object, is_valid() is false when
+     *        kernel refuses io_uring (old kernel, seccomp, limits).
+     * @param entries submission queue entries.
+     */
+    explicit Uring(unsigned entries) {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+      this->descriptor = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+      if (this->descriptor < 0) {
+        return;
+      }
+      this->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      this->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+      if (single) {
+        this->sq_size = this->cq_size = std::max(this->sq_size, this->cq_size);
+      }
+      this->sq_mapping = this->map(this->sq_size, IORING_OFF_SQ_RING);
+      this->cq_mapping = single ? this->sq_mapping : this->map(this->cq_size, IORING_OFF_CQ_RING);
+      this->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+      this->sqes = static_cast<io_uring_sqe*>(this->map(this->sqes_size, IORING_OFF_SQES));
+      if (this->sq_mapping == MAP_FAILED || this->cq_mapping == MAP_FAILED ||
+          this->sqes == MAP_FAILED) {
+        this->release();
+        return;
+      }
+      char* sq = static_cast<char*>(this->sq_mapping);
+      char* cq = static_cast<char*>(this->cq_mapping);
+      this->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+      this->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      this->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+      this->sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      this->sq_entries = params.sq_entries;
+      this->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      this->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      this->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+      this->cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      this->cq_entries = params.cq_entries;
+    }
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    /**
+     * @brief Destructor for Uring object, closes ring.
+     */
+    ~Uring() {
+      this->release();
+    }
+
+    /**
+     * @brief Check whether ring is usable.
+     * @return bool true when ring was set up.
+     */
+    bool is_valid() const {
+      return this->descriptor >= 0;
+    }
+
+    /**
+     * @brief Submit operations (in ring sized batches) and wait for all.
+     * @param operations operations, result is filled in.
+     * @param count number of operations.
+     * @return int number of io_uring_enter() calls or -errno.
+     */
+    int run(Operation* operations, size_t count) {
+      size_t submitted{0};
+      size_t completed{0};
+      int enters{0};
+      while (completed < count) {
+        unsigned tail = *this->sq_tail;
+        unsigned head = __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE);
+        while (submitted < count && tail - head < this->sq_entries &&
+            submitted - completed < this->cq_entries) {
+          Operation& operation = operations[submitted];
+          unsigned index = tail & this->sq_mask;
+          io_uring_sqe* sqe = &this->sqes[index];
+          std::memset(sqe, 0, sizeof(*sqe));
+          sqe->opcode = operation.opcode;
+          sqe->fd = operation.descriptor;
+          sqe->off = operation.offset;
+          if (operation.opcode == IORING_OP_FSYNC) {
+            sqe->fsync_flags = operation.flags;
+          } else {
+            sqe->addr = reinterpret_cast<uint64_t>(&operation.vector);
+            sqe->len = 1;
+          }
+          sqe->user_data = submitted++;
+          this->sq_array[index] = index;
+          ++tail;
+        }
+        __atomic_store_n(this->sq_tail, tail, __ATOMIC_RELEASE);
+        unsigned pending = tail - __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE);
+        if (::syscall(__NR_io_uring_enter, this->descriptor, pending, 1,
+            IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+          if (errno == EINTR || errno == EAGAIN) {
+            continue;
+          }
+          return -errno;
+        }
+        ++enters;
+        head = *this->cq_head;
+        while (head != __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)) {
+          io_uring_cqe* cqe = &this->cqes[head & this->cq_mask];
+          operations[cqe->user_data].result = cqe->res;
+          ++completed;
+          ++head;
+        }
+        __atomic_store_n(this->cq_head, head, __ATOMIC_RELEASE);
+      }
+      return enters;
+    }
+};
+
+/**
+ * @brief UringVfs. VFS shim over unix VFS which performs reads, writes
+ *        and syncs through per-thread io_uring, locking, shared memory and
+ *        file management stay in unix VFS. Writes to main database files
+ *        are copied into aligned buffers and submitted in batches (flushed
+ *        before sync, lock changes, shared memory locks and any other file
+ *        call), journal and WAL writes complete before xWrite returns so
+ *        they always reach file before database writes they protect.
+ *        Sequential page reads trigger batched read-ahead. With O_DIRECT
+ *        transfers not aligned to sectors go through aligned bounce buffer
+ *        (such writes are not batched). Files whose descriptor cannot be
+ *        verified are passed through to unix VFS.
+ */
+class UringVfs final {
+
+  struct Buffer {
+    void* data{nullptr};
+    size_t size{0};
+
+    Buffer() = default;
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    Buffer(Buffer&& source) noexcept : data{source.data}, size{source.size} {
+      source.data = nullptr;
+      source.size = 0;
+    }
+
+    ~Buffer() {
+      std::free(this->data);
+    }
+
+    bool reserve(size_t size) {
+      if (size <= this->size) {
+        return true;
+      }
+      size_t rounded = (size + SQLITECXX_URING_ALIGNMENT - 1) /
+          SQLITECXX_URING_ALIGNMENT * SQLITECXX_URING_ALIGNMENT;
+      void* data = std::aligned_alloc(SQLITECXX_URING_ALIGNMENT, rounded);
+      if (!data) {
+        return false;
+      }
+      std::free(this->data);
+      this->data = data;
+      this->size = rounded;
+      return true;
+    }
+  };
+
+  struct Write {
+    Buffer buffer;
+    size_t amount;
+    uint64_t offset;
+  };
+
+  /**
+   * @brief Open file, unix file follows it in memory given by SQLite.
+   */
+  struct File {
+    sqlite3_file base;
+    sqlite3_file* real;
+    int descriptor{-1};
+    bool batched{false};
+    bool direct{false};
+    bool dirsync{false};
+    size_t alignment{512};
+    size_t memory_alignment{512};
+    std::string directory;
+    std::vector<Write> writes;
+    Buffer ahead;
+    Buffer bounce;
+    uint64_t ahead_offset{0};
+    size_t ahead_size{0};
+    uint64_t last_end{0};
+    unsigned streak{0};
+  };
+
+  static sqlite3_vfs* base_vfs;
+  static sqlite3_vfs vfs;
+  static UringOptions options;
+  static std::atomic<uint64_t> counters[7];
+
+  static size_t file_size() {
+    return (sizeof(File) + 15) / 16 * 16;
+  }
+
+  /**
+   * @brief Ring of calling thread, nullptr when ring can't be created.
+   */
+  static Uring* ring() {
+    static thread_local std::unique_ptr<Uring> local{};
+    static thread_local bool failed{false};
+    if (!local && !failed) {
+      local = std::make_unique<Uring>(options.depth);
+      if (!local->is_valid()) {
+        local.reset();
+        failed = true;
+      }
+    }
+    return local.get();
+  }
+
+  static int run(Uring::Operation* operations, size_t count) {
+    Uring* uring = ring();
+    if (!uring) {
+      return -ENOSYS;
+    }
+    int enters = uring->run(operations, count);
+    if (enters > 0) {
+      counters[0] += static_cast<uint64_t>(enters);
+    }
+    return enters;
+  }
+
+  /**
+   * @brief Descriptor of unix file (third pointer is followed by int h in
+   *        unixFile), trusted only when it is same file as path. unixFile
+   *        is private to os_unix.c and its layout may change in any SQLite
+   *        release, the stat check then makes file pass through to unix
+   *        VFS instead of using wrong descriptor.
+   */
+  static int descriptor(sqlite3_file* real, const char* path) {
+    if (!path || !real->pMethods) {
+      return -1;
+    }
+    int candidate;
+    std::memcpy(&candidate, reinterpret_cast<char*>(real) + 3 * sizeof(void*), sizeof(candidate));
+    struct stat opened;
+    struct stat named;
+    if (candidate < 0 || ::fstat(candidate, &opened) != 0 || ::stat(path, &named) != 0 ||
+        opened.st_dev != named.st_dev || opened.st_ino != named.st_ino) {
+      return -1;
+    }
+    return candidate;
+  }
+
+  static bool aligned(const File& file, const void* buffer, size_t amount, uint64_t offset) {
+    return reinterpret_cast<uintptr_t>(buffer) % file.memory_alignment == 0 &&
+        amount % file.alignment == 0 && offset % file.alignment == 0;
+  }
+
+  /**
+   * @brief Query O_DIRECT alignment of file, statx() reports it on Linux
+   *        6.1 and later, else preferred block size is assumed.
+   * @return bool false when file does not support O_DIRECT or needs
+   *         buffers aligned beyond SQLITECXX_URING_ALIGNMENT.
+   */
+  static bool direct_alignment(File& file) {
+#ifdef STATX_DIOALIGN
+    struct statx extended;
+    if (::statx(file.descriptor, "", AT_EMPTY_PATH, STATX_DIOALIGN, &extended) == 0 &&
+        (extended.stx_mask & STATX_DIOALIGN)) {
+      file.alignment = extended.stx_dio_offset_align;
+      file.memory_alignment = extended.stx_dio_mem_align;
+      return file.alignment && file.memory_alignment &&
+          file.memory_alignment <= SQLITECXX_URING_ALIGNMENT;
+    }
+#endif
+    struct stat info;
+    if (::fstat(file.descriptor, &info) == 0 && info.st_blksize > 0) {
+      file.alignment = static_cast<size_t>(info.st_blksize);
+      file.memory_alignment = std::min<size_t>(file.alignment, SQLITECXX_URING_ALIGNMENT);
+    }
+    return true;
+  }
+
+  static void set_direct(File& file, bool enable) {
+    int flags = ::fcntl(file.descriptor, F_GETFL);
+    if (flags >= 0) {
+      ::fcntl(file.descriptor, F_SETFL, enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT));
+    }
+  }
+
+  /**
+   * @brief Read or write whole amount, restarting short transfers.
+   * @return ssize_t bytes transferred (less at end of file) or -errno.
+   */
+  static ssize_t submit(File& file, uint8_t opcode, void* buffer, size_t amount, uint64_t offset) {
+    size_t done{0};
+    ssize_t status{0};
+    while (done < amount) {
+      Uring::Operation operation{
+        opcode, file.descriptor, {static_cast<char*>(buffer) + done, amount - done},
+        offset + done, 0, 0
+      };
+      int enters = run(&operation, 1);
+      if (enters < 0) {
+        status = enters;
+        break;
+      }
+      counters[opcode == IORING_OP_READV ? 1 : 2]++;
+      if (operation.result == -EINTR || operation.result == -EAGAIN) {
+        continue;
+      }
+      if (operation.result <= 0) {
+        status = operation.result;
+        break;
+      }
+      done += static_cast<size_t>(operation.result);
+    }
+    return status < 0 ? status : static_cast<ssize_t>(done);
+  }
+
+  /**
+   * @brief Unaligned transfer on O_DIRECT file through aligned bounce
+   *        buffer covering whole sectors, partial head and tail sectors
+   *        of write are read first and file growth past written range
+   *        is truncated back.
+   */
+  static ssize_t bounce(File& file, uint8_t opcode, void* buffer, size_t amount, uint64_t offset) {
+    uint64_t start = offset / file.alignment * file.alignment;
+    uint64_t end = (offset + amount + file.alignment - 1) / file.alignment * file.alignment;
+    size_t span = static_cast<size_t>(end - start);
+    size_t head = static_cast<size_t>(offset - start);
+    if (!file.bounce.reserve(span)) {
+      return -ENOMEM;
+    }
+    char* data = static_cast<char*>(file.bounce.data);
+    if (opcode == IORING_OP_READV || head || (offset + amount) % file.alignment) {
+      ssize_t done = submit(file, IORING_OP_READV, data, span, start);
+      if (done < 0) {
+        return done;
+      }
+      std::memset(data + done, 0, span - static_cast<size_t>(done));
+      if (opcode == IORING_OP_READV) {
+        size_t available = static_cast<size_t>(done) > head ?
+            std::min(amount, static_cast<size_t>(done) - head) : 0;
+        std::memcpy(buffer, data + head, available);
+        return static_cast<ssize_t>(available);
+      }
+    }
+    struct stat info;
+    if (::fstat(file.descriptor, &info) != 0) {
+      return -errno;
+    }
+    std::memcpy(data + head, buffer, amount);
+    ssize_t done = submit(file, IORING_OP_WRITEV, data, span, start);
+    if (done < 0) {
+      return done;
+    }
+    uint64_t size = std::max<uint64_t>(static_cast<uint64_t>(info.st_size), offset + amount);
+    if (end > size && ::ftruncate(file.descriptor, static_cast<off_t>(size)) != 0) {
+      return -errno;
+    }
+    return static_cast<ssize_t>(amount);
+  }
+
+  /**
+   * @brief Read or write whole amount, unaligned transfers on O_DIRECT
+   *        file go through bounce buffer.
+   * @return ssize_t bytes transferred (less at end of file) or -errno.
+   */
+  static ssize_t transfer(File& file, uint8_t opcode, void* buffer, size_t amount, uint64_t offset) {
+    if (file.direct && !aligned(file, buffer, amount, offset)) {
+      return bounce(file, opcode, buffer, amount, offset);
+    }
+    return submit(file, opcode, buffer, amount, offset);
+  }
+
+  static int write_error(int error) {
+    return error == ENOSPC ? SQLITE_FULL : SQLITE_IOERR_WRITE;
+  }
+
+  /**
+   * @brief Submit queued writes as one batch and wait for them.
+   */
+  static int flush(File& file) {
+    if (file.writes.empty()) {
+      return SQLITE_OK;
+    }
+    std::vector<Uring::Operation> operations;
+    operations.reserve(file.writes.size());
+    for (auto& write : file.writes) {
+      operations.push_back({
+        IORING_OP_WRITEV, file.descriptor, {write.buffer.data, write.amount},
+        write.offset, 0, 0
+      });
+    }
+    int enters = run(operations.data(), operations.size());
+    int status{SQLITE_OK};
+    for (size_t index = 0; index < operations.size() && status == SQLITE_OK; ++index) {
+      Write& write = file.writes[index];
+      int result = enters < 0 ? enters : operations[index].result;
+      if (result >= 0 && static_cast<size_t>(result) < write.amount) {
+        ssize_t rest = transfer(
+            file, IORING_OP_WRITEV, static_cast<char*>(write.buffer.data) + result,
+            write.amount - result, write.offset + result
+        );
+        result = rest < 0 ? static_cast<int>(rest) : 0;
+      }
+      if (result < 0) {
+        status = write_error(-result);
+      }
+    }
+    counters[2] += operations.size();
+    file.writes.clear();
+    return status;
+  }
+
+  static void forget_ahead(File& file) {
+    file.ahead_size = 0;
+    file.streak = 0;
+  }
+
+  /**
+   * @brief Read next pages of sequential scan in one batch.
+   */
+  static void read_ahead(File& file, size_t amount, uint64_t offset) {
+    size_t pages = options.readahead;
+    if (!file.ahead.reserve(amount * pages)) {
+      return;
+    }
+    std::vector<Uring::Operation> operations(pages);
+    for (size_t page = 0; page < pages; ++page) {
+      operations[page] = {
+        IORING_OP_READV, file.descriptor,
+        {static_cast<char*>(file.ahead.data) + page * amount, amount},
+        offset + page * amount, 0, 0
+      };
+    }
+    file.ahead_size = 0;
+    if (run(operations.data(), operations.size()) < 0) {
+      return;
+    }
+    counters[1] += pages;
+    file.ahead_offset = offset;
+    for (size_t page = 0; page < pages && operations[page].result == static_cast<int>(amount); ++page) {
+      file.ahead_size += amount;
+    }
+  }
+
+  static File& self(sqlite3_file* file) {
+    return *reinterpret_cast<File*>(file);
+  }
+
+  static int close(sqlite3_file* handle) {
+    File& file = self(handle);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    int closed = file.real->pMethods->xClose(file.real);
+    file.~File();
+    return status != SQLITE_OK ? status : closed;
+  }
+
+  static int read(sqlite3_file* handle, void* buffer, int amount, sqlite3_int64 offset) {
+    File& file = self(handle);
+    if (file.descriptor < 0) {
+      return file.real->pMethods->xRead(file.real, buffer, amount, offset);
+    }
+    size_t size = static_cast<size_t>(amount);
+    uint64_t position = static_cast<uint64_t>(offset);
+    for (const auto& write : file.writes) {
+      if (position < write.offset + write.amount && write.offset < position + size) {
+        int status = flush(file);
+        if (status != SQLITE_OK) {
+          return status;
+        }
+        break;
+      }
+    }
+    file.streak = position == file.last_end ? file.streak + 1 : 0;
+    file.last_end = position + size;
+    if (file.ahead_size && position >= file.ahead_offset &&
+        position + size <= file.ahead_offset + file.ahead_size) {
+      std::memcpy(buffer, static_cast<char*>(file.ahead.data) + (position - file.ahead_offset), size);
+      counters[4]++;
+      return SQLITE_OK;
+    }
+    if (options.readahead > 1 && file.streak >= 2 && size >= 512 && position % size == 0 &&
+        (!file.direct || size % file.alignment == 0)) {
+      read_ahead(file, size, position);
+      if (file.ahead_size >= size) {
+        std::memcpy(buffer, file.ahead.data, size);
+        return SQLITE_OK;
+      }
+    }
+    ssize_t done = transfer(file, IORING_OP_READV, buffer, size, position);
+    if (done < 0) {
+      return done == -ENOSYS ?
+          file.real->pMethods->xRead(file.real, buffer, amount, offset) : SQLITE_IOERR_READ;
+    }
+    if (static_cast<size_t>(done) < size) {
+      std::memset(static_cast<char*>(buffer) + done, 0, size - done);
+      return SQLITE_IOERR_SHORT_READ;
+    }
+    return SQLITE_OK;
+  }
+
+  static int write(sqlite3_file* handle, const void* data, int amount, sqlite3_int64 offset) {
+    File& file = self(handle);
+    if (file.descriptor < 0) {
+      return file.real->pMethods->xWrite(file.real, data, amount, offset);
+    }
+    size_t size = static_cast<size_t>(amount);
+    uint64_t position = static_cast<uint64_t>(offset);
+    forget_ahead(file);
+    bool partial = file.direct && (size % file.alignment || position % file.alignment);
+    if (partial) {
+      int status = flush(file);
+      if (status != SQLITE_OK) {
+        return status;
+      }
+    }
+    if (!file.batched || partial) {
+      ssize_t done = transfer(file, IORING_OP_WRITEV, const_cast<void*>(data), size, position);
+      if (done == -ENOSYS) {
+        return file.real->pMethods->xWrite(file.real, data, amount, offset);
+      }
+      return done < 0 ? write_error(static_cast<int>(-done)) : SQLITE_OK;
+    }
+    for (const auto& write : file.writes) {
+      if (position < write.offset + write.amount && write.offset < position + size) {
+        int status = flush(file);
+        if (status != SQLITE_OK) {
+          return status;
+        }
+        break;
+      }
+    }
+    Write write{Buffer{}, size, position};
+    if (!write.buffer.reserve(size)) {
+      return SQLITE_IOERR_NOMEM;
+    }
+    std::memcpy(write.buffer.data, data, size);
+    file.writes.push_back(std::move(write));
+    return file.writes.size() >= options.batch ? flush(file) : SQLITE_OK;
+  }
+
+  static int truncate(sqlite3_file* handle, sqlite3_int64 size) {
+    File& file = self(handle);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    forget_ahead(file);
+    return status != SQLITE_OK ? status : file.real->pMethods->xTruncate(file.real, size);
+  }
+
+  static int fsync(File& file, int descriptor, int flags) {
+    Uring::Operation operation{
+      IORING_OP_FSYNC, descriptor, {nullptr, 0}, 0,
+      (flags & SQLITE_SYNC_DATAONLY) ? IORING_FSYNC_DATASYNC : 0u, 0
+    };
+    int enters = run(&operation, 1);
+    counters[3]++;
+    if (enters == -ENOSYS) {
+      return file.real->pMethods->xSync(file.real, flags);
+    }
+    return (enters < 0 || operation.result < 0) ? SQLITE_IOERR_FSYNC : SQLITE_OK;
+  }
+
+  /**
+   * @brief Sync file and, after journal or WAL was created, its directory
+   *        (as unix VFS does).
+   */
+  static int sync(sqlite3_file* handle, int flags) {
+    File& file = self(handle);
+    if (file.descriptor < 0) {
+      return file.real->pMethods->xSync(file.real, flags);
+    }
+    int status = flush(file);
+    if (status == SQLITE_OK) {
+      status = fsync(file, file.descriptor, flags);
+    }
+    if (status == SQLITE_OK && file.dirsync) {
+      int directory = ::open(file.directory.c_str(), O_RDONLY | O_CLOEXEC);
+      if (directory >= 0) {
+        fsync(file, directory, 0);
+        ::close(directory);
+      }
+      file.dirsync = false;
+    }
+    return status;
+  }
+
+  static int size(sqlite3_file* handle, sqlite3_int64* size) {
+    File& file = self(handle);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    return status != SQLITE_OK ? status : file.real->pMethods->xFileSize(file.real, size);
+  }
+
+  static int lock(sqlite3_file* handle, int level) {
+    File& file = self(handle);
+    forget_ahead(file);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    return status != SQLITE_OK ? status : file.real->pMethods->xLock(file.real, level);
+  }
+
+  static int unlock(sqlite3_file* handle, int level) {
+    File& file = self(handle);
+    forget_ahead(file);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    return status != SQLITE_OK ? status : file.real->pMethods->xUnlock(file.real, level);
+  }
+
+  static int reserved(sqlite3_file* handle, int* result) {
+    File& file = self(handle);
+    return file.real->pMethods->xCheckReservedLock(file.real, result);
+  }
+
+  static int control(sqlite3_file* handle, int operation, void* argument) {
+    File& file = self(handle);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    if (operation == SQLITE_FCNTL_VFSNAME && status == SQLITE_OK) {
+      int result = file.real->pMethods->xFileControl(file.real, operation, argument);
+      if (result == SQLITE_OK) {
+        char** name = static_cast<char**>(argument);
+        *name = sqlite3_mprintf("%s/%z", SQLITECXX_URING_VFS, *name);
+      }
+      return result;
+    }
+    return status != SQLITE_OK ? status : file.real->pMethods->xFileControl(file.real, operation, argument);
+  }
+
+  static int sector_size(sqlite3_file* handle) {
+    File& file = self(handle);
+    return file.real->pMethods->xSectorSize(file.real);
+  }
+
+  static int characteristics(sqlite3_file* handle) {
+    File& file = self(handle);
+    return file.real->pMethods->xDeviceCharacteristics(file.real);
+  }
+
+  static int shm_map(sqlite3_file* handle, int region, int size, int extend, void volatile** memory) {
+    File& file = self(handle);
+    return file.real->pMethods->xShmMap(file.real, region, size, extend, memory);
+  }
+
+  static int shm_lock(sqlite3_file* handle, int offset, int count, int flags) {
+    File& file = self(handle);
+    forget_ahead(file);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    return status != SQLITE_OK ? status : file.real->pMethods->xShmLock(file.real, offset, count, flags);
+  }
+
+  static void shm_barrier(sqlite3_file* handle) {
+    File& file = self(handle);
+    if (file.descriptor >= 0) {
+      flush(file);
+    }
+    file.real->pMethods->xShmBarrier(file.real);
+  }
+
+  static int shm_unmap(sqlite3_file* handle, int remove) {
+    File& file = self(handle);
+    return file.real->pMethods->xShmUnmap(file.real, remove);
+  }
+
+  static int fetch(sqlite3_file* handle, sqlite3_int64 offset, int amount, void** pointer) {
+    File& file = self(handle);
+    int status = file.descriptor >= 0 ? flush(file) : SQLITE_OK;
+    if (status != SQLITE_OK) {
+      *pointer = nullptr;
+      return status;
+    }
+    return file.real->pMethods->xFetch(file.real, offset, amount, pointer);
+  }
+
+  static int unfetch(sqlite3_file* handle, sqlite3_int64 offset, void* pointer) {
+    File& file = self(handle);
+    return file.real->pMethods->xUnfetch(file.real, offset, pointer);
+  }
+
+  static const sqlite3_io_methods* methods() {
+    static const sqlite3_io_methods io = [] {
+      sqlite3_io_methods io{};
+      io.iVersion = 3;
+      io.xClose = &close;
+      io.xRead = &read;
+      io.xWrite = &write;
+      io.xTruncate = &truncate;
+      io.xSync = &sync;
+      io.xFileSize = &size;
+      io.xLock = &lock;
+      io.xUnlock = &unlock;
+      io.xCheckReservedLock = &reserved;
+      io.xFileControl = &control;
+      io.xSectorSize = &sector_size;
+      io.xDeviceCharacteristics = &characteristics;
+      io.xShmMap = &shm_map;
+      io.xShmLock = &shm_lock;
+      io.xShmBarrier = &shm_barrier;
+      io.xShmUnmap = &shm_unmap;
+      io.xFetch = &fetch;
+      io.xUnfetch = &unfetch;
+      return io;
+    }();
+    return &io;
+  }
+
+  static int open(sqlite3_vfs*, const char* name, sqlite3_file* handle, int flags, int* out) {
+    File* file = new (handle) File{};
+    file->real = reinterpret_cast<sqlite3_file*>(reinterpret_cast<char*>(handle) + file_size());
+    int status = base_vfs->xOpen(base_vfs, name, file->real, flags, out);
+    if (status != SQLITE_OK || !file->real->pMethods) {
+      file->~File();
+      handle->pMethods = nullptr;
+      return status;
+    }
+    file->base.pMethods = methods();
+    file->descriptor = descriptor(file->real, name);
+    if (file->descriptor < 0) {
+      counters[6]++;
+      return SQLITE_OK;
+    }
+    counters[5]++;
+    file->batched = flags & SQLITE_OPEN_MAIN_DB;
+    if (file->batched && options.direct && direct_alignment(*file)) {
+      set_direct(*file, true);
+      int current = ::fcntl(file->descriptor, F_GETFL);
+      file->direct = current >= 0 && (current & O_DIRECT);
+    }
+    if ((flags & SQLITE_OPEN_CREATE) && (flags & (SQLITE_OPEN_MAIN_JOURNAL |
+        SQLITE_OPEN_SUPER_JOURNAL | SQLITE_OPEN_WAL))) {
+      std::string path{name};
+      size_t slash = path.find_last_of('/');
+      file->directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+      file->dirsync = true;
+    }
+    return SQLITE_OK;
+  }
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    UringVfs() = delete;
+
+    /**
+     * @brief Register io_uring VFS, nothing is registered (and unix VFS
+     *        stays in use) when io_uring is unavailable.
+     * @param uring options of VFS.
+     * @param make_default use VFS for connections opened without VFS name.
+     * @return bool true when VFS is registered.
+     */
+    static bool install(UringOptions uring = {}, bool make_default = true) {
+      static std::mutex mutex;
+      std::lock_guard<std::mutex> lock{mutex};
+      if (base_vfs) {
+        options = uring;
+        return sqlite3_vfs_register(&vfs, make_default) == SQLITE_OK;
+      }
+      sqlite3_vfs* base = sqlite3_vfs_find(SQLITECXX_URING_BASE_VFS);
+      if (!base || !Uring{uring.depth}.is_valid()) {
+        return false;
+      }
+      options = uring;
+      options.depth = std::max(1u, options.depth);
+      options.batch = std::max(1u, options.batch);
+      base_vfs = base;
+      vfs = *base;
+      vfs.szOsFile = static_cast<int>(file_size()) + base->szOsFile;
+      vfs.zName = SQLITECXX_URING_VFS;
+      vfs.pNext = nullptr;
+      vfs.pAppData = nullptr;
+      vfs.xOpen = &open;
+      return sqlite3_vfs_register(&vfs, make_default) == SQLITE_OK;
+    }
+
+    /**
+     * @brief Unregister io_uring VFS, unix VFS becomes default again,
+     *        connections using it must be closed.
+     */
+    static void uninstall() {
+      if (base_vfs) {
+        sqlite3_vfs_unregister(&vfs);
+        sqlite3_vfs_register(base_vfs, 1);
+      }
+    }
+
+    /**
+     * @brief Check whether VFS is registered.
+     * @return bool true when io_uring VFS is registered.
+     */
+    static bool is_installed() {
+      return base_vfs && sqlite3_vfs_find(SQLITECXX_URING_VFS) == &vfs;
+    }
+
+    /**
+     * @brief Copy of VFS counters.
+     * @return UringStats represent counters.
+     */
+    static UringStats stats() {
+      return {
+        counters[0], counters[1], counters[2], counters[3], counters[4],
+        counters[5], counters[6]
+      };
+    }
+};
+
+inline sqlite3_vfs* UringVfs::base_vfs{nullptr};
+inline sqlite3_vfs UringVfs::vfs{};
+inline UringOptions UringVfs::options{};
+inline std::atomic<uint64_t> UringVfs::counters[7]{};
+
+#endif
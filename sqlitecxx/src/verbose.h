@@ -1,29 +0,0 @@
-/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
-/*
- * verbose.h
- * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
- *
- * sqlitecxx is free software: you can redistribute it and/or modify it
- * under the terms of the GNU General Public License as published by the
- * Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * sqlitecxx is distributed in the hope that it will be useful, but
- * WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
- * See the GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License along
- * with this program. If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef VERBOSE_H
-#define VERBOSE_H
-
-/**
- * @brief MACROS for enabling/disabling verbose option.
- */
-#define SQLITECXX_VERBOSE 0
-#define SQLITECXX_VERBOSE_ENABLED  1
-
-#endif
@@ -0,0 +1,521 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * vtable.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VTABLE_H
+#define VTABLE_H
+
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <sqlite3.h>
+#include "column.h"
+#include "datatypes.h"
+
+/**
+ * @brief ColumnTable. Eponymous virtual table over in-memory Column<T>
+ *        objects, SELECT FROM name reads values straight from column
+ *        storage (text and blob results are not copied). Rowid is position
+ *        of row in list order. Rowid constraints are answered by direct
+ *        access, constraints on columns are checked on cursor before row
+ *        reaches SQLite (SQLite still re-checks them, so comparisons with
+ *        other types or collations stay correct). Columns must not change
+ *        while a statement reads them, row pointers are rebuilt when
+ *        cursor is opened (once per statement, not per xFilter of inner
+ *        side of join), because erase followed by insert keeps number of
+ *        rows but frees nodes.
+ */
+class ColumnTable final {
+
+  /**
+   * @brief Type erased access to one column.
+   */
+  struct Accessor {
+    virtual ~Accessor() = default;
+    virtual size_t size() const = 0;
+    virtual size_t refresh() = 0;
+    virtual void result(sqlite3_context* context, size_t row) const = 0;
+    virtual bool match(size_t row, int op, sqlite3_value* value) const = 0;
+  };
+
+  template <class T>
+  struct Values final : Accessor {
+    Column<T>& column;
+    std::vector<const T*> rows;
+
+    explicit Values(Column<T>& column) : column{column} {}
+
+    size_t size() const override {
+      return this->column.get_data().size();
+    }
+
+    size_t refresh() override {
+      this->rows.clear();
+      this->rows.reserve(this->column.get_data().size());
+      for (const auto& value : this->column.get_data()) {
+        this->rows.push_back(&value);
+      }
+      return this->rows.size();
+    }
+
+    void result(sqlite3_context* context, size_t row) const override {
+      ColumnTable::result(context, *this->rows[row]);
+    }
+
+    bool match(size_t row, int op, sqlite3_value* value) const override {
+      return ColumnTable::match(*this->rows[row], op, value);
+    }
+  };
+
+  /**
+   * @brief Module client data, owned by connection.
+   */
+  struct Source {
+    std::string schema;
+    std::vector<std::unique_ptr<Accessor>> columns;
+    size_t rows{0};
+
+    size_t size() const {
+      size_t rows = this->columns.empty() ? 0 : SIZE_MAX;
+      for (const auto& column : this->columns) {
+        rows = std::min(rows, column->size());
+      }
+      return rows;
+    }
+
+    size_t refresh() {
+      ColumnTable::refreshes.fetch_add(1, std::memory_order_relaxed);
+      this->rows = this->columns.empty() ? 0 : SIZE_MAX;
+      for (auto& column : this->columns) {
+        this->rows = std::min(this->rows, column->refresh());
+      }
+      return this->rows;
+    }
+  };
+
+  struct Table : sqlite3_vtab {
+    Source* source;
+  };
+
+  struct Filter {
+    size_t column;
+    int op;
+    sqlite3_value* value;
+  };
+
+  struct Cursor : sqlite3_vtab_cursor {
+    Source* source;
+    size_t row{0};
+    size_t end{0};
+    std::vector<Filter> filters;
+
+    void clear() {
+      for (auto& filter : this->filters) {
+        sqlite3_value_free(filter.value);
+      }
+      this->filters.clear();
+    }
+
+    bool matches() const {
+      for (const auto& filter : this->filters) {
+        if (!this->source->columns[filter.column]->match(this->row, filter.op, filter.value)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void skip() {
+      while (this->row < this->end && !this->matches()) {
+        ++(this->row);
+      }
+    }
+  };
+
+  template <class T>
+  static void result(sqlite3_context* context, const Integer<T>& value) {
+    sqlite3_result_int64(context, static_cast<sqlite3_int64>(value.get()));
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Real<T>& value) {
+    sqlite3_result_double(context, static_cast<double>(value.get()));
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Text<T>& value) {
+    sqlite3_result_text64(
+        context, std::data(value.get()), std::size(value.get()), SQLITE_STATIC, SQLITE_UTF8
+    );
+  }
+
+  template <class T>
+  static void result(sqlite3_context* context, const Blob<T>& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      sqlite3_result_blob64(context, &value.get(), sizeof(T), SQLITE_STATIC);
+    } else {
+      sqlite3_result_blob64(
+          context, std::data(value.get()),
+          std::size(value.get()) * sizeof(*std::data(value.get())), SQLITE_STATIC
+      );
+    }
+  }
+
+  static bool test(int order, int op) {
+    switch (op) {
+      case SQLITE_INDEX_CONSTRAINT_EQ:
+        return order == 0;
+      case SQLITE_INDEX_CONSTRAINT_NE:
+        return order != 0;
+      case SQLITE_INDEX_CONSTRAINT_GT:
+        return order > 0;
+      case SQLITE_INDEX_CONSTRAINT_GE:
+        return order >= 0;
+      case SQLITE_INDEX_CONSTRAINT_LT:
+        return order < 0;
+      case SQLITE_INDEX_CONSTRAINT_LE:
+        return order <= 0;
+      default:
+        return true;
+    }
+  }
+
+  template <class V>
+  static int order(V first, V second) {
+    return (first > second) - (first < second);
+  }
+
+  static int order(const void* first, size_t first_size, const void* second, size_t second_size) {
+    int order = std::memcmp(first, second, std::min(first_size, second_size));
+    return order ? order : ColumnTable::order(first_size, second_size);
+  }
+
+  /**
+   * @brief Compare numeric column with numeric constraint value, other
+   *        value types are left to SQLite.
+   */
+  template <class V>
+  static bool numeric(V payload, int op, sqlite3_value* value) {
+    switch (sqlite3_value_type(value)) {
+      case SQLITE_INTEGER:
+        if constexpr (std::is_integral_v<V>) {
+          return test(order<int64_t>(payload, sqlite3_value_int64(value)), op);
+        }
+        [[fallthrough]];
+      case SQLITE_FLOAT:
+        return test(order<double>(payload, sqlite3_value_double(value)), op);
+      default:
+        return true;
+    }
+  }
+
+  template <class T>
+  static bool match(const Integer<T>& value, int op, sqlite3_value* constraint) {
+    return numeric(value.get(), op, constraint);
+  }
+
+  template <class T>
+  static bool match(const Real<T>& value, int op, sqlite3_value* constraint) {
+    return numeric(value.get(), op, constraint);
+  }
+
+  template <class T>
+  static bool match(const Text<T>& value, int op, sqlite3_value* constraint) {
+    if (sqlite3_value_type(constraint) != SQLITE_TEXT) {
+      return true;
+    }
+    const void* text = sqlite3_value_text(constraint);
+    return test(order(
+        std::data(value.get()), std::size(value.get()),
+        text, static_cast<size_t>(sqlite3_value_bytes(constraint))
+    ), op);
+  }
+
+  template <class T>
+  static bool match(const Blob<T>&, int, sqlite3_value*) {
+    return true;
+  }
+
+  static std::string identifier(const std::string& name) {
+    std::string quoted{"\""};
+    for (char character : name) {
+      quoted += character;
+      if (character == '"') {
+        quoted += '"';
+      }
+    }
+    return quoted + "\"";
+  }
+
+  static int connect(
+      sqlite3* db, void* data, int, const char* const*, sqlite3_vtab** vtab, char**
+  ) {
+    Source* source = static_cast<Source*>(data);
+    int status = sqlite3_declare_vtab(db, source->schema.c_str());
+    if (status != SQLITE_OK) {
+      return status;
+    }
+    sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+    Table* table = new Table{};
+    table->source = source;
+    *vtab = table;
+    return SQLITE_OK;
+  }
+
+  static int disconnect(sqlite3_vtab* vtab) {
+    delete static_cast<Table*>(vtab);
+    return SQLITE_OK;
+  }
+
+  static bool rowid_op(int op) {
+    return op == SQLITE_INDEX_CONSTRAINT_EQ || op == SQLITE_INDEX_CONSTRAINT_GT ||
+        op == SQLITE_INDEX_CONSTRAINT_GE || op == SQLITE_INDEX_CONSTRAINT_LT ||
+        op == SQLITE_INDEX_CONSTRAINT_LE;
+  }
+
+  /**
+   * @brief Plan is list of "column op" pairs in argv order (column -1 is
+   *        rowid), cost is rows visited.
+   */
+  static int best_index(sqlite3_vtab* vtab, sqlite3_index_info* info) {
+    Source* source = static_cast<Table*>(vtab)->source;
+    double rows = static_cast<double>(std::max<size_t>(1, source->size()));
+    double visited{rows};
+    double returned{rows};
+    bool unique{false};
+    std::string plan;
+    int argument{0};
+    for (int index = 0; index < info->nConstraint; ++index) {
+      const auto& constraint = info->aConstraint[index];
+      int op = constraint.op;
+      if (!constraint.usable) {
+        continue;
+      }
+      if (constraint.iColumn < 0) {
+        if (!rowid_op(op)) {
+          continue;
+        }
+        info->aConstraintUsage[index].omit = 1;
+        if (op == SQLITE_INDEX_CONSTRAINT_EQ) {
+          unique = true;
+        } else {
+          visited /= 4.0;
+        }
+      } else {
+        const char* collation = sqlite3_vtab_collation(info, index);
+        if ((!rowid_op(op) && op != SQLITE_INDEX_CONSTRAINT_NE) ||
+            (collation && sqlite3_stricmp(collation, "BINARY") != 0)) {
+          continue;
+        }
+        returned /= op == SQLITE_INDEX_CONSTRAINT_EQ ? 10.0 : 3.0;
+      }
+      info->aConstraintUsage[index].argvIndex = ++argument;
+      plan += std::to_string(constraint.iColumn) + " " + std::to_string(op) + " ";
+    }
+    if (unique) {
+      visited = 1.0;
+      info->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+    }
+    info->estimatedCost = visited;
+    info->estimatedRows = static_cast<sqlite3_int64>(std::max(1.0, std::min(visited, returned)));
+    if (info->nOrderBy == 1 && info->aOrderBy[0].iColumn < 0 && !info->aOrderBy[0].desc) {
+      info->orderByConsumed = 1;
+    }
+    if (!plan.empty()) {
+      info->idxStr = sqlite3_mprintf("%s", plan.c_str());
+      info->needToFreeIdxStr = 1;
+    }
+    return SQLITE_OK;
+  }
+
+  static int open(sqlite3_vtab* vtab, sqlite3_vtab_cursor** cursor) {
+    Cursor* created = new Cursor{};
+    created->source = static_cast<Table*>(vtab)->source;
+    created->source->refresh();
+    *cursor = created;
+    return SQLITE_OK;
+  }
+
+  static int close(sqlite3_vtab_cursor* cursor) {
+    Cursor* closed = static_cast<Cursor*>(cursor);
+    closed->clear();
+    delete closed;
+    return SQLITE_OK;
+  }
+
+  /**
+   * @brief Narrow [row, end) by rowid constraint, comparison follows
+   *        SQLite order NULL < numbers < text < blob.
+   */
+  static void narrow(Cursor& cursor, int op, sqlite3_value* value) {
+    int type = sqlite3_value_numeric_type(value);
+    if (type == SQLITE_NULL) {
+      cursor.end = cursor.row;
+      return;
+    }
+    if (type != SQLITE_INTEGER && type != SQLITE_FLOAT) {
+      if (op == SQLITE_INDEX_CONSTRAINT_EQ || op == SQLITE_INDEX_CONSTRAINT_GT ||
+          op == SQLITE_INDEX_CONSTRAINT_GE) {
+        cursor.end = cursor.row;
+      }
+      return;
+    }
+    double bound = sqlite3_value_double(value);
+    double first{0.0};
+    double last{static_cast<double>(cursor.end)};
+    switch (op) {
+      case SQLITE_INDEX_CONSTRAINT_EQ:
+        first = bound;
+        last = std::floor(bound) == bound ? bound + 1.0 : bound;
+        break;
+      case SQLITE_INDEX_CONSTRAINT_GT:
+        first = std::floor(bound) + 1.0;
+        break;
+      case SQLITE_INDEX_CONSTRAINT_GE:
+        first = std::ceil(bound);
+        break;
+      case SQLITE_INDEX_CONSTRAINT_LT:
+        last = std::ceil(bound);
+        break;
+      case SQLITE_INDEX_CONSTRAINT_LE:
+        last = std::floor(bound) + 1.0;
+        break;
+    }
+    double end = static_cast<double>(cursor.end);
+    cursor.row = std::max(cursor.row, static_cast<size_t>(std::clamp(first, 0.0, end)));
+    cursor.end = std::min(cursor.end, static_cast<size_t>(std::clamp(last, 0.0, end)));
+  }
+
+  static int filter(
+      sqlite3_vtab_cursor* cursor, int, const char* plan, int count, sqlite3_value** values
+  ) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    scan->clear();
+    scan->row = 0;
+    scan->end = scan->source->rows;
+    const char* position = plan ? plan : "";
+    for (int argument = 0; argument < count && scan->row < scan->end; ++argument) {
+      char* next{nullptr};
+      long column = std::strtol(position, &next, 10);
+      int op = static_cast<int>(std::strtol(next, &next, 10));
+      position = next;
+      if (column < 0) {
+        narrow(*scan, op, values[argument]);
+      } else {
+        sqlite3_value* value = sqlite3_value_dup(values[argument]);
+        if (!value) {
+          return SQLITE_NOMEM;
+        }
+        scan->filters.push_back({static_cast<size_t>(column), op, value});
+      }
+    }
+    scan->skip();
+    return SQLITE_OK;
+  }
+
+  static int next(sqlite3_vtab_cursor* cursor) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    ++(scan->row);
+    scan->skip();
+    return SQLITE_OK;
+  }
+
+  static int eof(sqlite3_vtab_cursor* cursor) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    return scan->row >= scan->end;
+  }
+
+  static int column(sqlite3_vtab_cursor* cursor, sqlite3_context* context, int index) {
+    Cursor* scan = static_cast<Cursor*>(cursor);
+    scan->source->columns[static_cast<size_t>(index)]->result(context, scan->row);
+    return SQLITE_OK;
+  }
+
+  static int rowid(sqlite3_vtab_cursor* cursor, sqlite3_int64* rowid) {
+    *rowid = static_cast<sqlite3_int64>(static_cast<Cursor*>(cursor)->row);
+    return SQLITE_OK;
+  }
+
+  static void destroy(void* data) {
+    delete static_cast<Source*>(data);
+  }
+
+  static const sqlite3_module* module() {
+    static const sqlite3_module methods = [] {
+      sqlite3_module methods{};
+      methods.xConnect = &connect;
+      methods.xBestIndex = &best_index;
+      methods.xDisconnect = &disconnect;
+      methods.xDestroy = &disconnect;
+      methods.xOpen = &open;
+      methods.xClose = &close;
+      methods.xFilter = &filter;
+      methods.xNext = &next;
+      methods.xEof = &eof;
+      methods.xColumn = &column;
+      methods.xRowid = &rowid;
+      return methods;
+    }();
+    return &methods;
+  }
+
+  static std::atomic<uint64_t> refreshes;
+
+  public:
+    /**
+     * @brief Default Constructor is not allowed.
+     */
+    ColumnTable() = delete;
+
+    /**
+     * @brief Getter for number of row pointer rebuilds of all tables.
+     * @return uint64_t number of rebuilds since start of process.
+     */
+    static uint64_t get_refreshes() {
+      return refreshes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Register columns as eponymous virtual table of connection,
+     *        registering same name again replaces table.
+     * @param db connection, columns must outlive it or re-registration.
+     * @param name table name.
+     * @param columns Column<T> objects of sqlitecxx data types.
+     * @return int SQLite status code.
+     */
+    template <class... T>
+    static int create(sqlite3* db, const std::string& name, Column<T>&... columns) {
+      Source* source = new Source{};
+      source->schema = "CREATE TABLE x(";
+      ((source->schema += identifier(columns.get_name()) + " " + columns.get_type() + ","), ...);
+      source->schema.back() = ')';
+      (source->columns.push_back(std::make_unique<Values<T>>(columns)), ...);
+      return sqlite3_create_module_v2(db, name.c_str(), module(), source, &destroy);
+    }
+};
+
+inline std::atomic<uint64_t> ColumnTable::refreshes{0};
+
+#endif
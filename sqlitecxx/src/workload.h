@@ -0,0 +1,380 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * workload.h
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ostream>
+#include "histogram.h"
+#include "sqlitecxx.h"
+#include "status.h"
+
+/**
+ * @brief Interval (ms) at which workers refresh status of own connection,
+ *        sqlite3_db_status() from reporter would wait on connection mutex
+ *        held by worker sleeping in busy handler.
+ */
+#define SQLITECXX_WORKLOAD_STATUS_MS 100
+
+/**
+ * @brief Operations of mixed workload.
+ */
+enum class WorkloadOperation {
+  read,  /* point lookup by primary key */
+  write, /* point update by primary key */
+  scan   /* range aggregate over primary key */
+};
+
+/**
+ * @brief WorkloadOptions. Configuration of load generator run.
+ */
+struct WorkloadOptions {
+  std::string database{"sqlitecxx_load.db"};
+  unsigned threads{4};
+  unsigned duration{10};            /* seconds */
+  unsigned interval{1};             /* seconds between reports */
+  int64_t rows{100000};             /* rows in load table */
+  int64_t scan_rows{100};           /* rows per range scan */
+  unsigned payload{100};            /* bytes of payload per row */
+  std::array<unsigned, 3> mix{{80, 15, 5}}; /* read, write, scan weights */
+  std::string journal_mode{"WAL"};
+  std::string synchronous{"NORMAL"};
+  int cache_size{-2000};            /* PRAGMA cache_size */
+  unsigned busy_timeout{5000};      /* milliseconds, maximal busy wait */
+  bool fair{false};                 /* queue-fair busy handler */
+  uint64_t seed{42};
+};
+
+/**
+ * @brief Workload. Runs mixed read/write/scan workload on N threads, each
+ *        with own connection, and reports throughput, latency percentiles
+ *        and SQLite status counters at fixed intervals.
+ */
+class Workload final {
+
+  static constexpr size_t operations{3};
+
+  /**
+   * @brief Per thread statistics, interval part is taken by reporter.
+   */
+  struct Statistics {
+    std::mutex mutex;
+    std::array<Histogram, operations> interval;
+    std::array<Histogram, operations> total;
+    uint64_t errors{0};
+    std::string failure;
+    DatabaseStatus status;
+    BusyMetrics busy;
+  };
+
+  WorkloadOptions options;
+  std::vector<std::unique_ptr<Statistics>> statistics;
+  std::atomic<bool> running{false};
+  std::atomic<bool> failed{false};
+
+  static const char* name(size_t operation) {
+    static const char* names[] = {"read", "write", "scan"};
+    return names[operation];
+  }
+
+  static std::string pragmas(const WorkloadOptions& options) {
+    return "PRAGMA journal_mode = " + options.journal_mode + ";"
+        "PRAGMA synchronous = " + options.synchronous + ";"
+        "PRAGMA cache_size = " + std::to_string(options.cache_size) + ";";
+  }
+
+  static BusyOptions busy_options(const WorkloadOptions& options) {
+    BusyOptions busy;
+    busy.max_wait = std::chrono::milliseconds(options.busy_timeout);
+    busy.fair = options.fair;
+    return busy;
+  }
+
+  /**
+   * @brief Create and fill load table when it has less than rows rows.
+   */
+  bool prepare_database() {
+    SQLiteCXX database{this->options.database};
+    database.enable_busy_handler(true, busy_options(this->options));
+    if (database.execute(pragmas(this->options)) != SQLITE_OK ||
+        database.execute(
+            "CREATE TABLE IF NOT EXISTS load("
+            "id INTEGER PRIMARY KEY, value INTEGER, payload BLOB)"
+        ) != SQLITE_OK) {
+      return false;
+    }
+    std::string sql =
+        "INSERT OR IGNORE INTO load "
+        "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c "
+        "WHERE x < " + std::to_string(this->options.rows) + ") "
+        "SELECT x, abs(random() % 1000000), randomblob(" +
+        std::to_string(this->options.payload) + ") FROM c";
+    return database.execute("BEGIN;" + sql + ";COMMIT;") == SQLITE_OK;
+  }
+
+  /**
+   * @brief Body of worker thread, statement that cannot be prepared
+   *        stops all workers and fails the run.
+   */
+  void worker(unsigned index, Statistics& statistics) {
+    SQLiteCXX database{this->options.database};
+    database.enable_busy_handler(true, busy_options(this->options));
+    database.execute(pragmas(this->options));
+    sqlite3* db = database.get_db();
+    const char* sql[operations] = {
+      "SELECT value, payload FROM load WHERE id = ?1",
+      "UPDATE load SET value = ?2, payload = randomblob(?3) WHERE id = ?1",
+      "SELECT count(*), sum(value) FROM load WHERE id BETWEEN ?1 AND ?1 + ?2"
+    };
+    sqlite3_stmt* statements[operations]{};
+    for (size_t operation = 0; operation < operations; ++operation) {
+      if (sqlite3_prepare_v2(db, sql[operation], -1, &statements[operation], nullptr)
+          != SQLITE_OK) {
+        std::lock_guard<std::mutex> lock{statistics.mutex};
+        ++statistics.errors;
+        statistics.failure = std::string{name(operation)} + " : " + sqlite3_errmsg(db);
+        this->failed = true;
+        this->running = false;
+        break;
+      }
+    }
+    auto sampled = std::chrono::steady_clock::now();
+    std::mt19937_64 random{this->options.seed + index};
+    std::uniform_int_distribution<int64_t> keys{1, std::max<int64_t>(this->options.rows, 1)};
+    std::discrete_distribution<size_t> mix{
+        this->options.mix.begin(), this->options.mix.end()
+    };
+    while (this->running.load(std::memory_order_relaxed)) {
+      size_t operation = mix(random);
+      sqlite3_stmt* statement = statements[operation];
+      sqlite3_bind_int64(statement, 1, keys(random));
+      if (operation == static_cast<size_t>(WorkloadOperation::write)) {
+        sqlite3_bind_int64(statement, 2, static_cast<int64_t>(random() % 1000000));
+        sqlite3_bind_int(statement, 3, static_cast<int>(this->options.payload));
+      } else if (operation == static_cast<size_t>(WorkloadOperation::scan)) {
+        sqlite3_bind_int64(statement, 2, this->options.scan_rows);
+      }
+      auto start = std::chrono::steady_clock::now();
+      int status;
+      while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+      }
+      sqlite3_reset(statement);
+      auto now = std::chrono::steady_clock::now();
+      uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          now - start
+      ).count();
+      DatabaseStatus database_status;
+      bool sample = now - sampled >=
+          std::chrono::milliseconds(SQLITECXX_WORKLOAD_STATUS_MS);
+      if (sample) {
+        database_status = Status::database(db);
+        sampled = now;
+      }
+      std::lock_guard<std::mutex> lock{statistics.mutex};
+      if (sample) {
+        statistics.status = database_status;
+      }
+      if (status == SQLITE_DONE) {
+        statistics.interval[operation].record(elapsed);
+        statistics.total[operation].record(elapsed);
+      } else {
+        ++statistics.errors;
+      }
+    }
+    DatabaseStatus database_status = Status::database(db);
+    std::lock_guard<std::mutex> lock{statistics.mutex};
+    statistics.status = database_status;
+    statistics.busy = database.get_busy_metrics();
+    for (sqlite3_stmt* statement : statements) {
+      sqlite3_finalize(statement);
+    }
+  }
+
+  /**
+   * @brief Sum of last sampled cache counters of all worker connections.
+   */
+  DatabaseStatus database_status() {
+    DatabaseStatus result;
+    for (auto& statistics : this->statistics) {
+      std::lock_guard<std::mutex> lock{statistics->mutex};
+      const DatabaseStatus& status = statistics->status;
+      result.cache_hit += status.cache_hit;
+      result.cache_miss += status.cache_miss;
+      result.cache_write += status.cache_write;
+      result.cache_spill += status.cache_spill;
+      result.cache_used += status.cache_used;
+      result.lookaside_hit += status.lookaside_hit;
+      result.lookaside_miss_full += status.lookaside_miss_full;
+      result.lookaside_miss_size += status.lookaside_miss_size;
+    }
+    return result;
+  }
+
+  static std::string microseconds(uint64_t nanoseconds) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.1f", nanoseconds / 1000.0);
+    return buffer;
+  }
+
+  static void report(
+      std::ostream& output, const char* label, double seconds,
+      const std::array<Histogram, operations>& histograms, uint64_t errors
+  ) {
+    uint64_t count{0};
+    for (const auto& histogram : histograms) {
+      count += histogram.get_count();
+    }
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%-8s %10.0f ops/s", label,
+        seconds > 0.0 ? count / seconds : 0.0);
+    output << buffer;
+    for (size_t operation = 0; operation < operations; ++operation) {
+      const Histogram& histogram = histograms[operation];
+      output << "  " << name(operation) << " " << histogram.get_count()
+          << " p50/p99/p999/max us " << microseconds(histogram.percentile(50.0))
+          << "/" << microseconds(histogram.percentile(99.0))
+          << "/" << microseconds(histogram.percentile(99.9))
+          << "/" << microseconds(histogram.get_max());
+    }
+    output << "  errors " << errors << '\n';
+  }
+
+  public:
+    /**
+     * @brief Construct a new Workload object.
+     * @param options configuration of run.
+     */
+    explicit Workload(WorkloadOptions options) : options{options} {}
+
+    /**
+     * @brief Run workload for configured duration.
+     * @param output stream for interval and final reports.
+     * @return int 0 on success, 1 when database or statements of worker
+     *         could not be prepared.
+     */
+    int run(std::ostream& output) {
+      if (!this->prepare_database()) {
+        return 1;
+      }
+      unsigned threads = std::max(1u, this->options.threads);
+      this->statistics.clear();
+      for (unsigned index = 0; index < threads; ++index) {
+        this->statistics.push_back(std::make_unique<Statistics>());
+      }
+      this->running = true;
+      this->failed = false;
+      std::vector<std::thread> workers;
+      for (unsigned index = 0; index < threads; ++index) {
+        workers.emplace_back(
+            &Workload::worker, this, index, std::ref(*this->statistics[index])
+        );
+      }
+      auto interval = std::chrono::seconds(std::max(1u, this->options.interval));
+      auto start = std::chrono::steady_clock::now();
+      auto end = start + std::chrono::seconds(this->options.duration);
+      auto previous = start;
+      DatabaseStatus before = this->database_status();
+      GlobalStatus global_before = Status::global();
+      uint64_t errors_before{0};
+      while (previous < end && !this->failed) {
+        std::this_thread::sleep_until(std::min(previous + interval, end));
+        auto now = std::chrono::steady_clock::now();
+        std::array<Histogram, operations> histograms;
+        uint64_t errors{0};
+        for (auto& statistics : this->statistics) {
+          std::lock_guard<std::mutex> lock{statistics->mutex};
+          for (size_t operation = 0; operation < operations; ++operation) {
+            histograms[operation].merge(statistics->interval[operation]);
+            statistics->interval[operation].reset();
+          }
+          errors += statistics->errors;
+        }
+        DatabaseStatus status = this->database_status();
+        GlobalStatus global = Status::global();
+        double seconds = std::chrono::duration<double>(now - previous).count();
+        std::string label = std::to_string(
+            std::chrono::duration_cast<std::chrono::seconds>(now - start).count()
+        ) + "s";
+        report(output, label.c_str(), seconds, histograms, errors - errors_before);
+        errors_before = errors;
+        DatabaseStatus delta;
+        delta.cache_hit = status.cache_hit - before.cache_hit;
+        delta.cache_miss = status.cache_miss - before.cache_miss;
+        output << "         cache hit " << delta.cache_hit << " miss "
+            << delta.cache_miss << " ratio " << delta.cache_hit_ratio()
+            << " write " << status.cache_write - before.cache_write
+            << " spill " << status.cache_spill - before.cache_spill
+            << " used " << status.cache_used
+            << " memory " << global.memory_used.current
+            << " (" << global.memory_used.current - global_before.memory_used.current
+            << ")" << '\n';
+        before = status;
+        global_before = global;
+        previous = now;
+      }
+      this->running = false;
+      for (auto& worker : workers) {
+        worker.join();
+      }
+      if (this->failed) {
+        for (auto& statistics : this->statistics) {
+          if (!statistics->failure.empty()) {
+            output << "Error Workload : cannot prepare " << statistics->failure << '\n';
+            break;
+          }
+        }
+        return 1;
+      }
+      auto finished = std::chrono::steady_clock::now();
+      std::array<Histogram, operations> totals;
+      uint64_t errors{0};
+      BusyMetrics busy;
+      for (auto& statistics : this->statistics) {
+        for (size_t operation = 0; operation < operations; ++operation) {
+          totals[operation].merge(statistics->total[operation]);
+        }
+        errors += statistics->errors;
+        busy.busy_events += statistics->busy.busy_events;
+        busy.retries += statistics->busy.retries;
+        busy.timeouts += statistics->busy.timeouts;
+        busy.wait_nanoseconds += statistics->busy.wait_nanoseconds;
+        busy.acquisition.merge(statistics->busy.acquisition);
+      }
+      double seconds = std::chrono::duration<double>(finished - start).count();
+      report(output, "total", seconds, totals, errors);
+      output << "         busy events " << busy.busy_events << " retries "
+          << busy.retries << " timeouts " << busy.timeouts << " wait ms "
+          << busy.wait_nanoseconds / 1000000 << " acquisition p50/p99 us "
+          << microseconds(busy.acquisition.percentile(50.0)) << "/"
+          << microseconds(busy.acquisition.percentile(99.0)) << '\n';
+      return 0;
+    }
+};
+
+#endif
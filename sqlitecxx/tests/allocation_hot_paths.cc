@@ -0,0 +1,94 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * allocation_hot_paths.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define SQLITECXX_ALLOCATION_HOOKS
+
+#include <iostream>
+#include "datatypes.h"
+#include "column.h"
+#include "bind.h"
+#include "sqlitecxx.h"
+#include "allocation.h"
+
+/**
+ * @brief Print allocations of hot path, true when there were none.
+ */
+static bool report(const char* name, const AllocationScope& scope, uint64_t rows) {
+    std::cout << name << " rows : " << rows;
+    std::cout << " new : " << scope.get_heap().allocations;
+    std::cout << " sqlite : " << scope.get_sqlite().allocations;
+    std::cout << " per row : " << static_cast<double>(scope.get_allocations()) / rows;
+    std::cout << std::endl;
+    return scope.get_allocations() == 0;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking zero allocations on hot paths !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    if (!Allocation::install_sqlite()) {
+        std::cout << "SQLite allocator can't be wrapped" << std::endl;
+        return 1;
+    }
+    const uint64_t rows{10000};
+    bool result{true};
+    INTEGER sum{0};
+    INTEGER one{1};
+    AllocationScope arithmetic;
+    for (uint64_t row = 0; row < rows; ++row) {
+        sum = sum + one;
+        ++sum;
+    }
+    result = report("Integer<T> arithmetic", arithmetic, rows) && result;
+    SQLiteCXX database{":memory:"};
+    database.execute("CREATE TABLE t(id INTEGER, name TEXT)");
+    Column<INTEGER> ids{"id", false};
+    Column<TEXT> names{"name", false};
+    for (uint64_t row = 0; row < rows; ++row) {
+        ids.insert_data(INTEGER{static_cast<int>(row)});
+        names.insert_data(TEXT{"row " + std::to_string(row)});
+    }
+    sqlite3_stmt* insert{nullptr};
+    sqlite3_prepare_v2(
+        database.get_db(), "INSERT INTO t VALUES (?1, ?2)", -1, &insert, nullptr
+    );
+    AllocationScope binding;
+    auto name = names.get_data().begin();
+    for (const auto& id : ids.get_data()) {
+        Bind::row(insert, id, *name++);
+        sqlite3_clear_bindings(insert);
+    }
+    result = report("Bind::row from Column<T>", binding, rows) && result;
+    sqlite3_finalize(insert);
+    sqlite3_stmt* select{nullptr};
+    sqlite3_prepare_v2(
+        database.get_db(), "SELECT ?1 + 1, ?2", -1, &select, nullptr
+    );
+    sqlite3_step(select);
+    sqlite3_reset(select);
+    AllocationScope stepping;
+    for (uint64_t row = 0; row < rows; ++row) {
+        sqlite3_bind_int64(select, 1, static_cast<sqlite3_int64>(row));
+        sqlite3_bind_text(select, 2, "cached", -1, SQLITE_STATIC);
+        sqlite3_step(select);
+        sqlite3_reset(select);
+    }
+    result = report("Step of cached statement", stepping, rows) && result;
+    sqlite3_finalize(select);
+    return result ? 0 : 1;
+}
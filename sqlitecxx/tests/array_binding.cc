@@ -0,0 +1,77 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * array_binding.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <span>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "sqlitecxx.h"
+
+/**
+ * @brief Step statement returning one text value and reset it for reuse.
+ */
+static std::string step(sqlite3_stmt* statement) {
+    std::string value{};
+    if (sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    }
+    sqlite3_reset(statement);
+    return value;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking key sets bound as one parameter of IN and JOIN !!!!!!!!!!!!!!!!
+    SQLiteCXX db{":memory:"};
+    int status = db.enable_array_binding();
+    db.execute("CREATE TABLE t(id INTEGER PRIMARY KEY, name TEXT)");
+    db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s"
+        " WHERE x < 10000) INSERT INTO t SELECT x, 'name' || x FROM s");
+    sqlite3_stmt* in{nullptr};
+    sqlite3_stmt* join{nullptr};
+    sqlite3_prepare_v2(db.get_db(), "SELECT count(*) || ':' || total(id) FROM t"
+        " WHERE id IN " SQLITECXX_ARRAY "(?1)", -1, &in, nullptr);
+    sqlite3_prepare_v2(db.get_db(), "SELECT count(*) || ':' || total(t.id) FROM "
+        SQLITECXX_ARRAY "(?1) AS k JOIN t ON t.name = k.value", -1, &join, nullptr);
+    std::vector<int64_t> keys{3, 5, 7, 20000};
+    ArrayTable::bind(in, 1, std::span<const int64_t>{keys});
+    std::string small = step(in);
+    Column<INTEGER> ids{"id", true};
+    for (int row = 1; row <= 1000; ++row) {
+        ids.get_data().push_back(INTEGER{row * 2});
+    }
+    ArrayTable::bind(in, 1, ids);
+    std::string large = step(in);
+    sqlite3_bind_null(in, 1);
+    std::string none = step(in);
+    Column<TEXT> names{"name", false};
+    names.get_data().push_back(TEXT{"name10"});
+    names.get_data().push_back(TEXT{"name11"});
+    ArrayTable::bind(join, 1, names);
+    std::string texts = step(join);
+    std::vector<std::string> strings{"name1", "missing"};
+    ArrayTable::bind(join, 1, std::span<const std::string>{strings});
+    std::string spans = step(join);
+    sqlite3_finalize(in);
+    sqlite3_finalize(join);
+    std::cout << "status : " << status << " small : " << small << " large : " << large;
+    std::cout << " none : " << none << " texts : " << texts << " spans : " << spans << std::endl;
+    return (status == SQLITE_OK && small == "3:15.0" && large == "1000:1001000.0" &&
+        none == "0:0.0" && texts == "2:21.0" && spans == "1:1.0") ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * busy_fair_contention.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <iostream>
+#include "sqlitecxx.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking fair mode under contention of many writers !!!!!!!!!!!!!!!!!!!!
+    const char* path = "busy_fair_contention.db";
+    std::remove(path);
+    constexpr int writers{6};
+    constexpr int transactions{25};
+    {
+        SQLiteCXX setup{path};
+        setup.execute("CREATE TABLE t(writer INTEGER, id INTEGER)");
+    }
+    std::atomic<int> failed{0};
+    std::vector<BusyMetrics> metrics(writers);
+    std::vector<std::thread> threads;
+    for (int writer = 0; writer < writers; ++writer) {
+        threads.emplace_back([&, writer]() {
+            SQLiteCXX database{path};
+            BusyOptions options;
+            options.fair = true;
+            options.initial_delay = std::chrono::microseconds(50);
+            options.max_delay = std::chrono::microseconds(2000);
+            options.max_wait = std::chrono::seconds(10);
+            database.enable_busy_handler(true, options);
+            for (int id = 0; id < transactions; ++id) {
+                if (database.execute("BEGIN IMMEDIATE") != SQLITE_OK) {
+                    ++failed;
+                    continue;
+                }
+                database.execute("INSERT INTO t VALUES (" + std::to_string(writer) +
+                    ", " + std::to_string(id) + ")");
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                if (database.execute("COMMIT") != SQLITE_OK) {
+                    ++failed;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            database.execute("SELECT 1");
+            metrics[writer] = database.get_busy_metrics();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    sqlite3* db{nullptr};
+    sqlite3_open(path, &db);
+    sqlite3_stmt* statement{nullptr};
+    sqlite3_prepare_v2(db, "SELECT count(*), count(DISTINCT writer) FROM t", -1, &statement, nullptr);
+    sqlite3_step(statement);
+    int rows = sqlite3_column_int(statement, 0);
+    int distinct = sqlite3_column_int(statement, 1);
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+    std::remove(path);
+    uint64_t busy_events{0};
+    uint64_t timeouts{0};
+    uint64_t longest{0};
+    for (const auto& writer : metrics) {
+        busy_events += writer.busy_events;
+        timeouts += writer.timeouts;
+        longest = std::max(longest, writer.acquisition.get_max());
+    }
+    std::cout << "rows : " << rows << " writers : " << distinct << " failed : " << failed;
+    std::cout << " busy events : " << busy_events << " timeouts : " << timeouts;
+    std::cout << " longest acquisition ns : " << longest << std::endl;
+    return (rows == writers * transactions && distinct == writers && failed == 0 &&
+        busy_events >= writers && timeouts == 0 && longest < 5000000000) ? 0 : 1;
+}
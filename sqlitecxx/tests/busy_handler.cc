@@ -0,0 +1,78 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * busy_handler.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+#include <cstdio>
+#include <iostream>
+#include "sqlitecxx.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking busy handler backoff, timeout and metrics !!!!!!!!!!!!!!!!!!!!!
+    const char* path = "busy_handler.db";
+    std::remove(path);
+    SQLiteCXX holder{path};
+    SQLiteCXX waiter{path};
+    holder.execute("CREATE TABLE t(id INTEGER)");
+    BusyOptions options;
+    options.max_wait = std::chrono::milliseconds(1000);
+    waiter.enable_busy_handler(true, options);
+    holder.execute("BEGIN IMMEDIATE");
+    std::thread release{[&holder]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        holder.execute("COMMIT");
+    }};
+    int acquired = waiter.execute("INSERT INTO t VALUES (1)");
+    release.join();
+    options.max_wait = std::chrono::milliseconds(20);
+    waiter.enable_busy_handler(true, options);
+    holder.execute("BEGIN IMMEDIATE");
+    int timed_out = waiter.execute("INSERT INTO t VALUES (2)");
+    holder.execute("COMMIT");
+    BusyMetrics metrics = waiter.get_busy_metrics();
+    std::cout << "acquired : " << acquired << " timed out : " << timed_out;
+    std::cout << " busy events : " << metrics.busy_events;
+    std::cout << " retries : " << metrics.retries;
+    std::cout << " timeouts : " << metrics.timeouts << std::endl;
+    waiter.enable_busy_handler(true, BusyOptions{});
+    holder.execute("BEGIN IMMEDIATE");
+    release = std::thread{[&holder]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        holder.execute("COMMIT");
+    }};
+    waiter.execute("INSERT INTO t VALUES (3)");
+    release.join();
+    waiter.execute("SELECT 1");
+    metrics = waiter.get_busy_metrics();
+    uint64_t latency = metrics.acquisition.percentile(50.0);
+    std::cout << "acquisition latency ns : " << latency << std::endl;
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking metrics survive re-enable and disable until reset !!!!!!!!!!!!!
+    waiter.enable_busy_handler(false);
+    BusyMetrics kept = waiter.get_busy_metrics();
+    waiter.reset_busy_metrics();
+    BusyMetrics cleared = waiter.get_busy_metrics();
+    std::cout << "kept busy events : " << kept.busy_events << " timeouts : " << kept.timeouts;
+    std::cout << " after reset : " << cleared.busy_events << std::endl;
+    std::remove(path);
+    return (acquired == SQLITE_OK && timed_out == SQLITE_BUSY &&
+        metrics.busy_events == 3 && metrics.timeouts == 1 && latency >= 40000000 &&
+        kept.busy_events == 3 && kept.acquisition.get_count() == 2 &&
+        cleared.busy_events == 0 && cleared.acquisition.get_count() == 0) ? 0 : 1;
+}
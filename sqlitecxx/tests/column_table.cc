@@ -0,0 +1,89 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * column_table.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <iostream>
+#include "sqlitecxx.h"
+#include "vtable.h"
+
+/**
+ * @brief Run query returning one integer.
+ */
+static int64_t scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    int64_t value{-1};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW) {
+        value = sqlite3_column_int64(statement, 0);
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking virtual table over in-memory columns !!!!!!!!!!!!!!!!!!!!!!!!!!
+    Column<INTEGER> ids{"id", true};
+    Column<TEXT> names{"name", false};
+    Column<REAL> scores{"score", false};
+    for (int row = 0; row < 10000; ++row) {
+        ids.get_data().push_back(INTEGER{row});
+        names.get_data().push_back(TEXT{"name" + std::to_string(row % 100)});
+        scores.get_data().push_back(REAL{row * 0.5});
+    }
+    SQLiteCXX db{":memory:"};
+    db.execute("CREATE TABLE orders(id INTEGER PRIMARY KEY, item INTEGER, amount INTEGER)");
+    db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s"
+        " WHERE x < 500) INSERT INTO orders SELECT x, x * 7 % 10000, x FROM s");
+    int status = ColumnTable::create(db.get_db(), "hot", ids, names, scores);
+    int64_t count = scalar(db.get_db(), "SELECT count(*) FROM hot");
+    int64_t point = scalar(db.get_db(), "SELECT id FROM hot WHERE rowid = 4242");
+    int64_t range = scalar(db.get_db(),
+        "SELECT count(*) FROM hot WHERE rowid >= 100 AND rowid < 200.5");
+    int64_t filtered = scalar(db.get_db(),
+        "SELECT count(*) FROM hot WHERE name = 'name7' AND score > 2500");
+    int64_t mixed = scalar(db.get_db(), "SELECT count(*) FROM hot WHERE id = '42'");
+    uint64_t before = ColumnTable::get_refreshes();
+    int64_t joined = scalar(db.get_db(),
+        "SELECT sum(o.amount) FROM orders o CROSS JOIN hot h ON h.rowid = o.item"
+        " WHERE h.name = 'name' || (o.item % 100)");
+    uint64_t refreshes = ColumnTable::get_refreshes() - before;
+    ids.get_data().push_back(INTEGER{10000});
+    names.get_data().push_back(TEXT{"name0"});
+    scores.get_data().push_back(REAL{5000.0});
+    int64_t grown = scalar(db.get_db(), "SELECT max(id) FROM hot");
+    ids.get_data().pop_front();
+    names.get_data().pop_front();
+    scores.get_data().pop_front();
+    ids.get_data().push_back(INTEGER{10001});
+    names.get_data().push_back(TEXT{"appended after erase"});
+    scores.get_data().push_back(REAL{5000.5});
+    int64_t shifted = scalar(db.get_db(),
+        "SELECT count(*) * 100000 + min(id) FROM hot WHERE rowid < 10001");
+    int64_t appended = scalar(db.get_db(),
+        "SELECT id FROM hot WHERE name = 'appended after erase' AND rowid = 10000");
+    std::cout << "count : " << count << " point : " << point << " range : " << range;
+    std::cout << " filtered : " << filtered << " mixed : " << mixed;
+    std::cout << " joined : " << joined << " grown : " << grown;
+    std::cout << " shifted : " << shifted << " appended : " << appended;
+    std::cout << " join refreshes : " << refreshes << std::endl;
+    return (status == SQLITE_OK && count == 10000 && point == 4242 && range == 101 &&
+        filtered == 50 && mixed == 1 && joined == 125250 && grown == 10000 &&
+        shifted == 1000100001 && appended == 10001 && refreshes == 1) ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * columnar_file.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <numeric>
+#include <iostream>
+#include "sqlitecxx.h"
+#include "columnar.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking columnar export and zero-copy load !!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    const char* path = "columnar_file.col";
+    Column<INTEGER> ids{"id", true};
+    Column<TEXT> names{"name", false};
+    Column<REAL> prices{"price", false};
+    for (int row = 0; row < 1000; ++row) {
+        ids.get_data().push_back(INTEGER{row});
+        names.get_data().push_back(TEXT{"name" + std::to_string(row)});
+        prices.get_data().push_back(REAL{row * 0.25});
+    }
+    ColumnarWriter writer;
+    writer.add(ids);
+    writer.add(names);
+    writer.add(prices);
+    uint64_t rows{0};
+    {
+        SQLiteCXX db{":memory:"};
+        db.execute("CREATE TABLE t(score REAL, note TEXT)");
+        db.execute("WITH RECURSIVE s(x) AS (SELECT 0 UNION ALL SELECT x + 1 FROM s"
+            " WHERE x < 999) INSERT INTO t SELECT CASE WHEN x % 10 THEN x END,"
+            " CASE WHEN x % 3 THEN 'n' || x END FROM s");
+        rows = writer.add(db.get_db(), "SELECT score, note FROM t");
+    }
+    writer.write(path);
+    ColumnarFile file{path};
+    auto values = file.get_values<int32_t>(file.find("id"));
+    int64_t sum = std::accumulate(values.begin(), values.end(), int64_t{0});
+    Column<TEXT> loaded{"name", false};
+    file.load(file.find("name"), loaded);
+    Column<Text<std::string_view>> notes{"note", false};
+    file.load(file.find("note"), notes);
+    bool aligned = reinterpret_cast<uintptr_t>(values.data()) % SQLITECXX_COLUMNAR_ALIGNMENT == 0;
+    std::cout << "rows : " << file.get_rows() << " columns : " << file.get_columns();
+    std::cout << " sum : " << sum << " score nulls : " << file.get_null_count(3);
+    std::cout << " note nulls : " << file.get_null_count(4) << std::endl;
+    bool valid = rows == 1000 && file.get_rows() == 1000 && file.get_columns() == 5 &&
+        sum == 499500 && aligned && file.get_sql_type(0) == "Integer" &&
+        file.get_type(3) == SQLITE_FLOAT && file.get_null_count(3) == 100 &&
+        !file.is_valid(3, 10) && file.is_valid(3, 11) &&
+        file.get_values<double>(3)[11] == 11.0 &&
+        file.get_null_count(4) == 334 && file.get_bytes(4, 998) == "n998" &&
+        notes.get_data().size() == 1000 && notes.get_data().back().get().empty() &&
+        loaded.get_data().back().get() == "name999" &&
+        file.get_values<double>(2)[4] == 1.0;
+    std::remove(path);
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * compressed_vfs.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <iostream>
+#include <sys/stat.h>
+#include "sqlitecxx.h"
+#include "compress.h"
+
+/**
+ * @brief Run query returning one text value.
+ */
+static std::string scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    std::string value{};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+/**
+ * @brief Size of file on disk.
+ */
+static long long physical(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0 ? static_cast<long long>(info.st_size) : -1;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking page-compressing VFS with journal, WAL, reopen and reuse !!!!!!!
+    const char* path = "compressed_vfs.db";
+    const char* uri = "file:compressed_vfs.db?vfs=" SQLITECXX_COMPRESS_VFS;
+    std::remove(path);
+    std::remove("compressed_vfs.db-journal");
+    std::remove("compressed_vfs.db-wal");
+    std::remove("compressed_vfs.db-shm");
+    bool installed = CompressVfs::install();
+    std::string integrity{};
+    std::string rows{};
+    std::string seen{};
+    long long logical{0};
+    long long full{0};
+    {
+        SQLiteCXX db{uri};
+        std::unique_ptr<SQLiteCXX> other = std::make_unique<SQLiteCXX>(uri);
+        db.execute("CREATE TABLE t(id INTEGER PRIMARY KEY, payload TEXT)");
+        for (int batch = 0; batch < 10; ++batch) {
+            db.execute("BEGIN");
+            db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s"
+                " WHERE x < 1000) INSERT INTO t(payload)"
+                " SELECT printf('row %d of batch with repeated text text text', x) FROM s");
+            db.execute("COMMIT");
+        }
+        seen = scalar(other->get_db(), "SELECT count(*) FROM t");
+        db.execute("PRAGMA journal_mode = WAL");
+        db.execute("UPDATE t SET payload = 'x' WHERE id % 3 = 0");
+        db.execute("PRAGMA wal_checkpoint(TRUNCATE)");
+        seen += ":" + scalar(other->get_db(), "SELECT sum(payload = 'x') FROM t");
+        other.reset();
+        logical = std::stoll(scalar(db.get_db(), "SELECT page_count * page_size FROM"
+            " pragma_page_count(), pragma_page_size()"));
+        full = physical(path);
+        db.execute("PRAGMA journal_mode = DELETE");
+        db.execute("DELETE FROM t WHERE id > 2000");
+        db.execute("VACUUM");
+    }
+    long long vacuumed = physical(path);
+    {
+        SQLiteCXX db{uri};
+        integrity = scalar(db.get_db(), "PRAGMA integrity_check");
+        rows = scalar(db.get_db(), "SELECT count(*) || ':' || sum(payload = 'x') FROM t");
+        rows += ":" + scalar(db.get_db(), "SELECT count(*) FROM t WHERE payload LIKE 'row%'");
+    }
+    CompressStats stats = CompressVfs::stats();
+    std::cout << "installed : " << installed << " integrity : " << integrity;
+    std::cout << " rows : " << rows << " seen : " << seen << std::endl;
+    std::cout << "logical : " << logical << " physical : " << full;
+    std::cout << " after vacuum : " << vacuumed << std::endl;
+    std::cout << "page writes : " << stats.page_writes << " stored : " << stats.stored_bytes;
+    std::cout << " / " << stats.logical_bytes << " page reads : " << stats.page_reads;
+    std::cout << " cache hits : " << stats.cache_hits << " commits : " << stats.commits << std::endl;
+    std::remove(path);
+    CompressVfs::uninstall();
+    return (installed && integrity == "ok" && rows == "2000:666:1334" && seen == "10000:3333" &&
+        full < logical / 2 && vacuumed < full && stats.cache_hits > 0) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * compressed_wal_sync_off.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <string>
+#include <iostream>
+#include "sqlitecxx.h"
+#include "compress.h"
+
+/**
+ * @brief Run query returning one text value, empty on error.
+ */
+static std::string scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    std::string value{};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+/**
+ * @brief Probe VFS over compressing VFS, reads with second connection
+ *        when checkpoint releases WAL read lock 0, which is right after
+ *        checkpointed frames are marked backfilled in shared memory.
+ */
+struct Probe {
+    static inline sqlite3_vfs vfs{};
+    static inline sqlite3_io_methods io{};
+    static inline const sqlite3_io_methods* wrapped{nullptr};
+    static inline sqlite3* reader{nullptr};
+    static inline bool armed{false};
+    static inline std::string seen{};
+
+    static int shm_lock(sqlite3_file* handle, int offset, int count, int flags) {
+        if (armed && offset == 3 && count == 1 &&
+            flags == (SQLITE_SHM_UNLOCK | SQLITE_SHM_EXCLUSIVE)) {
+            armed = false;
+            seen = scalar(reader, "SELECT count(*) || ':' || count(payload) FROM t");
+        }
+        return wrapped->xShmLock(handle, offset, count, flags);
+    }
+
+    static int open(sqlite3_vfs*, const char* name, sqlite3_file* handle, int flags, int* out) {
+        sqlite3_vfs* base = sqlite3_vfs_find(SQLITECXX_COMPRESS_VFS);
+        int status = base->xOpen(base, name, handle, flags, out);
+        if (status == SQLITE_OK && (flags & SQLITE_OPEN_MAIN_DB) && handle->pMethods) {
+            wrapped = handle->pMethods;
+            io = *wrapped;
+            io.xShmLock = &shm_lock;
+            handle->pMethods = &io;
+        }
+        return status;
+    }
+
+    static void install() {
+        vfs = *sqlite3_vfs_find(SQLITECXX_COMPRESS_VFS);
+        vfs.zName = "sqlitecxx-probe";
+        vfs.pNext = nullptr;
+        vfs.xOpen = &open;
+        sqlite3_vfs_register(&vfs, 0);
+    }
+};
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking index is published before checkpoint marks frames backfilled !!
+    const char* path = "compressed_wal_sync_off.db";
+    std::remove(path);
+    std::remove("compressed_wal_sync_off.db-wal");
+    std::remove("compressed_wal_sync_off.db-shm");
+    bool installed = CompressVfs::install();
+    Probe::install();
+    int probes{0};
+    int stale{0};
+    std::string rows{};
+    {
+        SQLiteCXX writer{"file:compressed_wal_sync_off.db?vfs=sqlitecxx-probe"};
+        writer.execute("PRAGMA journal_mode = WAL");
+        writer.execute("PRAGMA synchronous = OFF");
+        writer.execute("PRAGMA wal_autocheckpoint = 0");
+        writer.execute("CREATE TABLE t(id INTEGER PRIMARY KEY, payload TEXT)");
+        writer.execute("PRAGMA wal_checkpoint(TRUNCATE)");
+        SQLiteCXX reader{"file:compressed_wal_sync_off.db?vfs=" SQLITECXX_COMPRESS_VFS};
+        reader.execute("PRAGMA synchronous = OFF");
+        Probe::reader = reader.get_db();
+        for (int batch = 1; batch <= 20; ++batch) {
+            scalar(reader.get_db(), "SELECT count(*) FROM t");
+            writer.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s"
+                " WHERE x < 50) INSERT INTO t(payload)"
+                " SELECT printf('batch %d row %d with compressible text text', "
+                + std::to_string(batch) + ", x) FROM s");
+            Probe::armed = true;
+            Probe::seen.clear();
+            writer.execute("PRAGMA wal_checkpoint(PASSIVE)");
+            if (!Probe::armed) {
+                ++probes;
+                std::string expected = std::to_string(batch * 50);
+                stale += Probe::seen != expected + ":" + expected;
+            }
+            Probe::armed = false;
+        }
+        rows = scalar(reader.get_db(), "SELECT count(*) FROM t");
+    }
+    std::string integrity{};
+    {
+        SQLiteCXX db{"file:compressed_wal_sync_off.db?vfs=" SQLITECXX_COMPRESS_VFS};
+        integrity = scalar(db.get_db(), "PRAGMA integrity_check");
+    }
+    std::cout << "installed : " << installed << " probes : " << probes;
+    std::cout << " stale : " << stale << " last seen : " << Probe::seen;
+    std::cout << " rows : " << rows << " integrity : " << integrity << std::endl;
+    std::remove(path);
+    std::remove("compressed_wal_sync_off.db-wal");
+    std::remove("compressed_wal_sync_off.db-shm");
+    sqlite3_vfs_unregister(&Probe::vfs);
+    CompressVfs::uninstall();
+    return (installed && probes == 20 && stale == 0 && rows == "1000" && integrity == "ok") ? 0 : 1;
+}
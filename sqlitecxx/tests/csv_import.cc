@@ -0,0 +1,89 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * csv_import.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <iterator>
+#include <fstream>
+#include <iostream>
+#include "sqlitecxx.h"
+#include "csv.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking parallel CSV import into table and columns !!!!!!!!!!!!!!!!!!!!
+    const char* path = "csv_import.csv";
+    const char* database = "csv_import.db";
+    std::remove(database);
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "id,name,price\r\n";
+        for (int row = 0; row < 20000; ++row) {
+            file << row << ",";
+            if (row % 100 == 0) {
+                file << "\"item, \"\"" << row << "\"\"\nsecond line\"";
+            } else {
+                file << "item" << row;
+            }
+            file << "," << (row % 7 ? std::to_string(row * 0.5) : "") << "\r\n";
+        }
+    }
+    CsvOptions options;
+    options.threads = 4;
+    options.range = 4096;
+    options.transaction = 5000;
+    int64_t rows{-1};
+    int64_t sum{-1};
+    int64_t nulls{-1};
+    std::string quoted{};
+    CsvReport report{};
+    {
+        SQLiteCXX db{database};
+        report = Csv::import(db.get_db(), path, "items", options);
+        sqlite3_stmt* statement{nullptr};
+        sqlite3_prepare_v2(db.get_db(),
+            "SELECT count(*), sum(id), count(*) - count(price),"
+            " (SELECT name FROM items WHERE id = 300) FROM items",
+            -1, &statement, nullptr);
+        if (sqlite3_step(statement) == SQLITE_ROW) {
+            rows = sqlite3_column_int64(statement, 0);
+            sum = sqlite3_column_int64(statement, 1);
+            nulls = sqlite3_column_int64(statement, 2);
+            quoted = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
+        }
+        sqlite3_finalize(statement);
+    }
+    std::cout << "rows : " << rows << " ranges : " << report.ranges;
+    std::cout << " transactions : " << report.transactions;
+    std::cout << " mismatched : " << report.mismatched << std::endl;
+    Column<INTEGER> ids{"id", true};
+    Column<TEXT> names{"name", false};
+    Column<REAL> prices{"price", false};
+    Csv::read(path, options, ids, names, prices);
+    std::cout << "columns : " << ids.get_data().size();
+    std::cout << " last : " << ids.get_data().back().get() << " ";
+    std::cout << names.get_data().back().get() << std::endl;
+    std::remove(path);
+    std::remove(database);
+    return (rows == 20000 && sum == 199990000 && nulls == 2858 &&
+        quoted == "item, \"300\"\nsecond line" && report.ranges > 1 &&
+        report.transactions == 4 && report.mismatched == 0 &&
+        ids.get_data().size() == 20000 && ids.get_data().back().get() == 19999 &&
+        names.get_data().back().get() == "item19999" &&
+        std::prev(prices.get_data().end(), 2)->get() == 19998 * 0.5) ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * delta_integer.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "datatypes.h"
+#include "delta.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking frame of reference/delta round trip !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    Column<INTEGER> keys{"id", true};
+    for (int key = 0; key < 100000; ++key) {
+        keys.get_data().push_back(INTEGER{key * 3 + (key % 2)});
+    }
+    DeltaInteger<int> encoded;
+    encoded.encode(keys);
+    std::vector<int> decoded;
+    encoded.decode(decoded);
+    size_t index{0};
+    size_t mismatches{0};
+    for (auto& key : keys.get_data()) {
+        if (key.get() != decoded[index] || key.get() != encoded.at(index)) {
+            ++mismatches;
+        }
+        ++index;
+    }
+    Column<INTEGER> duplicates{"id", true};
+    for (int key = 0; key < 1000; ++key) {
+        duplicates.get_data().push_back(INTEGER{key < 120 ? key : key < 300 ? 120 : key});
+    }
+    DeltaInteger<int> repeated;
+    repeated.encode(duplicates);
+    size_t first = repeated.lower_bound(120);
+    size_t after = repeated.lower_bound(121);
+    size_t before = repeated.lower_bound(-5);
+    size_t past = repeated.lower_bound(5000);
+    std::cout << "keys : " << keys.get_data().size() * sizeof(int);
+    std::cout << " -> " << encoded.size_in_bytes() << std::endl;
+    std::cout << "contains 300 : " << encoded.contains(300) << std::endl;
+    std::cout << "contains 301 : " << encoded.contains(301) << std::endl;
+    std::cout << "mismatches : " << mismatches << std::endl;
+    std::cout << "lower_bound 120 : " << first << " 121 : " << after << std::endl;
+    return (mismatches == 0 && first == 120 && after == 300 && before == 0 &&
+        past == 1000) ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * gorilla_real.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "datatypes.h"
+#include "gorilla.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking Gorilla XOR/delta-of-delta round trip !!!!!!!!!!!!!!!!!!!!!!!!!
+    Column<REAL> readings{"reading", false};
+    Column<Integer<int64_t>> stamps{"stamp", false};
+    double reading{21.5};
+    for (int64_t index = 0; index < 10000; ++index) {
+        reading += (index % 13 == 0) ? 0.125 : 0.0;
+        readings.get_data().push_back(REAL{reading});
+        stamps.get_data().push_back(
+            Integer<int64_t>{1640995200 + index * 15 + (index % 97 == 0)}
+        );
+    }
+    GorillaReal<double> encoded_readings;
+    encoded_readings.encode(readings);
+    GorillaInteger<int64_t> encoded_stamps;
+    encoded_stamps.encode(stamps);
+    std::vector<double> decoded_readings;
+    encoded_readings.decode(decoded_readings, 4);
+    std::vector<int64_t> decoded_stamps;
+    encoded_stamps.decode(decoded_stamps, 4);
+    size_t index{0};
+    size_t mismatches{0};
+    for (auto& value : readings.get_data()) {
+        if (value.get() != decoded_readings[index++]) {
+            ++mismatches;
+        }
+    }
+    index = 0;
+    for (auto& value : stamps.get_data()) {
+        if (value.get() != decoded_stamps[index++]) {
+            ++mismatches;
+        }
+    }
+    std::cout << "readings : " << readings.get_data().size() * sizeof(double);
+    std::cout << " -> " << encoded_readings.size_in_bytes() << std::endl;
+    std::cout << "stamps : " << stamps.get_data().size() * sizeof(int64_t);
+    std::cout << " -> " << encoded_stamps.size_in_bytes() << std::endl;
+    std::cout << "mismatches : " << mismatches << std::endl;
+    return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * group_by.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "datatypes.h"
+#include "groupby.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking group-by aggregation !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    Column<TEXT> regions{"region", false};
+    Column<INTEGER> quantities{"quantity", false};
+    Column<REAL> prices{"price", false};
+    const char* names[] = {"north", "south", "east", "west"};
+    for (int row = 0; row < 100000; ++row) {
+        regions.get_data().push_back(TEXT{names[row % 4]});
+        quantities.get_data().push_back(INTEGER{row % 10});
+        prices.get_data().push_back(REAL{row * 0.5});
+    }
+    GroupBy<TEXT> grouping{regions};
+    grouping.set_threads(4);
+    grouping.aggregate(Aggregate::sum, quantities);
+    grouping.aggregate(Aggregate::avg, prices);
+    grouping.aggregate(Aggregate::max, prices);
+    GroupByResult result = grouping.run();
+    for (size_t group = 0; group < result.rows.size(); ++group) {
+        std::cout << grouping.key<0>(result.rows[group]).get();
+        std::cout << " count : " << result.counts[group];
+        std::cout << " sum : " << result.values[0][group];
+        std::cout << " avg : " << result.values[1][group];
+        std::cout << " max : " << result.values[2][group] << std::endl;
+    }
+    Column<INTEGER> buckets{"bucket", false};
+    Column<Integer<int64_t>> large{"large", false};
+    int64_t top = (int64_t{1} << 60) + 1;
+    for (int row = 0; row < 100000; ++row) {
+        buckets.get_data().push_back(INTEGER{row % 50000});
+        large.get_data().push_back(Integer<int64_t>{top - row});
+    }
+    GroupBy<INTEGER> many{buckets};
+    many.set_threads(4);
+    many.aggregate(Aggregate::max, large);
+    many.aggregate(Aggregate::min, large);
+    GroupByResult exact = many.run();
+    bool precise = exact.rows.size() == 50000 && exact.integers[0][0] == top &&
+        exact.integers[1][0] == top - 50000 && exact.counts[49999] == 2;
+    std::cout << "groups : " << exact.rows.size() << " max : " << exact.integers[0][0];
+    std::cout << " min : " << exact.integers[1][0] << std::endl;
+    Column<INTEGER> signs{"sign", false};
+    Column<Integer<int64_t>> huge{"huge", false};
+    for (int row = 0; row < 1000; ++row) {
+        signs.get_data().push_back(INTEGER{row % 2});
+        huge.get_data().push_back(Integer<int64_t>{row % 2 ? -(int64_t{1} << 60) : int64_t{1} << 60});
+    }
+    GroupBy<INTEGER> overflow{signs};
+    overflow.set_threads(4);
+    overflow.aggregate(Aggregate::sum, huge);
+    GroupByResult sums = overflow.run();
+    double expected = 500.0 * static_cast<double>(int64_t{1} << 60);
+    bool saturated = sums.values[0][0] == expected && sums.values[0][1] == -expected &&
+        sums.integers[0][0] == std::numeric_limits<int64_t>::max() &&
+        sums.integers[0][1] == std::numeric_limits<int64_t>::min();
+    std::cout << "overflow sum : " << sums.values[0][0] << " " << sums.values[0][1] << std::endl;
+    return (result.rows.size() == 4 && result.counts[0] == 25000 && precise && saturated &&
+        result.integers[0].size() == 4 && result.integers[1].empty()) ? 0 : 1;
+}
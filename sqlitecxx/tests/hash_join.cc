@@ -0,0 +1,49 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * hash_join.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "datatypes.h"
+#include "join.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking inner/left/semi hash join !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    Column<INTEGER> orders{"customer_id", false};
+    Column<INTEGER> customers{"id", true};
+    for (int id = 0; id < 100000; ++id) {
+        customers.get_data().push_back(INTEGER{id * 2});
+        orders.get_data().push_back(INTEGER{id % 1000});
+    }
+    HashJoin<INTEGER> table{customers, 4};
+    auto inner = table.probe(orders, JoinType::inner);
+    auto left = table.probe(orders, JoinType::left);
+    auto semi = table.probe(orders, JoinType::semi);
+    size_t unmatched{0};
+    for (const auto& match : left) {
+        if (match.right == JoinMatch::none) {
+            ++unmatched;
+        }
+    }
+    std::cout << "partitions : " << table.partition_count() << std::endl;
+    std::cout << "inner : " << inner.size() << std::endl;
+    std::cout << "left : " << left.size();
+    std::cout << " unmatched : " << unmatched << std::endl;
+    std::cout << "semi : " << semi.size() << std::endl;
+    return (inner.size() == 50000 && left.size() == 100000 &&
+        unmatched == 50000 && semi.size() == 50000) ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * hash_values.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "datatypes.h"
+#include "hash.h"
+
+/**
+ * @brief Largest relative deviation of bucket counts from their mean,
+ *        buckets by low bits (hash % buckets) or top 6 bits.
+ */
+static double spread(const std::vector<uint64_t>& hashes, size_t buckets, bool high) {
+    buckets = high ? 64 : buckets;
+    std::vector<size_t> counts(buckets, 0);
+    for (uint64_t hash : hashes) {
+        ++counts[high ? static_cast<size_t>(hash >> 58) : hash % buckets];
+    }
+    double mean = static_cast<double>(hashes.size()) / static_cast<double>(buckets);
+    double worst{0.0};
+    for (size_t count : counts) {
+        worst = std::max(worst, std::fabs(static_cast<double>(count) - mean) / mean);
+    }
+    return worst;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking hashing of integers, bytes and doubles !!!!!!!!!!!!!!!!!!!!!!!!
+    std::string first{"sqlitecxx hash key of some length"};
+    std::string second{first.data(), first.size()};
+    bool equal = Hash::integer(42) == Hash::integer(42) &&
+        Hash::bytes(first.data(), first.size()) == Hash::bytes(second.data(), second.size()) &&
+        Hash::value(TEXT{first}) == Hash::value(TEXT{second}) &&
+        Hash::value(INTEGER{7}) == Hash::integer(7) &&
+        Hash::real(1.5) == Hash::real(3.0 / 2.0);
+    bool different = Hash::integer(42) != Hash::integer(43) &&
+        Hash::bytes("abc", 3) != Hash::bytes("abd", 3) &&
+        Hash::bytes("abc", 3) != Hash::bytes("abc", 3, 1) &&
+        Hash::real(1.0) != Hash::real(2.0);
+    bool zero = Hash::real(0.0) == Hash::real(-0.0) && Hash::value(REAL{-0.0}) == Hash::value(REAL{0.0});
+    bool nan = Hash::real(std::numeric_limits<double>::quiet_NaN()) == Hash::real(-std::nan("1"));
+    std::vector<uint64_t> integers;
+    std::vector<uint64_t> strings;
+    std::vector<uint64_t> reals;
+    std::vector<uint64_t> shifted;
+    for (int value = 0; value < 100000; ++value) {
+        integers.push_back(Hash::integer(static_cast<uint64_t>(value) * 64));
+        std::string key = "key" + std::to_string(value);
+        strings.push_back(Hash::bytes(key.data(), key.size()));
+        reals.push_back(Hash::real(value * 0.25));
+        shifted.push_back(Hash::integer(static_cast<uint64_t>(value) << 40));
+    }
+    double worst{0.0};
+    for (const auto* hashes : {&integers, &strings, &reals, &shifted}) {
+        worst = std::max({worst, spread(*hashes, 64, false), spread(*hashes, 64, true),
+            spread(*hashes, 256, false)});
+    }
+    std::cout << "equal : " << equal << " different : " << different << " zero : " << zero;
+    std::cout << " nan : " << nan << " worst bucket deviation : " << worst << std::endl;
+    return (equal && different && zero && nan && worst < 0.25) ? 0 : 1;
+}
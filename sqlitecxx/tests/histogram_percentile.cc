@@ -0,0 +1,68 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * histogram_percentile.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <iostream>
+#include "histogram.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking relative error of bucket upper bound !!!!!!!!!!!!!!!!!!!!!!!!!!
+    double worst{0.0};
+    bool bounded{true};
+    for (uint64_t value = 1; value < (uint64_t{1} << 39); value += value / 7 + 1) {
+        Histogram histogram;
+        histogram.record(value);
+        histogram.record(uint64_t{1} << 39);
+        uint64_t reported = histogram.percentile(50.0);
+        double error = static_cast<double>(reported - value) / static_cast<double>(value);
+        bounded = bounded && reported >= value;
+        worst = std::max(worst, error);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking percentiles of uniform distribution !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    Histogram uniform;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        uniform.record(value);
+    }
+    auto near = [&uniform](double percentile, uint64_t expected) {
+        uint64_t reported = uniform.percentile(percentile);
+        return reported >= expected && reported <= expected + expected / 32;
+    };
+    bool percentiles = near(50.0, 50000) && near(90.0, 90000) && near(99.0, 99000) &&
+        near(99.9, 99900) && uniform.percentile(0.0) == 1 &&
+        uniform.percentile(100.0) == 100000 && uniform.get_min() == 1 &&
+        uniform.get_max() == 100000 && uniform.get_mean() == 50000.5;
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking small values are exact, merge and reset !!!!!!!!!!!!!!!!!!!!!!!
+    Histogram small;
+    Histogram other;
+    for (uint64_t value = 0; value < 64; ++value) {
+        (value % 2 ? small : other).record(value);
+    }
+    small.merge(other);
+    bool exact = small.get_count() == 64 && small.percentile(50.0) == 31 &&
+        small.percentile(25.0) == 15 && small.get_min() == 0 && small.get_max() == 63;
+    small.reset();
+    bool empty = small.get_count() == 0 && small.percentile(50.0) == 0 && small.get_min() == 0;
+    std::cout << "worst relative error : " << worst << " bounded : " << bounded;
+    std::cout << " percentiles : " << percentiles << " exact : " << exact;
+    std::cout << " empty : " << empty << std::endl;
+    return (bounded && worst <= 1.0 / 32 && percentiles && exact && empty) ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * immutable_pool.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "sqlitecxx.h"
+
+/**
+ * @brief Run query returning one text value.
+ */
+static std::string scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    std::string value{};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking immutable read-only serving with shared statements !!!!!!!!!!!
+    const char* path = "immutable_pool.db";
+    std::remove(path);
+    {
+        SQLiteCXX db{path};
+        db.execute("CREATE TABLE t(id INTEGER PRIMARY KEY, value INTEGER)");
+        db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s"
+            " WHERE x < 10000) INSERT INTO t SELECT x, x * 3 FROM s");
+    }
+    std::string mapped{};
+    int denied{SQLITE_OK};
+    {
+        SQLiteCXX db{path, ImmutableOptions{}};
+        mapped = scalar(db.get_db(), "PRAGMA mmap_size");
+        denied = sqlite3_exec(db.get_db(), "INSERT INTO t VALUES (0, 0)", nullptr, nullptr, nullptr);
+    }
+    ImmutablePool pool{path, {"SELECT value FROM t WHERE id = ?1", "SELECT count(*) FROM t"}};
+    std::atomic<int64_t> total{0};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&pool, &total, &failures, thread] {
+            for (int id = 1 + thread; id <= 10000; id += 4) {
+                int status = pool.query(0, [&total](sqlite3_stmt* statement) {
+                    total += sqlite3_column_int64(statement, 0);
+                }, INTEGER{id});
+                failures += status != SQLITE_OK;
+            }
+            failures += pool.query(1, [&failures](sqlite3_stmt* statement) {
+                failures += sqlite3_column_int64(statement, 0) != 10000;
+            }) != SQLITE_OK;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    size_t readers = pool.get_readers();
+    std::cout << "mmap : " << mapped << " denied : " << denied << " total : " << total;
+    std::cout << " failures : " << failures << " readers : " << readers << std::endl;
+    std::remove(path);
+    return (std::stoll(mapped.empty() ? "0" : mapped) > 0 && denied == SQLITE_READONLY &&
+        total == 3ll * 10000 * 10001 / 2 && failures == 0 && readers == 4) ? 0 : 1;
+}
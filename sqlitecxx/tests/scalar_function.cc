@@ -0,0 +1,92 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * scalar_function.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cctype>
+#include <string>
+#include <optional>
+#include <stdexcept>
+#include <iostream>
+#include <string_view>
+#include "sqlitecxx.h"
+
+/**
+ * @brief Run query returning one text value, error message on failure.
+ */
+static std::string scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    std::string value{};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) != SQLITE_OK) {
+        return sqlite3_errmsg(db);
+    }
+    int status = sqlite3_step(statement);
+    if (status == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    } else if (status != SQLITE_ROW && status != SQLITE_DONE) {
+        value = sqlite3_errmsg(db);
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+static int64_t twice(int64_t value) {
+    return value * 2;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking C++ callables registered as SQL scalar functions !!!!!!!!!!!!!!
+    SQLiteCXX db{":memory:"};
+    int status = db.create_function("score", [](INTEGER clicks, REAL weight) {
+        return REAL{clicks.get() * weight.get() + 1.0};
+    });
+    status |= db.create_function("shout", [](std::string_view text) {
+        std::string upper{text};
+        for (char& character : upper) {
+            character = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+        }
+        return upper;
+    });
+    status |= db.create_function("half", [](std::optional<int64_t> value) {
+        return value ? std::optional<double>{*value / 2.0} : std::nullopt;
+    });
+    status |= db.create_function("checked", [](int value) -> int {
+        if (value < 0) {
+            throw std::invalid_argument("negative value");
+        }
+        return value;
+    });
+    status |= db.create_function("twice", &twice);
+    int counter{0};
+    status |= db.create_function("tick", [counter]() mutable { return ++counter; }, 0);
+    db.execute("CREATE TABLE t(id INTEGER PRIMARY KEY, clicks INTEGER, weight REAL, name TEXT)");
+    db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s WHERE x < 1000)"
+        " INSERT INTO t SELECT x, x % 10, x / 1000.0, 'item' || x FROM s");
+    std::string index = scalar(db.get_db(), "CREATE INDEX t_score ON t(score(clicks, weight))");
+    std::string values = scalar(db.get_db(), "SELECT score(3, 0.5) || ':' || shout('abc') || ':' ||"
+        " half(5) || ':' || ifnull(half(NULL), 'null') || ':' || twice(21)");
+    std::string top = scalar(db.get_db(), "SELECT count(*) FROM t WHERE score(clicks, weight) > 9.0");
+    std::string error = scalar(db.get_db(), "SELECT checked(-1)");
+    std::string rejected = scalar(db.get_db(), "CREATE INDEX t_tick ON t(tick())");
+    std::string ticks = scalar(db.get_db(), "SELECT tick() + tick()");
+    std::cout << "status : " << status << " index : '" << index << "' values : " << values;
+    std::cout << " top : " << top << " error : " << error << std::endl;
+    std::cout << "rejected : " << rejected << " ticks : " << ticks << std::endl;
+    return (status == SQLITE_OK && index.empty() && values == "2.5:ABC:2.5:null:42" &&
+        top == "12" && error == "negative value" && !rejected.empty() && ticks == "3") ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * shard_router.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <iostream>
+#include "shard.h"
+
+/**
+ * @brief Text of merged rows, columns separated by ',' and rows by ';'.
+ */
+static std::string text(const std::vector<ShardRow>& rows) {
+    std::string out{};
+    for (const auto& row : rows) {
+        for (const auto& value : row) {
+            if (const int64_t* integer = std::get_if<int64_t>(&value)) {
+                out += std::to_string(*integer);
+            } else if (const double* real = std::get_if<double>(&value)) {
+                out += std::to_string(*real);
+            } else if (const std::string* string = std::get_if<std::string>(&value)) {
+                out += *string;
+            } else {
+                out += "NULL";
+            }
+            out += ",";
+        }
+        out += ";";
+    }
+    return out;
+}
+
+/**
+ * @brief All rows of query on single reference connection.
+ */
+static std::vector<ShardRow> reference(ShardRouter& single, const std::string& sql) {
+    std::vector<ShardRow> rows;
+    single.query_all(rows, sql);
+    return rows;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking sharded router with parallel scatter-gather !!!!!!!!!!!!!!!!!!!
+    std::vector<std::string> paths{"shard_0.db", "shard_1.db", "shard_2.db", "shard_3.db"};
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+    }
+    std::vector<std::tuple<INTEGER, TEXT, REAL>> rows;
+    for (int row = 0; row < 20000; ++row) {
+        rows.emplace_back(INTEGER{row}, TEXT{"sensor" + std::to_string(row % 7)},
+            REAL{static_cast<double>((row * 7919) % 10007)});
+    }
+    const char* schema = "CREATE TABLE readings(id INTEGER PRIMARY KEY, sensor TEXT, value REAL)";
+    const char* insert = "INSERT INTO readings VALUES (?1, ?2, ?3)";
+    int status{SQLITE_OK};
+    std::string point, grouped, expected_grouped, top, expected_top, count;
+    std::vector<size_t> sizes;
+    {
+        ShardRouter router{paths};
+        ShardRouter single{std::vector<std::string>{":memory:"}};
+        status |= router.execute_all(schema) | single.execute_all(schema);
+        status |= router.ingest(insert, rows) | single.ingest(insert, rows);
+        status |= router.execute(INTEGER{42}, "UPDATE readings SET value = -1 WHERE id = ?1", INTEGER{42});
+        status |= single.execute(INTEGER{42}, "UPDATE readings SET value = -1 WHERE id = ?1", INTEGER{42});
+        std::vector<ShardRow> result;
+        router.query(INTEGER{42}, result, "SELECT id, sensor, value FROM readings WHERE id = ?1", INTEGER{42});
+        point = text(result);
+        sizes.resize(router.get_shards());
+        for (const auto& row : rows) {
+            ++sizes[router.route(std::get<0>(row))];
+        }
+        ShardMerge aggregate{{ShardCombine::key, ShardCombine::count, ShardCombine::sum,
+            ShardCombine::min, ShardCombine::max}};
+        const char* grouping = "SELECT sensor, count(*), sum(value), min(value), max(value)"
+            " FROM readings GROUP BY sensor ORDER BY sensor";
+        router.query_all(result, grouping, aggregate);
+        grouped = text(result);
+        expected_grouped = text(reference(single, grouping));
+        ShardMerge ordered{{}, {{2, true}, {0, false}}, 10};
+        const char* topping = "SELECT id, sensor, value FROM readings ORDER BY value DESC, id LIMIT 10";
+        router.query_all(result, topping, ordered);
+        top = text(result);
+        expected_top = text(reference(single, topping));
+        router.query_all(result, "SELECT count(*) FROM readings", ShardMerge{{ShardCombine::sum}});
+        count = text(result);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking partial ingest reports committed shards, key not first !!!!!!!!
+    std::vector<size_t> committed;
+    std::string kept, regrouped;
+    int failed{SQLITE_OK};
+    {
+        ShardRouter router{{":memory:", ":memory:", ":memory:"}, std::vector<int64_t>{1000, 2000}};
+        router.execute_all("CREATE TABLE readings(id INTEGER PRIMARY KEY, sensor TEXT,"
+            " value REAL CHECK (value >= 0))");
+        std::vector<std::tuple<INTEGER, TEXT, REAL>> batch;
+        for (int row = 0; row < 3000; row += 10) {
+            batch.emplace_back(INTEGER{row}, TEXT{"sensor" + std::to_string(row % 3)},
+                REAL{row == 1500 ? -1.0 : 1.0});
+        }
+        failed = router.ingest("INSERT INTO readings VALUES (?1, ?2, ?3)", batch, &committed);
+        std::vector<ShardRow> result;
+        router.query_all(result, "SELECT count(*) FROM readings", ShardMerge{{ShardCombine::sum}});
+        kept = text(result);
+        router.query_all(result, "SELECT count(*), sensor, max(id) FROM readings GROUP BY sensor",
+            ShardMerge{{ShardCombine::sum, ShardCombine::key, ShardCombine::max}});
+        regrouped = text(result);
+    }
+    bool partial = failed == SQLITE_CONSTRAINT && committed == std::vector<size_t>{0, 2} &&
+        kept == "200,;" && regrouped == "67,sensor0,2970,;66,sensor1,2980,;67,sensor2,2990,;";
+    ShardRouter range{{":memory:", ":memory:", ":memory:"}, std::vector<int64_t>{1000, 2000}};
+    bool routed = range.route(int64_t{-5}) == 0 && range.route(int64_t{999}) == 0 &&
+        range.route(int64_t{1000}) == 1 && range.route(int64_t{2500}) == 2;
+    bool balanced{true};
+    for (size_t size : sizes) {
+        balanced = balanced && size > 4000 && size < 6000;
+    }
+    std::cout << "status : " << status << " point : " << point << " count : " << count << std::endl;
+    std::cout << "grouped : " << grouped << std::endl << "top : " << top << std::endl;
+    std::cout << "routed : " << routed << " balanced : " << balanced << std::endl;
+    std::cout << "partial : " << partial << " kept : " << kept << " regrouped : " << regrouped << std::endl;
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+        std::remove((path + "-wal").c_str());
+        std::remove((path + "-shm").c_str());
+    }
+    return (status == SQLITE_OK && point == "42,sensor0,-1.000000,;" && count == "20000,;" &&
+        grouped == expected_grouped && top == expected_top && routed && balanced && partial) ? 0 : 1;
+}
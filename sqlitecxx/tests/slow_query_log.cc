@@ -0,0 +1,59 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * slow_query_log.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include "sqlitecxx.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking slow query log and large scan flag !!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    SQLiteCXX database{":memory:"};
+    database.execute(
+        "CREATE TABLE orders(id INTEGER PRIMARY KEY, customer INTEGER);"
+        "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c "
+        "WHERE x < 50000) INSERT INTO orders SELECT x, x % 100 FROM c;"
+    );
+    database.enable_slow_query_log(true, 0, 16, "slow_log");
+    sqlite3_stmt* statement{nullptr};
+    sqlite3_prepare_v2(
+        database.get_db(),
+        "SELECT count(*) FROM orders o WHERE customer = ?1 AND :note <> ''",
+        -1, &statement, nullptr
+    );
+    sqlite3_bind_int(statement, 1, 42);
+    sqlite3_bind_text(statement, 2, "rush", -1, SQLITE_STATIC);
+    while (sqlite3_step(statement) == SQLITE_ROW) {
+    }
+    sqlite3_finalize(statement);
+    database.execute("SELECT customer FROM orders WHERE id = 7");
+    std::vector<SlowQuery> queries = database.get_slow_queries();
+    for (const auto& query : queries) {
+        std::cout << query.nanoseconds << " ns : " << query.sql << std::endl;
+        for (const auto& parameter : query.parameters) {
+            std::cout << "    parameter : " << parameter << std::endl;
+        }
+        std::cout << query.plan;
+        for (const auto& table : query.large_scans) {
+            std::cout << "    large scan : " << table << std::endl;
+        }
+    }
+    return (queries.size() == 2 && queries[0].large_scans.size() == 1 &&
+        queries[0].parameters[1] == ":note TEXT(4)" &&
+        queries[1].large_scans.empty()) ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * statement_normalize.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <iostream>
+#include "metrics.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking SQL normalization of literals, lists and whitespace !!!!!!!!!!!
+    std::vector<std::pair<std::string, std::string>> cases{
+        {"SELECT * FROM t WHERE id = 42", "SELECT * FROM t WHERE id = ?"},
+        {"  SELECT  a,\n\tb FROM t  ", "SELECT a, b FROM t"},
+        {"SELECT * FROM t WHERE name = 'it''s' AND x = 1.5e3", "SELECT * FROM t WHERE name = ? AND x = ?"},
+        {"SELECT * FROM t WHERE id IN (1, 2, 3, 4)", "SELECT * FROM t WHERE id IN (?)"},
+        {"SELECT * FROM t WHERE id IN (1,2,3)", "SELECT * FROM t WHERE id IN (?)"},
+        {"INSERT INTO t VALUES (?, :name, @value, $var)", "INSERT INTO t VALUES (?)"},
+        {"SELECT x'00ff', col2, t1.c3 FROM t1", "SELECT ?, col2, t1.c3 FROM t1"},
+        {"SELECT 0x1F, -7", "SELECT ?, -?"},
+        {"SELECT tax'1' FROM t", "SELECT tax? FROM t"},
+        {"SELECT * FROM t LIMIT 10 OFFSET 20", "SELECT * FROM t LIMIT ? OFFSET ?"},
+        {"", ""}
+    };
+    size_t failed{0};
+    for (const auto& [sql, expected] : cases) {
+        std::string normalized = StatementProfiler::normalize(sql);
+        if (normalized != expected) {
+            std::cout << "normalize(\"" << sql << "\") : \"" << normalized;
+            std::cout << "\" expected : \"" << expected << "\"" << std::endl;
+            ++failed;
+        }
+    }
+    bool same = StatementProfiler::normalize("SELECT * FROM t WHERE id = 1") ==
+        StatementProfiler::normalize("SELECT *  FROM t WHERE id = 99999");
+    std::cout << "cases : " << cases.size() << " failed : " << failed;
+    std::cout << " same : " << same << std::endl;
+    return (failed == 0 && same) ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * status_sampler.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include "status.h"
+#include "immutable.h"
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking sampling of serialized connection while owner runs queries !!!!
+    std::string path{"status_sampler.db"};
+    std::remove(path.c_str());
+    sqlite3* db{nullptr};
+    sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+        SQLITE_OPEN_FULLMUTEX, nullptr);
+    sqlite3_exec(db, "CREATE TABLE t (id INTEGER PRIMARY KEY, v TEXT);", nullptr, nullptr, nullptr);
+    StatusSampler sampler{db, std::chrono::milliseconds(1), 16};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    size_t statements{0};
+    while (std::chrono::steady_clock::now() < deadline) {
+        sqlite3_exec(db, "INSERT INTO t (v) VALUES (hex(randomblob(64)));"
+            "SELECT count(*) FROM t;", nullptr, nullptr, nullptr);
+        ++statements;
+    }
+    sampler.stop();
+    std::vector<StatusSnapshot> samples = sampler.samples();
+    std::vector<StatusSnapshot> deltas = sampler.deltas();
+    bool sampled = samples.size() >= 2 && samples.size() <= 16 &&
+        deltas.size() == samples.size() - 1;
+    bool monotonic{true};
+    for (const auto& delta : deltas) {
+        monotonic = monotonic && delta.database.cache_hit >= 0 && delta.database.cache_miss >= 0;
+    }
+    StatusSnapshot now = Status::snapshot(db);
+    bool counted = now.database.cache_hit > 0 && now.database.schema_used > 0 &&
+        now.global.memory_used.current > 0;
+    sqlite3_close(db);
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking connection without mutex is rejected !!!!!!!!!!!!!!!!!!!!!!!!!!
+    sqlite3* immutable{nullptr};
+    Immutable::open(path, &immutable);
+    bool rejected{false};
+    try {
+        StatusSampler unsafe{immutable, std::chrono::milliseconds(1)};
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    sqlite3_close(immutable);
+    std::remove(path.c_str());
+    std::cout << "statements : " << statements << " samples : " << samples.size();
+    std::cout << " sampled : " << sampled << " monotonic : " << monotonic;
+    std::cout << " counted : " << counted << " rejected : " << rejected << std::endl;
+    return (sampled && monotonic && counted && rejected) ? 0 : 1;
+}
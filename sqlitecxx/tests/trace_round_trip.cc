@@ -0,0 +1,115 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * trace_round_trip.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "datatypes.h"
+#include "trace.h"
+
+/**
+ * @brief Read dump the same way sqlitecxx-trace does.
+ */
+static bool decode(const std::string& path, std::vector<TraceRecord>& out) {
+    std::ifstream file{path, std::ios::binary};
+    char magic[8];
+    uint32_t header[2];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || std::memcmp(magic, "SQLCXXTR", sizeof(magic)) != 0 ||
+        header[0] != 1 || header[1] != sizeof(TraceRecord)) {
+        return false;
+    }
+    TraceRecord record{};
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        out.push_back(record);
+    }
+    return true;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking record, dump and decode of trace events !!!!!!!!!!!!!!!!!!!!!!!
+    std::string path{"trace_round_trip.dump"};
+    std::remove(path.c_str());
+    std::vector<TraceRecord> stale;
+    Trace::drain(stale);
+    Trace::set_mask(Trace::parse("integer"));
+    uintptr_t address{0};
+    {
+        INTEGER value{41};
+        address = reinterpret_cast<uintptr_t>(&value);
+        ++value;
+        REAL ignored{1.5};
+    }
+    std::thread worker{[]() {
+        Trace::record(TraceCategory::database, TraceEvent::open, nullptr, std::string{"main.db"});
+    }};
+    worker.join();
+    Trace::set_mask(0);
+    INTEGER untraced{7};
+    bool dumped = Trace::dump(path);
+    Trace::set_mask(Trace::parse("real"));
+    REAL second{2.5};
+    Trace::set_mask(0);
+    dumped = dumped && Trace::dump(path);
+    std::vector<TraceRecord> records;
+    bool decoded = decode(path, records);
+    std::remove(path.c_str());
+    bool order = records.size() == 5 &&
+        records[0].category == TraceCategory::integer &&
+        records[0].event == TraceEvent::constructor &&
+        records[0].kind == TraceArgument::integer &&
+        static_cast<int64_t>(records[0].argument) == 41 &&
+        records[0].object == address &&
+        records[1].event == TraceEvent::pre_increment &&
+        records[2].event == TraceEvent::destructor &&
+        records[3].category == TraceCategory::database &&
+        records[3].event == TraceEvent::open &&
+        records[3].kind == TraceArgument::size && records[3].argument == 7 &&
+        records[3].thread != records[0].thread &&
+        records[4].category == TraceCategory::real &&
+        records[4].kind == TraceArgument::real;
+    for (const auto& record : records) {
+        std::cout << Trace::format(record) << std::endl;
+    }
+    bool formatted = !records.empty() &&
+        Trace::format(records[0]).find("sqlitecxx::integer::user defined cstor arg : 41") != std::string::npos &&
+        Trace::format(records[4]).find("sqlitecxx::real::user defined cstor arg : 2.5") != std::string::npos;
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking overflow of ring buffer is counted, not wrapped !!!!!!!!!!!!!!!
+    TraceBuffer buffer{0};
+    TraceRecord record{};
+    for (uint64_t index = 0; index < SQLITECXX_TRACE_BUFFER + 3; ++index) {
+        record.argument = index;
+        buffer.push(record);
+    }
+    std::vector<TraceRecord> drained;
+    buffer.drain(drained);
+    bool overflow = buffer.get_dropped() == 3 && drained.size() == SQLITECXX_TRACE_BUFFER &&
+        drained.back().argument == SQLITECXX_TRACE_BUFFER - 1;
+    std::cout << "dumped : " << dumped << " decoded : " << decoded << " order : " << order;
+    std::cout << " formatted : " << formatted << " overflow : " << overflow << std::endl;
+    return (dumped && decoded && order && formatted && overflow) ? 0 : 1;
+}
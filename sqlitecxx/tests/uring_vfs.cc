@@ -0,0 +1,103 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * uring_vfs.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <string>
+#include <iostream>
+#include "sqlitecxx.h"
+
+/**
+ * @brief Run query returning one text value.
+ */
+static std::string scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    std::string value{};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking io_uring VFS with journal, WAL and read-ahead !!!!!!!!!!!!!!!!!!
+    const char* path = "uring_vfs.db";
+    std::remove(path);
+    std::remove("uring_vfs.db-wal");
+    std::remove("uring_vfs.db-shm");
+    UringOptions options;
+    options.batch = 8;
+    options.readahead = 8;
+    bool installed = SQLiteCXX::enable_uring_vfs(true, options);
+    std::string vfs{};
+    std::string integrity{};
+    std::string rows{};
+    {
+        SQLiteCXX db{path};
+        char* name{nullptr};
+        sqlite3_file_control(db.get_db(), "main", SQLITE_FCNTL_VFSNAME, &name);
+        vfs = name ? name : "";
+        sqlite3_free(name);
+        db.execute("PRAGMA cache_size = 10");
+        db.execute("CREATE TABLE t(id INTEGER PRIMARY KEY, payload TEXT)");
+        for (int batch = 0; batch < 10; ++batch) {
+            db.execute("BEGIN");
+            db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s"
+                " WHERE x < 1000) INSERT INTO t(payload) SELECT randomblob(100) FROM s");
+            db.execute("COMMIT");
+        }
+        db.execute("PRAGMA journal_mode = WAL");
+        db.execute("UPDATE t SET payload = 'x' WHERE id % 3 = 0");
+        db.execute("PRAGMA wal_checkpoint(TRUNCATE)");
+        integrity = scalar(db.get_db(), "PRAGMA integrity_check");
+    }
+    UringStats stats = UringVfs::stats();
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking O_DIRECT with unaligned page cache buffers !!!!!!!!!!!!!!!!!!!!
+    options.direct = true;
+    SQLiteCXX::enable_uring_vfs(true, options);
+    std::string direct{};
+    {
+        SQLiteCXX db{path};
+        db.execute("PRAGMA journal_mode = DELETE");
+        db.execute("UPDATE t SET payload = 'y' WHERE id % 5 = 0 AND id % 3 <> 0");
+        db.execute("UPDATE t SET payload = 'y' WHERE id % 5 = 0 AND id % 3 <> 0");
+        direct = scalar(db.get_db(), "PRAGMA integrity_check") + ":" +
+            scalar(db.get_db(), "SELECT count(*) FROM t WHERE payload = 'y'");
+    }
+    SQLiteCXX::enable_uring_vfs(false);
+    {
+        SQLiteCXX db{path};
+        rows = scalar(db.get_db(), "SELECT count(*) || ':' || sum(payload = 'x') FROM t");
+    }
+    std::cout << "installed : " << installed << " vfs : " << vfs;
+    std::cout << " integrity : " << integrity << " rows : " << rows << std::endl;
+    std::cout << "submissions : " << stats.submissions << " reads : " << stats.reads;
+    std::cout << " writes : " << stats.writes << " syncs : " << stats.syncs;
+    std::cout << " read-ahead hits : " << stats.readahead_hits;
+    std::cout << " files : " << stats.files << " passthrough : " << stats.passthrough;
+    std::cout << " direct : " << direct << std::endl;
+    std::remove(path);
+    bool used = !installed || (vfs.rfind(SQLITECXX_URING_VFS, 0) == 0 &&
+        stats.files >= 3 && stats.passthrough == 0 &&
+        stats.writes > 0 && stats.syncs > 0 && stats.readahead_hits > 0);
+    return (used && integrity == "ok" && direct == "ok:1334" && rows == "10000:3333") ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/* -*- Mode: C++; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+/*
+ * window_function.cc
+ * Copyright (C) 2022 Vladimir Roncevic <elektron.ronca@gmail.com>
+ *
+ * sqlitecxx is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlitecxx is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+#include <string>
+#include <iterator>
+#include <iostream>
+#include "sqlitecxx.h"
+
+/**
+ * @brief Sliding sum, window function with inverse().
+ */
+struct Sum {
+  int64_t total{0};
+
+  void step(int64_t value) {
+    this->total += value;
+  }
+
+  void inverse(int64_t value) {
+    this->total -= value;
+  }
+
+  int64_t value() const {
+    return this->total;
+  }
+};
+
+/**
+ * @brief Exponentially weighted moving average, aggregate only.
+ */
+struct Ewma {
+  double average{0.0};
+  bool started{false};
+
+  void step(double value, double alpha) {
+    this->average = this->started ? alpha * value + (1.0 - alpha) * this->average : value;
+    this->started = true;
+  }
+
+  std::optional<double> value() const {
+    return this->started ? std::optional<double>{this->average} : std::nullopt;
+  }
+};
+
+/**
+ * @brief Rolling median of window frame.
+ */
+struct Median {
+  std::multiset<double> values;
+
+  void step(REAL value) {
+    this->values.insert(value.get());
+  }
+
+  void inverse(REAL value) {
+    this->values.erase(this->values.find(value.get()));
+  }
+
+  std::optional<double> value() const {
+    if (this->values.empty()) {
+      return std::nullopt;
+    }
+    auto middle = std::next(this->values.begin(), static_cast<long>(this->values.size() / 2));
+    return this->values.size() % 2 ? *middle : (*middle + *std::prev(middle)) / 2.0;
+  }
+};
+
+/**
+ * @brief Run query returning one text value, error message on failure.
+ */
+static std::string scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* statement{nullptr};
+    std::string value{};
+    if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) != SQLITE_OK) {
+        return sqlite3_errmsg(db);
+    }
+    int status = sqlite3_step(statement);
+    if (status == SQLITE_ROW && sqlite3_column_text(statement, 0)) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    } else if (status != SQLITE_ROW && status != SQLITE_DONE) {
+        value = sqlite3_errmsg(db);
+    }
+    sqlite3_finalize(statement);
+    return value;
+}
+
+int main(void) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Checking C++ aggregate and window functions !!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    SQLiteCXX db{":memory:"};
+    int status = db.create_aggregate<Sum>("sum_cxx");
+    status |= db.create_aggregate<Ewma>("ewma");
+    status |= db.create_aggregate<Median>("median");
+    db.execute("CREATE TABLE series(ts INTEGER PRIMARY KEY, sensor INTEGER, value INTEGER)");
+    db.execute("WITH RECURSIVE s(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM s WHERE x < 10000)"
+        " INSERT INTO series SELECT x, x % 4, (x * 7919) % 1000 FROM s");
+    std::string groups = scalar(db.get_db(), "SELECT count(*) FROM (SELECT sensor,"
+        " sum(value) AS a, sum_cxx(value) AS b FROM series GROUP BY sensor) WHERE a = b");
+    std::string sliding = scalar(db.get_db(), "SELECT count(*) FROM (SELECT"
+        " sum(value) OVER w AS a, sum_cxx(value) OVER w AS b FROM series"
+        " WINDOW w AS (PARTITION BY sensor ORDER BY ts ROWS BETWEEN 20 PRECEDING AND CURRENT ROW))"
+        " WHERE a = b");
+    std::string empty = scalar(db.get_db(), "SELECT sum_cxx(value) || ':' ||"
+        " ifnull(ewma(value, 0.5), 'null') FROM series WHERE ts < 0");
+    std::string ewma = scalar(db.get_db(), "SELECT ewma(value, 0.5) FROM"
+        " (SELECT column1 AS value FROM (VALUES (1), (3), (5)))");
+    std::string running = scalar(db.get_db(), "SELECT group_concat(e) FROM (SELECT"
+        " ewma(column1, 0.5) OVER (ORDER BY column1) AS e FROM (VALUES (1), (3), (5)))");
+    std::string refused = scalar(db.get_db(), "SELECT group_concat(e) FROM (SELECT ewma(column1, 0.5)"
+        " OVER (ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) AS e FROM (VALUES (1), (3), (5)))");
+    std::string median = scalar(db.get_db(), "SELECT group_concat(m) FROM (SELECT median(column1)"
+        " OVER (ORDER BY rowid ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING) AS m FROM"
+        " (VALUES (5.0), (1.0), (9.0), (3.0), (7.0)))");
+    std::cout << "status : " << status << " groups : " << groups << " sliding : " << sliding;
+    std::cout << " empty : " << empty << " ewma : " << ewma << " running : " << running;
+    std::cout << " median : " << median << std::endl << "refused : " << refused << std::endl;
+    return (status == SQLITE_OK && groups == "4" && sliding == "10000" && empty == "0:null" &&
+        ewma == "3.5" && running == "1.0,2.0,3.5" && median == "3.0,5.0,3.0,7.0,5.0" &&
+        refused.find("inverse") != std::string::npos) ? 0 : 1;
+}